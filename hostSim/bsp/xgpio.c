@@ -0,0 +1,57 @@
+/*
+ * xgpio.c
+ *
+ * Host replacement for the Xilinx AXI GPIO driver. See xgpio.h.
+ */
+
+#include "xgpio.h"
+
+static XGpio_Config XGpio_ConfigTable[XPAR_XGPIO_NUM_INSTANCES] = {
+  {XPAR_GPIO_LEDS_DEVICE_ID,             XPAR_GPIO_LEDS_BASEADDR,             0, 0},
+  {XPAR_GPIO_PUSH_BUTTONS_DEVICE_ID,     XPAR_GPIO_PUSH_BUTTONS_BASEADDR,     0, 0},
+  {XPAR_AXI_GPIO_TFT_CONTROL_DEVICE_ID,  XPAR_AXI_GPIO_TFT_CONTROL_BASEADDR,  0, 0},
+  {XPAR_AXI_GPIO_TFT_DATA_BUS_DEVICE_ID, XPAR_AXI_GPIO_TFT_DATA_BUS_BASEADDR, 0, 0},
+  {XPAR_GPIO_TFT_0_DEVICE_ID,            XPAR_GPIO_TFT_0_BASEADDR,            0, 0},
+};
+
+XGpio_Config *XGpio_LookupConfig(u16 DeviceId) {
+  for (int i = 0; i < XPAR_XGPIO_NUM_INSTANCES; i++) {
+    if (XGpio_ConfigTable[i].DeviceId == DeviceId)
+      return &XGpio_ConfigTable[i];
+  }
+  return NULL;
+}
+
+int XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId) {
+  XGpio_Config *config = XGpio_LookupConfig(DeviceId);
+  if (!config) {
+    InstancePtr->IsReady = 0;
+    return XST_DEVICE_NOT_FOUND;
+  }
+  InstancePtr->BaseAddress = config->BaseAddress;
+  InstancePtr->InterruptPresent = config->InterruptPresent;
+  InstancePtr->IsDual = config->IsDual;
+  InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+  return XST_SUCCESS;
+}
+
+// Channel 1 registers start at offset 0, channel 2 registers at XGPIO_CHAN_OFFSET.
+static UINTPTR XGpio_channelAddress(XGpio *InstancePtr, unsigned Channel, u32 offset) {
+  return InstancePtr->BaseAddress + (Channel - 1) * XGPIO_CHAN_OFFSET + offset;
+}
+
+void XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask) {
+  Xil_Out32(XGpio_channelAddress(InstancePtr, Channel, XGPIO_TRI_OFFSET), DirectionMask);
+}
+
+u32 XGpio_GetDataDirection(XGpio *InstancePtr, unsigned Channel) {
+  return Xil_In32(XGpio_channelAddress(InstancePtr, Channel, XGPIO_TRI_OFFSET));
+}
+
+u32 XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel) {
+  return Xil_In32(XGpio_channelAddress(InstancePtr, Channel, XGPIO_DATA_OFFSET));
+}
+
+void XGpio_DiscreteWrite(XGpio *InstancePtr, unsigned Channel, u32 Data) {
+  Xil_Out32(XGpio_channelAddress(InstancePtr, Channel, XGPIO_DATA_OFFSET), Data);
+}
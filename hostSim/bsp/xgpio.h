@@ -0,0 +1,39 @@
+/*
+ * xgpio.h
+ *
+ * Host replacement for the Xilinx AXI GPIO driver. Only the calls used by the supportFiles
+ * are provided. Each one performs the same register accesses as the real driver.
+ */
+
+#ifndef XGPIO_H_
+#define XGPIO_H_
+
+#include "xil_io.h"
+#include "xparameters.h"
+
+#define XGPIO_DATA_OFFSET 0x0
+#define XGPIO_TRI_OFFSET 0x4
+#define XGPIO_CHAN_OFFSET 0x8
+
+typedef struct {
+  u16 DeviceId;
+  UINTPTR BaseAddress;
+  int InterruptPresent;
+  int IsDual;
+} XGpio_Config;
+
+typedef struct {
+  UINTPTR BaseAddress;
+  u32 IsReady;
+  int InterruptPresent;
+  int IsDual;
+} XGpio;
+
+XGpio_Config *XGpio_LookupConfig(u16 DeviceId);
+int XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId);
+void XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask);
+u32 XGpio_GetDataDirection(XGpio *InstancePtr, unsigned Channel);
+u32 XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel);
+void XGpio_DiscreteWrite(XGpio *InstancePtr, unsigned Channel, u32 Data);
+
+#endif /* XGPIO_H_ */
@@ -0,0 +1,71 @@
+/*
+ * xgpiops.c
+ *
+ * Host replacement for the Xilinx PS GPIO (MIO) driver. See xgpiops.h.
+ */
+
+#include "xgpiops.h"
+
+static XGpioPs_Config XGpioPs_ConfigTable = {XPAR_XGPIOPS_0_DEVICE_ID, XPAR_XGPIOPS_0_BASEADDR};
+
+// Pins 0-31 live in bank 0, 32-53 in bank 1 (the MIO banks that the ZYBO uses).
+static void XGpioPs_getBankPin(u32 Pin, u8 *Bank, u8 *PinNumber) {
+  *Bank = Pin < 32 ? 0 : 1;
+  *PinNumber = Pin % 32;
+}
+
+XGpioPs_Config *XGpioPs_LookupConfig(u16 DeviceId) {
+  return DeviceId == XGpioPs_ConfigTable.DeviceId ? &XGpioPs_ConfigTable : NULL;
+}
+
+int XGpioPs_CfgInitialize(XGpioPs *InstancePtr, XGpioPs_Config *ConfigPtr, u32 EffectiveAddr) {
+  InstancePtr->GpioConfig.DeviceId = ConfigPtr->DeviceId;
+  InstancePtr->GpioConfig.BaseAddr = EffectiveAddr;
+  InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+  return XST_SUCCESS;
+}
+
+u32 XGpioPs_Read(XGpioPs *InstancePtr, u8 Bank) {
+  return Xil_In32(InstancePtr->GpioConfig.BaseAddr + XGPIOPS_DATA_RO_OFFSET + Bank * XGPIOPS_DATA_BANK_OFFSET);
+}
+
+void XGpioPs_Write(XGpioPs *InstancePtr, u8 Bank, u32 Data) {
+  Xil_Out32(InstancePtr->GpioConfig.BaseAddr + XGPIOPS_DATA_OFFSET + Bank * XGPIOPS_DATA_BANK_OFFSET, Data);
+}
+
+u32 XGpioPs_ReadPin(XGpioPs *InstancePtr, u32 Pin) {
+  u8 bank, pinNumber;
+  XGpioPs_getBankPin(Pin, &bank, &pinNumber);
+  return (XGpioPs_Read(InstancePtr, bank) >> pinNumber) & 1;
+}
+
+// Uses the mask-data register so that only the one pin changes (a single write).
+void XGpioPs_WritePin(XGpioPs *InstancePtr, u32 Pin, u32 Data) {
+  u8 bank, pinNumber;
+  XGpioPs_getBankPin(Pin, &bank, &pinNumber);
+  u32 regOffset = bank * XGPIOPS_DATA_MASK_OFFSET;
+  if (pinNumber > 15) {
+    pinNumber -= 16;
+    regOffset += XGPIOPS_DATA_MSW_OFFSET;
+  }
+  u32 value = ~(1U << (pinNumber + 16)) & (((Data & 1) << pinNumber) | 0xFFFF0000);
+  Xil_Out32(InstancePtr->GpioConfig.BaseAddr + regOffset, value);
+}
+
+void XGpioPs_SetDirectionPin(XGpioPs *InstancePtr, u32 Pin, u32 Direction) {
+  u8 bank, pinNumber;
+  XGpioPs_getBankPin(Pin, &bank, &pinNumber);
+  UINTPTR address = InstancePtr->GpioConfig.BaseAddr + bank * XGPIOPS_REG_MASK_OFFSET + XGPIOPS_DIRM_OFFSET;
+  u32 value = Xil_In32(address);
+  value = Direction ? (value | (1U << pinNumber)) : (value & ~(1U << pinNumber));
+  Xil_Out32(address, value);
+}
+
+void XGpioPs_SetOutputEnablePin(XGpioPs *InstancePtr, u32 Pin, u32 OpEnable) {
+  u8 bank, pinNumber;
+  XGpioPs_getBankPin(Pin, &bank, &pinNumber);
+  UINTPTR address = InstancePtr->GpioConfig.BaseAddr + bank * XGPIOPS_REG_MASK_OFFSET + XGPIOPS_OUTEN_OFFSET;
+  u32 value = Xil_In32(address);
+  value = OpEnable ? (value | (1U << pinNumber)) : (value & ~(1U << pinNumber));
+  Xil_Out32(address, value);
+}
@@ -0,0 +1,44 @@
+/*
+ * xgpiops.h
+ *
+ * Host replacement for the Xilinx PS GPIO (MIO) driver. Only the calls used by mio.c
+ * are provided. Each one performs the same register accesses as the real driver.
+ */
+
+#ifndef XGPIOPS_H_
+#define XGPIOPS_H_
+
+#include "xil_io.h"
+#include "xparameters.h"
+
+#define XGPIOPS_DATA_LSW_OFFSET 0x000
+#define XGPIOPS_DATA_MSW_OFFSET 0x004
+#define XGPIOPS_DATA_OFFSET 0x040
+#define XGPIOPS_DATA_RO_OFFSET 0x060
+#define XGPIOPS_DIRM_OFFSET 0x204
+#define XGPIOPS_OUTEN_OFFSET 0x208
+#define XGPIOPS_DATA_MASK_OFFSET 0x8
+#define XGPIOPS_DATA_BANK_OFFSET 0x4
+#define XGPIOPS_REG_MASK_OFFSET 0x40
+#define XGPIOPS_MAX_BANKS 4
+
+typedef struct {
+  u16 DeviceId;
+  u32 BaseAddr;
+} XGpioPs_Config;
+
+typedef struct {
+  XGpioPs_Config GpioConfig;
+  u32 IsReady;
+} XGpioPs;
+
+XGpioPs_Config *XGpioPs_LookupConfig(u16 DeviceId);
+int XGpioPs_CfgInitialize(XGpioPs *InstancePtr, XGpioPs_Config *ConfigPtr, u32 EffectiveAddr);
+u32 XGpioPs_Read(XGpioPs *InstancePtr, u8 Bank);
+void XGpioPs_Write(XGpioPs *InstancePtr, u8 Bank, u32 Data);
+u32 XGpioPs_ReadPin(XGpioPs *InstancePtr, u32 Pin);
+void XGpioPs_WritePin(XGpioPs *InstancePtr, u32 Pin, u32 Data);
+void XGpioPs_SetDirectionPin(XGpioPs *InstancePtr, u32 Pin, u32 Direction);
+void XGpioPs_SetOutputEnablePin(XGpioPs *InstancePtr, u32 Pin, u32 OpEnable);
+
+#endif /* XGPIOPS_H_ */
@@ -0,0 +1,25 @@
+/*
+ * xil_exception.c
+ *
+ * Host replacement for the Xilinx standalone BSP exception API. See xil_exception.h.
+ */
+
+#include "xil_exception.h"
+#include "hostSim.h"
+
+void Xil_ExceptionInit(void) {
+}
+
+// Only the IRQ exception exists on the host.
+void Xil_ExceptionRegisterHandler(u32 exceptionId, Xil_ExceptionHandler handler, void *data) {
+  if (exceptionId == XIL_EXCEPTION_ID_IRQ_INT)
+    hostSim_registerIrqHandler(handler, data);
+}
+
+void Xil_ExceptionEnable(void) {
+  hostSim_setIrqEnabled(true);
+}
+
+void Xil_ExceptionDisable(void) {
+  hostSim_setIrqEnabled(false);
+}
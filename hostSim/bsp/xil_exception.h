@@ -0,0 +1,23 @@
+/*
+ * xil_exception.h
+ *
+ * Host replacement for the Xilinx standalone BSP exception API. The IRQ exception is
+ * modeled by hostSim.c; enabling/disabling it masks/unmasks delivery of simulated interrupts.
+ */
+
+#ifndef XIL_EXCEPTION_H_
+#define XIL_EXCEPTION_H_
+
+#include "xil_types.h"
+
+#define XIL_EXCEPTION_ID_IRQ_INT 5
+
+typedef void (*Xil_ExceptionHandler)(void *data);
+typedef void (*Xil_InterruptHandler)(void *data);
+
+void Xil_ExceptionInit(void);
+void Xil_ExceptionRegisterHandler(u32 exceptionId, Xil_ExceptionHandler handler, void *data);
+void Xil_ExceptionEnable(void);
+void Xil_ExceptionDisable(void);
+
+#endif /* XIL_EXCEPTION_H_ */
@@ -0,0 +1,20 @@
+/*
+ * xil_io.h
+ *
+ * Host replacement for the Xilinx standalone BSP I/O routines. Every access is routed
+ * to the register model in hostSim.c, which also counts it.
+ */
+
+#ifndef XIL_IO_H_
+#define XIL_IO_H_
+
+#include "xil_types.h"
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "xparameters.h"
+#include "hostSim.h"
+
+static inline u32 Xil_In32(UINTPTR addr) { return hostSim_read32((u32) addr); }
+static inline void Xil_Out32(UINTPTR addr, u32 value) { hostSim_write32((u32) addr, value); }
+
+#endif /* XIL_IO_H_ */
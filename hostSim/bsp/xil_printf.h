@@ -0,0 +1,17 @@
+/*
+ * xil_printf.h
+ *
+ * Host replacement for the Xilinx standalone BSP print routines.
+ */
+
+#ifndef XIL_PRINTF_H_
+#define XIL_PRINTF_H_
+
+#include <stdio.h>
+
+// Prints a string without formatting (the BSP version writes straight to the UART).
+static inline void print(const char *str) { fputs(str, stdout); }
+
+#define xil_printf printf
+
+#endif /* XIL_PRINTF_H_ */
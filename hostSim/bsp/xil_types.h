@@ -0,0 +1,33 @@
+/*
+ * xil_types.h
+ *
+ * Host replacement for the Xilinx standalone BSP basic types.
+ */
+
+#ifndef XIL_TYPES_H_
+#define XIL_TYPES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef uintptr_t UINTPTR;
+typedef intptr_t INTPTR;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define XIL_COMPONENT_IS_READY 0x11111111U
+
+#endif /* XIL_TYPES_H_ */
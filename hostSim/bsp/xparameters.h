@@ -0,0 +1,62 @@
+/*
+ * xparameters.h
+ *
+ * Host replacement for the SDK-generated xparameters.h. The addresses and IDs match the
+ * ZYBO hardware design so that all of the supportFiles code runs unmodified against the
+ * register model in hostSim.c.
+ */
+
+#ifndef XPARAMETERS_H_
+#define XPARAMETERS_H_
+
+#define XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ 650000000
+
+// AXI GPIO blocks.
+#define XPAR_XGPIO_NUM_INSTANCES 5
+#define XPAR_GPIO_LEDS_DEVICE_ID 0
+#define XPAR_GPIO_LEDS_BASEADDR 0x41200000
+#define XPAR_GPIO_PUSH_BUTTONS_DEVICE_ID 1
+#define XPAR_GPIO_PUSH_BUTTONS_BASEADDR 0x41210000
+#define XPAR_AXI_GPIO_TFT_CONTROL_DEVICE_ID 2
+#define XPAR_AXI_GPIO_TFT_CONTROL_BASEADDR 0x41220000
+#define XPAR_AXI_GPIO_TFT_DATA_BUS_DEVICE_ID 3
+#define XPAR_AXI_GPIO_TFT_DATA_BUS_BASEADDR 0x41230000
+#define XPAR_GPIO_TFT_0_DEVICE_ID 4
+#define XPAR_GPIO_TFT_0_BASEADDR 0x41240000
+
+// AXI SPI (touch controller).
+#define XPAR_SPI_0_DEVICE_ID 0
+#define XPAR_SPI_0_BASEADDR 0x41E00000
+
+// AXI timers.
+#define XPAR_AXI_TIMER_0_BASEADDR 0x42800000
+#define XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ 100000000
+#define XPAR_AXI_TIMER_1_BASEADDR 0x42810000
+#define XPAR_AXI_TIMER_1_CLOCK_FREQ_HZ 100000000
+#define XPAR_AXI_TIMER_2_BASEADDR 0x42820000
+#define XPAR_AXI_TIMER_2_CLOCK_FREQ_HZ 100000000
+
+// AXI XADC (sysmon).
+#define XPAR_AXI_XADC_0_DEVICE_ID 0
+#define XPAR_AXI_XADC_0_BASEADDR 0x43C00000
+
+// PS GPIO (MIO).
+#define XPAR_XGPIOPS_0_DEVICE_ID 0
+#define XPAR_XGPIOPS_0_BASEADDR 0xE000A000
+
+// Cortex-A9 private peripherals.
+#define XPAR_SCUGIC_SINGLE_DEVICE_ID 0
+#define XPAR_SCUGIC_CPU_BASEADDR 0xF8F00100
+#define XPAR_SCUGIC_DIST_BASEADDR 0xF8F01000
+#define XPAR_GLOBAL_TMR_BASEADDR 0xF8F00200
+#define XPAR_XSCUTIMER_0_DEVICE_ID 0
+#define XPAR_XSCUTIMER_0_BASEADDR 0xF8F00600
+
+// Interrupt IDs as seen by the GIC.
+#define XPAR_SCUTIMER_INTR 29
+#define XPAR_FABRIC_AXI_XADC_0_IP2INTC_IRPT_INTR 61
+#define XPAR_FABRIC_TOUCH_INT_INTR 62  // STMPE610 INT, routed to IRQ_F2P.
+#define XPAR_FABRIC_SPI_0_IP2INTC_IRPT_INTR 63
+#define XPAR_SCUGIC_MAX_NUM_INTR_INPUTS 95
+
+#endif /* XPARAMETERS_H_ */
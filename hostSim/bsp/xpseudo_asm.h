@@ -0,0 +1,15 @@
+/*
+ * xpseudo_asm.h
+ *
+ * Host replacement for the Xilinx standalone BSP inline-assembly macros. Only wfi() is
+ * provided: the core sleeps in hostSim_waitForInterrupt() while the device models keep running.
+ */
+
+#ifndef XPSEUDO_ASM_H_
+#define XPSEUDO_ASM_H_
+
+#include "hostSim.h"
+
+#define wfi() hostSim_waitForInterrupt()
+
+#endif /* XPSEUDO_ASM_H_ */
@@ -0,0 +1,101 @@
+/*
+ * xscugic.c
+ *
+ * Host replacement for the Xilinx GIC driver. See xscugic.h.
+ */
+
+#include "xscugic.h"
+
+#define XSCUGIC_DEFAULT_PRIORITY 0xA0
+#define XSCUGIC_SPI_CPU0_MASK 0x01010101
+
+static XScuGic_Config XScuGic_ConfigTable = {
+  XPAR_SCUGIC_SINGLE_DEVICE_ID, XPAR_SCUGIC_CPU_BASEADDR, XPAR_SCUGIC_DIST_BASEADDR, {}
+};
+
+static void XScuGic_stubHandler(void *CallBackRef) {
+  ((XScuGic *) CallBackRef)->UnhandledInterrupts++;
+}
+
+XScuGic_Config *XScuGic_LookupConfig(u16 DeviceId) {
+  return DeviceId == XScuGic_ConfigTable.DeviceId ? &XScuGic_ConfigTable : NULL;
+}
+
+// Same distributor/CPU-interface bring-up as the real driver: disable, default priorities, enable.
+int XScuGic_CfgInitialize(XScuGic *InstancePtr, XScuGic_Config *ConfigPtr, u32 EffectiveAddr) {
+  InstancePtr->Config = ConfigPtr;
+  InstancePtr->Config->CpuBaseAddress = EffectiveAddr;
+  InstancePtr->UnhandledInterrupts = 0;
+  for (int i = 0; i < XSCUGIC_MAX_NUM_INTR_INPUTS; i++) {
+    if (ConfigPtr->HandlerTable[i].Handler == NULL) {
+      ConfigPtr->HandlerTable[i].Handler = XScuGic_stubHandler;
+      ConfigPtr->HandlerTable[i].CallBackRef = InstancePtr;
+    }
+  }
+  u32 dist = ConfigPtr->DistBaseAddress;
+  Xil_Out32(dist + XSCUGIC_DIST_EN_OFFSET, 0);
+  for (int i = 32; i < XSCUGIC_MAX_NUM_INTR_INPUTS; i += 4)
+    Xil_Out32(dist + XSCUGIC_PRIORITY_OFFSET + i, XSCUGIC_DEFAULT_PRIORITY * 0x01010101U);
+  for (int i = 32; i < XSCUGIC_MAX_NUM_INTR_INPUTS; i += 32)
+    Xil_Out32(dist + XSCUGIC_DISABLE_OFFSET + (i / 32) * 4, 0xFFFFFFFF);
+  Xil_Out32(dist + XSCUGIC_DIST_EN_OFFSET, 1);
+  Xil_Out32(EffectiveAddr + XSCUGIC_CPU_PRIOR_OFFSET, 0xF0);
+  Xil_Out32(EffectiveAddr, 0x07);
+  InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+  return XST_SUCCESS;
+}
+
+int XScuGic_Connect(XScuGic *InstancePtr, u32 Int_Id, Xil_InterruptHandler Handler, void *CallBackRef) {
+  if (Int_Id >= XSCUGIC_MAX_NUM_INTR_INPUTS || !Handler)
+    return XST_FAILURE;
+  InstancePtr->Config->HandlerTable[Int_Id].Handler = Handler;
+  InstancePtr->Config->HandlerTable[Int_Id].CallBackRef = CallBackRef;
+  return XST_SUCCESS;
+}
+
+void XScuGic_Disconnect(XScuGic *InstancePtr, u32 Int_Id) {
+  XScuGic_Disable(InstancePtr, Int_Id);
+  InstancePtr->Config->HandlerTable[Int_Id].Handler = XScuGic_stubHandler;
+  InstancePtr->Config->HandlerTable[Int_Id].CallBackRef = InstancePtr;
+}
+
+void XScuGic_Enable(XScuGic *InstancePtr, u32 Int_Id) {
+  Xil_Out32(InstancePtr->Config->DistBaseAddress + XSCUGIC_ENABLE_SET_OFFSET + (Int_Id / 32) * 4, 1U << (Int_Id % 32));
+}
+
+void XScuGic_Disable(XScuGic *InstancePtr, u32 Int_Id) {
+  Xil_Out32(InstancePtr->Config->DistBaseAddress + XSCUGIC_DISABLE_OFFSET + (Int_Id / 32) * 4, 1U << (Int_Id % 32));
+}
+
+void XScuGic_SetPriorityTriggerType(XScuGic *InstancePtr, u32 Int_Id, u8 Priority, u8 Trigger) {
+  u32 dist = InstancePtr->Config->DistBaseAddress;
+  u32 priorityAddress = dist + XSCUGIC_PRIORITY_OFFSET + (Int_Id / 4) * 4;
+  u32 value = Xil_In32(priorityAddress);
+  value &= ~(0xFFU << ((Int_Id % 4) * 8));
+  value |= (u32)(Priority & XSCUGIC_PRIORITY_MASK) << ((Int_Id % 4) * 8);
+  Xil_Out32(priorityAddress, value);
+  u32 configAddress = dist + XSCUGIC_INT_CFG_OFFSET + (Int_Id / 16) * 4;
+  value = Xil_In32(configAddress);
+  value &= ~(XSCUGIC_INT_CFG_MASK << ((Int_Id % 16) * 2));
+  value |= (u32)(Trigger & XSCUGIC_INT_CFG_MASK) << ((Int_Id % 16) * 2);
+  Xil_Out32(configAddress, value);
+}
+
+void XScuGic_GetPriorityTriggerType(XScuGic *InstancePtr, u32 Int_Id, u8 *Priority, u8 *Trigger) {
+  u32 dist = InstancePtr->Config->DistBaseAddress;
+  u32 value = Xil_In32(dist + XSCUGIC_PRIORITY_OFFSET + (Int_Id / 4) * 4);
+  *Priority = (value >> ((Int_Id % 4) * 8)) & XSCUGIC_PRIORITY_MASK;
+  value = Xil_In32(dist + XSCUGIC_INT_CFG_OFFSET + (Int_Id / 16) * 4);
+  *Trigger = (value >> ((Int_Id % 16) * 2)) & XSCUGIC_INT_CFG_MASK;
+}
+
+// Acknowledge, dispatch through the handler table, end-of-interrupt.
+void XScuGic_InterruptHandler(XScuGic *InstancePtr) {
+  u32 cpu = InstancePtr->Config->CpuBaseAddress;
+  u32 intId = Xil_In32(cpu + XSCUGIC_INT_ACK_OFFSET) & XSCUGIC_ACK_INTID_MASK;
+  if (intId >= XSCUGIC_MAX_NUM_INTR_INPUTS)
+    return;  // Spurious.
+  XScuGic_VectorTableEntry *entry = &InstancePtr->Config->HandlerTable[intId];
+  entry->Handler(entry->CallBackRef);
+  Xil_Out32(cpu + XSCUGIC_EOI_OFFSET, intId);
+}
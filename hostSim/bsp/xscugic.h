@@ -0,0 +1,56 @@
+/*
+ * xscugic.h
+ *
+ * Host replacement for the Xilinx GIC driver. Only the calls used by interrupts.c
+ * are provided. Each one performs the same register accesses as the real driver.
+ */
+
+#ifndef XSCUGIC_H_
+#define XSCUGIC_H_
+
+#include "xil_io.h"
+#include "xil_exception.h"
+#include "xparameters.h"
+
+#define XSCUGIC_CPU_PRIOR_OFFSET 0x04
+#define XSCUGIC_INT_ACK_OFFSET 0x0C
+#define XSCUGIC_EOI_OFFSET 0x10
+#define XSCUGIC_DIST_EN_OFFSET 0x000
+#define XSCUGIC_ENABLE_SET_OFFSET 0x100
+#define XSCUGIC_DISABLE_OFFSET 0x180
+#define XSCUGIC_PRIORITY_OFFSET 0x400
+#define XSCUGIC_INT_CFG_OFFSET 0xC00
+#define XSCUGIC_ACK_INTID_MASK 0x3FF
+#define XSCUGIC_PRIORITY_MASK 0xF8
+#define XSCUGIC_INT_CFG_MASK 0x3
+#define XSCUGIC_MAX_NUM_INTR_INPUTS (XPAR_SCUGIC_MAX_NUM_INTR_INPUTS + 1)
+
+typedef struct {
+  Xil_InterruptHandler Handler;
+  void *CallBackRef;
+} XScuGic_VectorTableEntry;
+
+typedef struct {
+  u16 DeviceId;
+  u32 CpuBaseAddress;
+  u32 DistBaseAddress;
+  XScuGic_VectorTableEntry HandlerTable[XSCUGIC_MAX_NUM_INTR_INPUTS];
+} XScuGic_Config;
+
+typedef struct {
+  XScuGic_Config *Config;
+  u32 IsReady;
+  u32 UnhandledInterrupts;
+} XScuGic;
+
+XScuGic_Config *XScuGic_LookupConfig(u16 DeviceId);
+int XScuGic_CfgInitialize(XScuGic *InstancePtr, XScuGic_Config *ConfigPtr, u32 EffectiveAddr);
+int XScuGic_Connect(XScuGic *InstancePtr, u32 Int_Id, Xil_InterruptHandler Handler, void *CallBackRef);
+void XScuGic_Disconnect(XScuGic *InstancePtr, u32 Int_Id);
+void XScuGic_Enable(XScuGic *InstancePtr, u32 Int_Id);
+void XScuGic_Disable(XScuGic *InstancePtr, u32 Int_Id);
+void XScuGic_SetPriorityTriggerType(XScuGic *InstancePtr, u32 Int_Id, u8 Priority, u8 Trigger);
+void XScuGic_GetPriorityTriggerType(XScuGic *InstancePtr, u32 Int_Id, u8 *Priority, u8 *Trigger);
+void XScuGic_InterruptHandler(XScuGic *InstancePtr);
+
+#endif /* XSCUGIC_H_ */
@@ -0,0 +1,63 @@
+/*
+ * xscutimer.c
+ *
+ * Host replacement for the Xilinx Cortex-A9 private timer driver. See xscutimer.h.
+ */
+
+#include "xscutimer.h"
+
+#define XSCUTIMER_SELFTEST_VALUE 0xA55AF00F
+
+static XScuTimer_Config XScuTimer_ConfigTable = {XPAR_XSCUTIMER_0_DEVICE_ID, XPAR_XSCUTIMER_0_BASEADDR};
+
+XScuTimer_Config *XScuTimer_LookupConfig(u16 DeviceId) {
+  return DeviceId == XScuTimer_ConfigTable.DeviceId ? &XScuTimer_ConfigTable : NULL;
+}
+
+int XScuTimer_CfgInitialize(XScuTimer *InstancePtr, XScuTimer_Config *ConfigPtr, u32 EffectiveAddress) {
+  if (InstancePtr->IsStarted == XIL_COMPONENT_IS_READY)
+    return XST_FAILURE;  // The real driver refuses to re-initialize a running timer.
+  InstancePtr->Config.DeviceId = ConfigPtr->DeviceId;
+  InstancePtr->Config.BaseAddr = EffectiveAddress;
+  InstancePtr->IsStarted = 0;
+  InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+  return XST_SUCCESS;
+}
+
+// Writes a pattern to the load register and checks that the (stopped) counter picked it up.
+int XScuTimer_SelfTest(XScuTimer *InstancePtr) {
+  u32 base = InstancePtr->Config.BaseAddr;
+  u32 control = XScuTimer_ReadReg(base, XSCUTIMER_CONTROL_OFFSET);
+  XScuTimer_WriteReg(base, XSCUTIMER_CONTROL_OFFSET, control & ~XSCUTIMER_CONTROL_ENABLE_MASK);
+  XScuTimer_LoadTimer(InstancePtr, XSCUTIMER_SELFTEST_VALUE);
+  u32 counter = XScuTimer_GetCounterValue(InstancePtr);
+  XScuTimer_LoadTimer(InstancePtr, 0);
+  XScuTimer_WriteReg(base, XSCUTIMER_CONTROL_OFFSET, control);
+  return counter == XSCUTIMER_SELFTEST_VALUE ? XST_SUCCESS : XST_FAILURE;
+}
+
+void XScuTimer_Start(XScuTimer *InstancePtr) {
+  u32 base = InstancePtr->Config.BaseAddr;
+  XScuTimer_WriteReg(base, XSCUTIMER_CONTROL_OFFSET,
+                     XScuTimer_ReadReg(base, XSCUTIMER_CONTROL_OFFSET) | XSCUTIMER_CONTROL_ENABLE_MASK);
+  InstancePtr->IsStarted = XIL_COMPONENT_IS_READY;
+}
+
+void XScuTimer_Stop(XScuTimer *InstancePtr) {
+  u32 base = InstancePtr->Config.BaseAddr;
+  XScuTimer_WriteReg(base, XSCUTIMER_CONTROL_OFFSET,
+                     XScuTimer_ReadReg(base, XSCUTIMER_CONTROL_OFFSET) & ~XSCUTIMER_CONTROL_ENABLE_MASK);
+  InstancePtr->IsStarted = 0;
+}
+
+void XScuTimer_SetPrescaler(XScuTimer *InstancePtr, u8 PrescalerValue) {
+  u32 base = InstancePtr->Config.BaseAddr;
+  u32 control = XScuTimer_ReadReg(base, XSCUTIMER_CONTROL_OFFSET) & ~XSCUTIMER_CONTROL_PRESCALER_MASK;
+  control |= (u32) PrescalerValue << XSCUTIMER_CONTROL_PRESCALER_SHIFT;
+  XScuTimer_WriteReg(base, XSCUTIMER_CONTROL_OFFSET, control);
+}
+
+u8 XScuTimer_GetPrescaler(XScuTimer *InstancePtr) {
+  u32 control = XScuTimer_ReadReg(InstancePtr->Config.BaseAddr, XSCUTIMER_CONTROL_OFFSET);
+  return (control & XSCUTIMER_CONTROL_PRESCALER_MASK) >> XSCUTIMER_CONTROL_PRESCALER_SHIFT;
+}
@@ -0,0 +1,68 @@
+/*
+ * xscutimer.h
+ *
+ * Host replacement for the Xilinx Cortex-A9 private timer driver. Only the calls used by
+ * interrupts.c are provided. Each one performs the same register accesses as the real driver.
+ */
+
+#ifndef XSCUTIMER_H_
+#define XSCUTIMER_H_
+
+#include "xil_io.h"
+#include "xparameters.h"
+
+#define XSCUTIMER_LOAD_OFFSET 0x00
+#define XSCUTIMER_COUNTER_OFFSET 0x04
+#define XSCUTIMER_CONTROL_OFFSET 0x08
+#define XSCUTIMER_ISR_OFFSET 0x0C
+#define XSCUTIMER_CONTROL_ENABLE_MASK 0x00000001
+#define XSCUTIMER_CONTROL_AUTO_RELOAD_MASK 0x00000002
+#define XSCUTIMER_CONTROL_IRQ_ENABLE_MASK 0x00000004
+#define XSCUTIMER_CONTROL_PRESCALER_MASK 0x0000FF00
+#define XSCUTIMER_CONTROL_PRESCALER_SHIFT 8
+#define XSCUTIMER_ISR_EVENT_FLAG_MASK 0x00000001
+
+typedef struct {
+  u16 DeviceId;
+  u32 BaseAddr;
+} XScuTimer_Config;
+
+typedef struct {
+  XScuTimer_Config Config;
+  u32 IsReady;
+  u32 IsStarted;
+} XScuTimer;
+
+#define XScuTimer_ReadReg(BaseAddr, RegOffset) Xil_In32((BaseAddr) + (RegOffset))
+#define XScuTimer_WriteReg(BaseAddr, RegOffset, Data) Xil_Out32((BaseAddr) + (RegOffset), (Data))
+
+#define XScuTimer_LoadTimer(InstancePtr, Value) \
+  XScuTimer_WriteReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_LOAD_OFFSET, (Value))
+#define XScuTimer_GetCounterValue(InstancePtr) \
+  XScuTimer_ReadReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_COUNTER_OFFSET)
+#define XScuTimer_EnableAutoReload(InstancePtr) \
+  XScuTimer_WriteReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_CONTROL_OFFSET, \
+    XScuTimer_ReadReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_CONTROL_OFFSET) | XSCUTIMER_CONTROL_AUTO_RELOAD_MASK)
+#define XScuTimer_DisableAutoReload(InstancePtr) \
+  XScuTimer_WriteReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_CONTROL_OFFSET, \
+    XScuTimer_ReadReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_CONTROL_OFFSET) & ~XSCUTIMER_CONTROL_AUTO_RELOAD_MASK)
+#define XScuTimer_EnableInterrupt(InstancePtr) \
+  XScuTimer_WriteReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_CONTROL_OFFSET, \
+    XScuTimer_ReadReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_CONTROL_OFFSET) | XSCUTIMER_CONTROL_IRQ_ENABLE_MASK)
+#define XScuTimer_DisableInterrupt(InstancePtr) \
+  XScuTimer_WriteReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_CONTROL_OFFSET, \
+    XScuTimer_ReadReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_CONTROL_OFFSET) & ~XSCUTIMER_CONTROL_IRQ_ENABLE_MASK)
+#define XScuTimer_GetInterruptStatus(InstancePtr) \
+  XScuTimer_ReadReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_ISR_OFFSET)
+#define XScuTimer_ClearInterruptStatus(InstancePtr) \
+  XScuTimer_WriteReg((InstancePtr)->Config.BaseAddr, XSCUTIMER_ISR_OFFSET, XSCUTIMER_ISR_EVENT_FLAG_MASK)
+
+XScuTimer_Config *XScuTimer_LookupConfig(u16 DeviceId);
+int XScuTimer_CfgInitialize(XScuTimer *InstancePtr, XScuTimer_Config *ConfigPtr, u32 EffectiveAddress);
+int XScuTimer_SelfTest(XScuTimer *InstancePtr);
+void XScuTimer_Start(XScuTimer *InstancePtr);
+void XScuTimer_Stop(XScuTimer *InstancePtr);
+void XScuTimer_SetPrescaler(XScuTimer *InstancePtr, u8 PrescalerValue);
+u8 XScuTimer_GetPrescaler(XScuTimer *InstancePtr);
+
+#endif /* XSCUTIMER_H_ */
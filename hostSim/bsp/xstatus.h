@@ -0,0 +1,14 @@
+/*
+ * xstatus.h
+ *
+ * Host replacement for the Xilinx standalone BSP status codes.
+ */
+
+#ifndef XSTATUS_H_
+#define XSTATUS_H_
+
+#define XST_SUCCESS 0L
+#define XST_FAILURE 1L
+#define XST_DEVICE_NOT_FOUND 2L
+
+#endif /* XSTATUS_H_ */
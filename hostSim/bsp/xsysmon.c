@@ -0,0 +1,105 @@
+/*
+ * xsysmon.c
+ *
+ * Host replacement for the Xilinx system monitor (AXI XADC) driver. See xsysmon.h.
+ */
+
+#include "xsysmon.h"
+
+#define XSM_SELFTEST_VALUE 0x5A5A
+
+static XSysMon_Config XSysMon_ConfigTable = {XPAR_AXI_XADC_0_DEVICE_ID, XPAR_AXI_XADC_0_BASEADDR};
+
+#define XSysMon_readReg(InstancePtr, offset) Xil_In32((InstancePtr)->Config.BaseAddress + (offset))
+#define XSysMon_writeReg(InstancePtr, offset, value) Xil_Out32((InstancePtr)->Config.BaseAddress + (offset), (value))
+
+XSysMon_Config *XSysMon_LookupConfig(u16 DeviceId) {
+  return DeviceId == XSysMon_ConfigTable.DeviceId ? &XSysMon_ConfigTable : NULL;
+}
+
+int XSysMon_CfgInitialize(XSysMon *InstancePtr, XSysMon_Config *ConfigPtr, u32 EffectiveAddr) {
+  InstancePtr->Config.DeviceId = ConfigPtr->DeviceId;
+  InstancePtr->Config.BaseAddress = EffectiveAddr;
+  InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+  XSysMon_writeReg(InstancePtr, XSM_SRR_OFFSET, XSM_SRR_IPRST_MASK);
+  return XST_SUCCESS;
+}
+
+// Resets the core, then checks that an alarm threshold register holds a written pattern.
+int XSysMon_SelfTest(XSysMon *InstancePtr) {
+  XSysMon_writeReg(InstancePtr, XSM_SRR_OFFSET, XSM_SRR_IPRST_MASK);
+  XSysMon_SetAlarmThreshold(InstancePtr, XSM_ATR_VCCINT_UPPER, XSM_SELFTEST_VALUE);
+  u32 value = XSysMon_readReg(InstancePtr, XSM_ATR_OFFSET + XSM_ATR_VCCINT_UPPER * 4);
+  XSysMon_writeReg(InstancePtr, XSM_SRR_OFFSET, XSM_SRR_IPRST_MASK);
+  return value == XSM_SELFTEST_VALUE ? XST_SUCCESS : XST_FAILURE;
+}
+
+void XSysMon_SetAdcClkDivisor(XSysMon *InstancePtr, u8 Divisor) {
+  u32 value = XSysMon_readReg(InstancePtr, XSM_CFR2_OFFSET) & ~XSM_CFR2_CD_MASK;
+  XSysMon_writeReg(InstancePtr, XSM_CFR2_OFFSET, value | ((u32) Divisor << XSM_CFR2_CD_SHIFT));
+}
+
+u8 XSysMon_GetAdcClkDivisor(XSysMon *InstancePtr) {
+  return (XSysMon_readReg(InstancePtr, XSM_CFR2_OFFSET) & XSM_CFR2_CD_MASK) >> XSM_CFR2_CD_SHIFT;
+}
+
+void XSysMon_SetSequencerMode(XSysMon *InstancePtr, u8 SequencerMode) {
+  u32 value = XSysMon_readReg(InstancePtr, XSM_CFR1_OFFSET) & ~XSM_CFR1_SEQ_VALID_MASK;
+  XSysMon_writeReg(InstancePtr, XSM_CFR1_OFFSET, value | ((u32) SequencerMode << XSM_CFR1_SEQ_SHIFT));
+}
+
+int XSysMon_SetSingleChParams(XSysMon *InstancePtr, u8 Channel, int IncreaseAcqCycles,
+                              int IsEventMode, int IsDifferentialMode) {
+  u32 value = XSysMon_readReg(InstancePtr, XSM_CFR0_OFFSET) & XSM_CFR0_AVG_VALID_MASK;
+  value |= Channel & XSM_CFR0_CHANNEL_MASK;
+  if (IncreaseAcqCycles)
+    value |= 0x100;
+  if (IsEventMode)
+    value |= 0x200;
+  if (IsDifferentialMode)
+    value |= 0x400;
+  XSysMon_writeReg(InstancePtr, XSM_CFR0_OFFSET, value);
+  return XST_SUCCESS;
+}
+
+void XSysMon_SetAvg(XSysMon *InstancePtr, u8 Average) {
+  u32 value = XSysMon_readReg(InstancePtr, XSM_CFR0_OFFSET) & ~XSM_CFR0_AVG_VALID_MASK;
+  XSysMon_writeReg(InstancePtr, XSM_CFR0_OFFSET, value | ((u32) Average << XSM_CFR0_AVG_SHIFT));
+}
+
+void XSysMon_SetAlarmEnables(XSysMon *InstancePtr, u16 AlmEnableMask) {
+  u32 value = XSysMon_readReg(InstancePtr, XSM_CFR1_OFFSET) & ~XSM_CFR1_ALM_ALL_MASK;
+  XSysMon_writeReg(InstancePtr, XSM_CFR1_OFFSET, value | (~AlmEnableMask & XSM_CFR1_ALM_ALL_MASK));
+}
+
+void XSysMon_SetAlarmThreshold(XSysMon *InstancePtr, u8 AlarmThrReg, u16 Value) {
+  XSysMon_writeReg(InstancePtr, XSM_ATR_OFFSET + AlarmThrReg * 4, Value);
+}
+
+u16 XSysMon_GetAdcData(XSysMon *InstancePtr, u8 Channel) {
+  return (u16) XSysMon_readReg(InstancePtr, XSM_CHANNEL_DATA_OFFSET + Channel * 4);
+}
+
+void XSysMon_IntrGlobalEnable(XSysMon *InstancePtr) {
+  XSysMon_writeReg(InstancePtr, XSM_GIER_OFFSET, XSM_GIER_GIE_MASK);
+}
+
+void XSysMon_IntrGlobalDisable(XSysMon *InstancePtr) {
+  XSysMon_writeReg(InstancePtr, XSM_GIER_OFFSET, 0);
+}
+
+void XSysMon_IntrEnable(XSysMon *InstancePtr, u32 Mask) {
+  XSysMon_writeReg(InstancePtr, XSM_IPIER_OFFSET, XSysMon_readReg(InstancePtr, XSM_IPIER_OFFSET) | Mask);
+}
+
+void XSysMon_IntrDisable(XSysMon *InstancePtr, u32 Mask) {
+  XSysMon_writeReg(InstancePtr, XSM_IPIER_OFFSET, XSysMon_readReg(InstancePtr, XSM_IPIER_OFFSET) & ~Mask);
+}
+
+u32 XSysMon_IntrGetStatus(XSysMon *InstancePtr) {
+  return XSysMon_readReg(InstancePtr, XSM_IPISR_OFFSET) & XSysMon_readReg(InstancePtr, XSM_IPIER_OFFSET);
+}
+
+void XSysMon_IntrClear(XSysMon *InstancePtr, u32 Mask) {
+  XSysMon_writeReg(InstancePtr, XSM_IPISR_OFFSET, Mask);
+}
@@ -0,0 +1,75 @@
+/*
+ * xsysmon.h
+ *
+ * Host replacement for the Xilinx system monitor (AXI XADC) driver. Only the calls used by
+ * interrupts.c are provided. Each one performs the same register accesses as the real driver.
+ */
+
+#ifndef XSYSMON_H_
+#define XSYSMON_H_
+
+#include "xil_io.h"
+#include "xparameters.h"
+
+// Register offsets of the AXI XADC core.
+#define XSM_SRR_OFFSET 0x00
+#define XSM_SR_OFFSET 0x04
+#define XSM_GIER_OFFSET 0x5C
+#define XSM_IPISR_OFFSET 0x60
+#define XSM_IPIER_OFFSET 0x68
+#define XSM_CHANNEL_DATA_OFFSET 0x200
+#define XSM_CFR0_OFFSET 0x300
+#define XSM_CFR1_OFFSET 0x304
+#define XSM_CFR2_OFFSET 0x308
+#define XSM_ATR_OFFSET 0x340
+
+#define XSM_SRR_IPRST_MASK 0x0000000A
+#define XSM_GIER_GIE_MASK 0x80000000
+#define XSM_SR_EOC_MASK 0x00000040
+#define XSM_IPIXR_EOC_MASK 0x00000010
+#define XSM_CFR0_CHANNEL_MASK 0x0000001F
+#define XSM_CFR0_AVG_VALID_MASK 0x00003000
+#define XSM_CFR0_AVG_SHIFT 12
+#define XSM_CFR1_SEQ_VALID_MASK 0x0000F000
+#define XSM_CFR1_SEQ_SHIFT 12
+#define XSM_CFR1_ALM_ALL_MASK 0x00000F0F
+#define XSM_CFR2_CD_MASK 0x0000FF00
+#define XSM_CFR2_CD_SHIFT 8
+
+#define XSM_CH_AUX_MIN 16
+#define XSM_CH_AUX_MAX 31
+#define XSM_SEQ_MODE_SINGCHAN 3
+#define XSM_AVG_16_SAMPLES 1
+#define XSM_ATR_VCCINT_UPPER 1
+#define XSM_ATR_VCCINT_LOWER 5
+
+typedef struct {
+  u16 DeviceId;
+  u32 BaseAddress;
+} XSysMon_Config;
+
+typedef struct {
+  XSysMon_Config Config;
+  u32 IsReady;
+} XSysMon;
+
+XSysMon_Config *XSysMon_LookupConfig(u16 DeviceId);
+int XSysMon_CfgInitialize(XSysMon *InstancePtr, XSysMon_Config *ConfigPtr, u32 EffectiveAddr);
+int XSysMon_SelfTest(XSysMon *InstancePtr);
+void XSysMon_SetAdcClkDivisor(XSysMon *InstancePtr, u8 Divisor);
+u8 XSysMon_GetAdcClkDivisor(XSysMon *InstancePtr);
+void XSysMon_SetSequencerMode(XSysMon *InstancePtr, u8 SequencerMode);
+int XSysMon_SetSingleChParams(XSysMon *InstancePtr, u8 Channel, int IncreaseAcqCycles,
+                              int IsEventMode, int IsDifferentialMode);
+void XSysMon_SetAvg(XSysMon *InstancePtr, u8 Average);
+void XSysMon_SetAlarmEnables(XSysMon *InstancePtr, u16 AlmEnableMask);
+void XSysMon_SetAlarmThreshold(XSysMon *InstancePtr, u8 AlarmThrReg, u16 Value);
+u16 XSysMon_GetAdcData(XSysMon *InstancePtr, u8 Channel);
+void XSysMon_IntrGlobalEnable(XSysMon *InstancePtr);
+void XSysMon_IntrGlobalDisable(XSysMon *InstancePtr);
+void XSysMon_IntrEnable(XSysMon *InstancePtr, u32 Mask);
+void XSysMon_IntrDisable(XSysMon *InstancePtr, u32 Mask);
+u32 XSysMon_IntrGetStatus(XSysMon *InstancePtr);
+void XSysMon_IntrClear(XSysMon *InstancePtr, u32 Mask);
+
+#endif /* XSYSMON_H_ */
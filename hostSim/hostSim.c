@@ -0,0 +1,779 @@
+/*
+ * hostSim.c
+ *
+ * Register-file model of the ZYBO peripherals used by the Simon code. See hostSim.h.
+ * Devices are found by base address. Each one is a small array of 32-bit registers with
+ * optional read/write behavior layered on top (timers count, the GIC dispatches, GPIO
+ * inputs come from the stimulus functions, the SPI controller talks to the STMPE610 model).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include "hostSim.h"
+#include "hostSimLcd.h"
+#include "hostSimPlayer.h"
+#include "hostSimReplay.h"
+#include "xparameters.h"
+
+#define HOSTSIM_MAX_REGISTERS 1024          // Largest register file (GIC distributor, 4 KB).
+#define HOSTSIM_NANOSECONDS_PER_SECOND 1000000000ULL
+#define HOSTSIM_CPU_PRIVATE_CLOCK_HZ (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+#define HOSTSIM_WFI_POLL_NANOSECONDS 1000000  // How often the devices are updated while the core sleeps.
+#define HOSTSIM_VIRTUAL_ACCESS_NANOSECONDS 100  // Virtual time: one uncached AXI access from the A9.
+
+// AXI GPIO register offsets.
+#define HOSTSIM_GPIO_DATA_OFFSET 0x00
+#define HOSTSIM_GPIO_TRI_OFFSET 0x04
+
+// AXI timer register offsets and TCSR bits.
+#define HOSTSIM_AXI_TIMER_TCSR0_OFFSET 0x00
+#define HOSTSIM_AXI_TIMER_TLR0_OFFSET 0x04
+#define HOSTSIM_AXI_TIMER_TCR0_OFFSET 0x08
+#define HOSTSIM_AXI_TIMER_TCSR1_OFFSET 0x10
+#define HOSTSIM_AXI_TIMER_TLR1_OFFSET 0x14
+#define HOSTSIM_AXI_TIMER_TCR1_OFFSET 0x18
+#define HOSTSIM_AXI_TIMER_TCSR_LOAD_MASK 0x020
+#define HOSTSIM_AXI_TIMER_TCSR_ENT_MASK 0x080
+
+// Global timer register offsets.
+#define HOSTSIM_GLOBAL_TIMER_LOWER_OFFSET 0x00
+#define HOSTSIM_GLOBAL_TIMER_UPPER_OFFSET 0x04
+#define HOSTSIM_GLOBAL_TIMER_CONTROL_OFFSET 0x08
+#define HOSTSIM_GLOBAL_TIMER_ENABLE_MASK 0x1
+
+// SCU private timer register offsets and control bits.
+#define HOSTSIM_SCU_TIMER_LOAD_OFFSET 0x00
+#define HOSTSIM_SCU_TIMER_COUNTER_OFFSET 0x04
+#define HOSTSIM_SCU_TIMER_CONTROL_OFFSET 0x08
+#define HOSTSIM_SCU_TIMER_ISR_OFFSET 0x0C
+#define HOSTSIM_SCU_TIMER_ENABLE_MASK 0x1
+#define HOSTSIM_SCU_TIMER_AUTO_RELOAD_MASK 0x2
+#define HOSTSIM_SCU_TIMER_IRQ_ENABLE_MASK 0x4
+#define HOSTSIM_SCU_TIMER_PRESCALER_SHIFT 8
+#define HOSTSIM_SCU_TIMER_PRESCALER_MASK 0xFF00
+#define HOSTSIM_SCU_TIMER_EVENT_FLAG_MASK 0x1
+
+// GIC register offsets.
+#define HOSTSIM_GIC_CPU_IAR_OFFSET 0x0C
+#define HOSTSIM_GIC_CPU_EOIR_OFFSET 0x10
+#define HOSTSIM_GIC_DIST_ISER_OFFSET 0x100
+#define HOSTSIM_GIC_DIST_ICER_OFFSET 0x180
+#define HOSTSIM_GIC_SPURIOUS_ID 1023
+#define HOSTSIM_GIC_INTERRUPT_COUNT 96
+
+// PS GPIO (MIO) register offsets.
+#define HOSTSIM_MIO_MASK_DATA_OFFSET 0x000
+#define HOSTSIM_MIO_DATA_OFFSET 0x040
+#define HOSTSIM_MIO_DATA_RO_OFFSET 0x060
+#define HOSTSIM_MIO_DIRM_OFFSET 0x204
+#define HOSTSIM_MIO_BANK_STRIDE 0x40
+#define HOSTSIM_MIO_BANK_COUNT 2
+
+// XADC register offsets.
+#define HOSTSIM_XADC_IPISR_OFFSET 0x60
+#define HOSTSIM_XADC_DATA_FIRST_OFFSET 0x200
+#define HOSTSIM_XADC_DATA_LAST_OFFSET 0x2FC
+
+typedef struct {
+  const char *name;
+  uint32_t baseAddress;
+  uint32_t span;
+} hostSim_deviceInfo_t;
+
+// Base addresses come from xparameters.h so the model and the code under test agree.
+static const hostSim_deviceInfo_t hostSim_devices[HOSTSIM_DEVICE_COUNT] = {
+  {"leds gpio",          XPAR_GPIO_LEDS_BASEADDR,             0x10},
+  {"buttons gpio",       XPAR_GPIO_PUSH_BUTTONS_BASEADDR,     0x10},
+  {"tft control gpio",   XPAR_AXI_GPIO_TFT_CONTROL_BASEADDR,  0x10},
+  {"tft data bus gpio",  XPAR_AXI_GPIO_TFT_DATA_BUS_BASEADDR, 0x10},
+  {"tft gpio",           XPAR_GPIO_TFT_0_BASEADDR,            0x10},
+  {"spi",                XPAR_SPI_0_BASEADDR,                 0x80},
+  {"axi timer 0",        XPAR_AXI_TIMER_0_BASEADDR,           0x20},
+  {"axi timer 1",        XPAR_AXI_TIMER_1_BASEADDR,           0x20},
+  {"axi timer 2",        XPAR_AXI_TIMER_2_BASEADDR,           0x20},
+  {"xadc",               XPAR_AXI_XADC_0_BASEADDR,            0x400},
+  {"mio gpio",           XPAR_XGPIOPS_0_BASEADDR,             0x300},
+  {"gic cpu",            XPAR_SCUGIC_CPU_BASEADDR,            0x100},
+  {"gic distributor",    XPAR_SCUGIC_DIST_BASEADDR,           0x1000},
+  {"global timer",       XPAR_GLOBAL_TMR_BASEADDR,            0x20},
+  {"scu timer",          XPAR_XSCUTIMER_0_BASEADDR,           0x10},
+};
+
+static uint32_t hostSim_registers[HOSTSIM_DEVICE_COUNT][HOSTSIM_MAX_REGISTERS];
+static uint64_t hostSim_readCounts[HOSTSIM_DEVICE_COUNT];
+static uint64_t hostSim_writeCounts[HOSTSIM_DEVICE_COUNT];
+static uint32_t hostSim_gpioInputs[HOSTSIM_DEVICE_COUNT];
+
+// Direct access to a modeled register (no accounting).
+#define hostSim_reg(device, offset) hostSim_registers[device][(offset) / 4]
+
+// ********************************* Time ******************************************
+
+static struct timespec hostSim_startTime;
+static bool hostSim_startTimeValid = false;
+static bool hostSim_virtualTime = false;
+static uint64_t hostSim_virtualNanoseconds = 0;
+
+uint64_t hostSim_getElapsedNanoseconds() {
+  if (hostSim_virtualTime)
+    return hostSim_virtualNanoseconds;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (!hostSim_startTimeValid) {
+    hostSim_startTime = now;
+    hostSim_startTimeValid = true;
+  }
+  return (uint64_t)(now.tv_sec - hostSim_startTime.tv_sec) * HOSTSIM_NANOSECONDS_PER_SECOND
+         + now.tv_nsec - hostSim_startTime.tv_nsec;
+}
+
+// Converts elapsed nanoseconds into ticks of a clock running at frequencyHz.
+static uint64_t hostSim_nanosecondsToTicks(uint64_t ns, uint64_t frequencyHz) {
+  return (ns / HOSTSIM_NANOSECONDS_PER_SECOND) * frequencyHz
+         + (ns % HOSTSIM_NANOSECONDS_PER_SECOND) * frequencyHz / HOSTSIM_NANOSECONDS_PER_SECOND;
+}
+
+// A free-running up-counter that can be stopped, started and loaded.
+typedef struct {
+  uint64_t value;         // Count accumulated while previously running.
+  uint64_t startedAtNs;   // When the counter was last started.
+  bool running;
+} hostSim_counter_t;
+
+static uint64_t hostSim_counterRead(hostSim_counter_t *counter, uint64_t frequencyHz) {
+  if (!counter->running)
+    return counter->value;
+  return counter->value + hostSim_nanosecondsToTicks(hostSim_getElapsedNanoseconds() - counter->startedAtNs, frequencyHz);
+}
+
+static void hostSim_counterLoad(hostSim_counter_t *counter, uint64_t value) {
+  counter->value = value;
+  counter->startedAtNs = hostSim_getElapsedNanoseconds();
+}
+
+static void hostSim_counterRun(hostSim_counter_t *counter, bool run, uint64_t frequencyHz) {
+  if (run == counter->running)
+    return;
+  counter->value = hostSim_counterRead(counter, frequencyHz);
+  counter->startedAtNs = hostSim_getElapsedNanoseconds();
+  counter->running = run;
+}
+
+// ************************** Interrupts (GIC + ARM IRQ) ***************************
+
+// Pending bits are also set from the SIGALRM handler, hence the atomic updates.
+static volatile uint32_t hostSim_pendingInterrupts[HOSTSIM_GIC_INTERRUPT_COUNT / 32];
+static uint32_t hostSim_interruptLines[HOSTSIM_GIC_INTERRUPT_COUNT / 32];  // Asserted level-sensitive lines.
+static uint32_t hostSim_activeInterrupt = HOSTSIM_GIC_SPURIOUS_ID;
+static void (*hostSim_irqHandler)(void *data) = NULL;
+static void *hostSim_irqHandlerData = NULL;
+static volatile bool hostSim_irqEnabled = false;
+static volatile bool hostSim_inIrq = false;
+// Interrupts are taken between bus accesses, never in the middle of one: anything raised
+// while an access is being modeled is delivered when the access completes.
+static volatile bool hostSim_accessInProgress = false;
+static volatile bool hostSim_deliveryDeferred = false;
+static volatile uint32_t hostSim_deliveredInterruptCount = 0;  // Ends hostSim_waitForInterrupt().
+
+static bool hostSim_isInterruptEnabledAtGic(uint32_t id) {
+  return hostSim_reg(HOSTSIM_GIC_DIST, HOSTSIM_GIC_DIST_ISER_OFFSET + (id / 32) * 4) & (1U << (id % 32));
+}
+
+// Returns the lowest numbered pending interrupt that is enabled at the GIC.
+static uint32_t hostSim_highestPendingInterrupt() {
+  for (uint32_t id = 0; id < HOSTSIM_GIC_INTERRUPT_COUNT; id++) {
+    if ((hostSim_pendingInterrupts[id / 32] & (1U << (id % 32))) && hostSim_isInterruptEnabledAtGic(id))
+      return id;
+  }
+  return HOSTSIM_GIC_SPURIOUS_ID;
+}
+
+// Runs the IRQ handler for as long as there is something enabled and pending.
+// Like the ARM core, IRQs do not nest.
+static void hostSim_deliverInterrupts() {
+  while (hostSim_irqEnabled && !hostSim_inIrq && hostSim_irqHandler &&
+         hostSim_highestPendingInterrupt() != HOSTSIM_GIC_SPURIOUS_ID) {
+    hostSim_inIrq = true;
+    hostSim_irqHandler(hostSim_irqHandlerData);
+    hostSim_inIrq = false;
+    hostSim_deliveredInterruptCount++;
+  }
+}
+
+static void hostSim_requestDelivery() {
+  if (hostSim_accessInProgress)
+    hostSim_deliveryDeferred = true;
+  else
+    hostSim_deliverInterrupts();
+}
+
+void hostSim_raiseInterrupt(uint32_t interruptId) {
+  if (interruptId >= HOSTSIM_GIC_INTERRUPT_COUNT)
+    return;
+  __sync_fetch_and_or(&hostSim_pendingInterrupts[interruptId / 32], 1U << (interruptId % 32));
+  hostSim_requestDelivery();
+}
+
+void hostSim_setInterruptLine(uint32_t interruptId, bool asserted) {
+  if (interruptId >= HOSTSIM_GIC_INTERRUPT_COUNT)
+    return;
+  uint32_t mask = 1U << (interruptId % 32);
+  uint32_t *line = &hostSim_interruptLines[interruptId / 32];
+  if (asserted == ((*line & mask) != 0))
+    return;
+  if (asserted) {
+    *line |= mask;
+    hostSim_raiseInterrupt(interruptId);
+  } else {
+    *line &= ~mask;
+    __sync_fetch_and_and(&hostSim_pendingInterrupts[interruptId / 32], ~mask);  // Not yet acknowledged: drops out.
+  }
+}
+
+void hostSim_registerIrqHandler(void (*handler)(void *data), void *data) {
+  hostSim_irqHandler = handler;
+  hostSim_irqHandlerData = data;
+}
+
+// The SCU timer is driven by SIGALRM, so masking IRQs also blocks the signal.
+// That keeps the handler from running in the middle of a masked section, just like the I bit.
+void hostSim_setIrqEnabled(bool enabled) {
+  sigset_t alarmSet;
+  sigemptyset(&alarmSet);
+  sigaddset(&alarmSet, SIGALRM);
+  hostSim_irqEnabled = enabled;
+  sigprocmask(enabled ? SIG_UNBLOCK : SIG_BLOCK, &alarmSet, NULL);
+  if (enabled)
+    hostSim_deliverInterrupts();
+}
+
+static void hostSim_updateDevices();
+
+static uint64_t hostSim_virtualSleepNanoseconds();
+
+// The core polls the device models while it sleeps. The SCU timer's SIGALRM is let through
+// even when IRQs are masked, so a deadline still ends the wait; its interrupt just stays pending.
+// In virtual time nothing sleeps: the clock jumps by a poll interval, or to the timer expiry.
+void hostSim_waitForInterrupt() {
+  struct timespec pollInterval = {0, HOSTSIM_WFI_POLL_NANOSECONDS};
+  uint32_t deliveredCount = hostSim_deliveredInterruptCount;
+  sigset_t alarmUnblocked, previous;
+  sigprocmask(SIG_BLOCK, NULL, &alarmUnblocked);
+  sigdelset(&alarmUnblocked, SIGALRM);
+  while (hostSim_highestPendingInterrupt() == HOSTSIM_GIC_SPURIOUS_ID &&
+         hostSim_deliveredInterruptCount == deliveredCount) {
+    if (hostSim_virtualTime) {
+      hostSim_virtualNanoseconds += hostSim_virtualSleepNanoseconds();
+    } else {
+      sigprocmask(SIG_SETMASK, &alarmUnblocked, &previous);
+      nanosleep(&pollInterval, NULL);
+      sigprocmask(SIG_SETMASK, &previous, NULL);
+    }
+    hostSim_updateDevices();
+  }
+}
+
+static uint32_t hostSim_gicCpuRead(uint32_t offset) {
+  if (offset == HOSTSIM_GIC_CPU_IAR_OFFSET) {
+    uint32_t id = hostSim_highestPendingInterrupt();
+    if (id != HOSTSIM_GIC_SPURIOUS_ID) {
+      __sync_fetch_and_and(&hostSim_pendingInterrupts[id / 32], ~(1U << (id % 32)));
+      hostSim_activeInterrupt = id;
+    }
+    return id;
+  }
+  return hostSim_reg(HOSTSIM_GIC_CPU, offset);
+}
+
+static void hostSim_gicCpuWrite(uint32_t offset, uint32_t value) {
+  if (offset == HOSTSIM_GIC_CPU_EOIR_OFFSET) {
+    uint32_t id = value & 0x3FF;
+    if (id == hostSim_activeInterrupt) {
+      hostSim_activeInterrupt = HOSTSIM_GIC_SPURIOUS_ID;
+      if (id < HOSTSIM_GIC_INTERRUPT_COUNT && (hostSim_interruptLines[id / 32] & (1U << (id % 32))))
+        hostSim_raiseInterrupt(id);  // Level-sensitive and still asserted.
+    }
+    return;
+  }
+  hostSim_reg(HOSTSIM_GIC_CPU, offset) = value;
+}
+
+static void hostSim_gicDistWrite(uint32_t offset, uint32_t value) {
+  // Set-enable and clear-enable registers both operate on the set-enable copy.
+  if (offset >= HOSTSIM_GIC_DIST_ISER_OFFSET && offset < HOSTSIM_GIC_DIST_ICER_OFFSET) {
+    hostSim_reg(HOSTSIM_GIC_DIST, offset) |= value;
+    hostSim_requestDelivery();
+  } else if (offset >= HOSTSIM_GIC_DIST_ICER_OFFSET && offset < HOSTSIM_GIC_DIST_ICER_OFFSET + 0x80) {
+    hostSim_reg(HOSTSIM_GIC_DIST, offset - HOSTSIM_GIC_DIST_ICER_OFFSET + HOSTSIM_GIC_DIST_ISER_OFFSET) &= ~value;
+  } else {
+    hostSim_reg(HOSTSIM_GIC_DIST, offset) = value;
+  }
+}
+
+// ******************************* AXI GPIO ***************************************
+
+uint32_t hostSim_getGpioInputs(hostSim_device_t device) {
+  return hostSim_gpioInputs[device];
+}
+
+void hostSim_setGpioInputs(hostSim_device_t device, uint32_t value) {
+  hostSim_gpioInputs[device] = value;
+}
+
+void hostSim_setButtons(uint32_t value) {
+  hostSim_setGpioInputs(HOSTSIM_BUTTONS_GPIO, value);
+}
+
+// Pins configured as inputs (tri-state bit = 1) read the outside world, outputs read back.
+static uint32_t hostSim_gpioRead(hostSim_device_t device, uint32_t offset) {
+  if (offset == HOSTSIM_GPIO_DATA_OFFSET) {
+    uint32_t tri = hostSim_reg(device, HOSTSIM_GPIO_TRI_OFFSET);
+    return (hostSim_reg(device, HOSTSIM_GPIO_DATA_OFFSET) & ~tri) | (hostSim_gpioInputs[device] & tri);
+  }
+  return hostSim_reg(device, offset);
+}
+
+// ******************************* AXI timers *************************************
+
+static hostSim_counter_t hostSim_axiTimerCounters[3];
+
+static uint64_t hostSim_axiTimerFrequency(hostSim_device_t device) {
+  switch (device) {
+  case HOSTSIM_AXI_TIMER_1: return XPAR_AXI_TIMER_1_CLOCK_FREQ_HZ;
+  case HOSTSIM_AXI_TIMER_2: return XPAR_AXI_TIMER_2_CLOCK_FREQ_HZ;
+  default:                  return XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ;
+  }
+}
+
+// The timers are only ever used in cascade mode (one 64-bit up-counter), so that is what is modeled.
+static uint32_t hostSim_axiTimerRead(hostSim_device_t device, uint32_t offset) {
+  hostSim_counter_t *counter = &hostSim_axiTimerCounters[device - HOSTSIM_AXI_TIMER_0];
+  uint64_t value = hostSim_counterRead(counter, hostSim_axiTimerFrequency(device));
+  if (offset == HOSTSIM_AXI_TIMER_TCR0_OFFSET)
+    return (uint32_t) value;
+  if (offset == HOSTSIM_AXI_TIMER_TCR1_OFFSET)
+    return (uint32_t)(value >> 32);
+  return hostSim_reg(device, offset);
+}
+
+static void hostSim_axiTimerWrite(hostSim_device_t device, uint32_t offset, uint32_t value) {
+  hostSim_counter_t *counter = &hostSim_axiTimerCounters[device - HOSTSIM_AXI_TIMER_0];
+  uint64_t frequency = hostSim_axiTimerFrequency(device);
+  hostSim_reg(device, offset) = value;
+  if (offset == HOSTSIM_AXI_TIMER_TCSR0_OFFSET) {
+    if (value & HOSTSIM_AXI_TIMER_TCSR_LOAD_MASK) {
+      uint64_t current = hostSim_counterRead(counter, frequency);
+      hostSim_counterLoad(counter, (current & 0xFFFFFFFF00000000ULL) | hostSim_reg(device, HOSTSIM_AXI_TIMER_TLR0_OFFSET));
+    }
+    hostSim_counterRun(counter, value & HOSTSIM_AXI_TIMER_TCSR_ENT_MASK, frequency);
+  } else if (offset == HOSTSIM_AXI_TIMER_TCSR1_OFFSET && (value & HOSTSIM_AXI_TIMER_TCSR_LOAD_MASK)) {
+    uint64_t current = hostSim_counterRead(counter, frequency);
+    hostSim_counterLoad(counter, (current & 0xFFFFFFFFULL) | ((uint64_t) hostSim_reg(device, HOSTSIM_AXI_TIMER_TLR1_OFFSET) << 32));
+  }
+}
+
+// ****************************** Global timer ************************************
+
+static hostSim_counter_t hostSim_globalTimerCounter = {0, 0, true};  // The boot code leaves it running.
+
+static uint32_t hostSim_globalTimerRead(uint32_t offset) {
+  uint64_t value = hostSim_counterRead(&hostSim_globalTimerCounter, HOSTSIM_CPU_PRIVATE_CLOCK_HZ);
+  if (offset == HOSTSIM_GLOBAL_TIMER_LOWER_OFFSET)
+    return (uint32_t) value;
+  if (offset == HOSTSIM_GLOBAL_TIMER_UPPER_OFFSET)
+    return (uint32_t)(value >> 32);
+  if (offset == HOSTSIM_GLOBAL_TIMER_CONTROL_OFFSET)
+    return (hostSim_reg(HOSTSIM_GLOBAL_TIMER, offset) & ~HOSTSIM_GLOBAL_TIMER_ENABLE_MASK) |
+           (hostSim_globalTimerCounter.running ? HOSTSIM_GLOBAL_TIMER_ENABLE_MASK : 0);
+  return hostSim_reg(HOSTSIM_GLOBAL_TIMER, offset);
+}
+
+static void hostSim_globalTimerWrite(uint32_t offset, uint32_t value) {
+  hostSim_reg(HOSTSIM_GLOBAL_TIMER, offset) = value;
+  if (offset == HOSTSIM_GLOBAL_TIMER_CONTROL_OFFSET)
+    hostSim_counterRun(&hostSim_globalTimerCounter, value & HOSTSIM_GLOBAL_TIMER_ENABLE_MASK, HOSTSIM_CPU_PRIVATE_CLOCK_HZ);
+}
+
+// ***************************** SCU private timer *********************************
+
+static uint64_t hostSim_scuTimerStartedAtNs;
+static uint64_t hostSim_scuTimerExpiryNs = 0;  // Virtual time: when the next interrupt is due, 0 if none is.
+
+static uint64_t hostSim_scuTimerPeriodNs() {
+  uint32_t control = hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_CONTROL_OFFSET);
+  uint64_t prescaler = ((control & HOSTSIM_SCU_TIMER_PRESCALER_MASK) >> HOSTSIM_SCU_TIMER_PRESCALER_SHIFT) + 1;
+  uint64_t load = (uint64_t) hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_LOAD_OFFSET) + 1;
+  return load * prescaler * HOSTSIM_NANOSECONDS_PER_SECOND / HOSTSIM_CPU_PRIVATE_CLOCK_HZ;
+}
+
+// The timer tick also lets the other devices catch up when the main program isn't touching
+// the model, e.g. while it spins waiting for interrupts.
+static void hostSim_scuTimerSignalHandler(int signalNumber) {
+  if (!hostSim_accessInProgress)
+    hostSim_updateDevices();
+  hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_ISR_OFFSET) |= HOSTSIM_SCU_TIMER_EVENT_FLAG_MASK;
+  hostSim_raiseInterrupt(XPAR_SCUTIMER_INTR);
+}
+
+// The timer interrupt is produced by a real interval timer (SIGALRM) at the programmed period.
+// In virtual time the expiry is just noted, and hostSim_scuTimerExpire() acts on it.
+static void hostSim_scuTimerUpdateAlarm() {
+  static bool handlerInstalled = false;
+  uint32_t control = hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_CONTROL_OFFSET);
+  bool interrupting = (control & HOSTSIM_SCU_TIMER_ENABLE_MASK) && (control & HOSTSIM_SCU_TIMER_IRQ_ENABLE_MASK);
+  if (hostSim_virtualTime) {
+    hostSim_scuTimerExpiryNs = interrupting ? hostSim_virtualNanoseconds + hostSim_scuTimerPeriodNs() : 0;
+    return;
+  }
+  struct itimerval timerValue;
+  memset(&timerValue, 0, sizeof(timerValue));
+  if (interrupting) {
+    if (!handlerInstalled) {
+      struct sigaction action;
+      memset(&action, 0, sizeof(action));
+      action.sa_handler = hostSim_scuTimerSignalHandler;
+      action.sa_flags = SA_RESTART;
+      sigemptyset(&action.sa_mask);
+      sigaction(SIGALRM, &action, NULL);
+      handlerInstalled = true;
+    }
+    uint64_t periodNs = hostSim_scuTimerPeriodNs();
+    timerValue.it_value.tv_sec = periodNs / HOSTSIM_NANOSECONDS_PER_SECOND;
+    timerValue.it_value.tv_usec = (periodNs % HOSTSIM_NANOSECONDS_PER_SECOND) / 1000;
+    if (timerValue.it_value.tv_sec == 0 && timerValue.it_value.tv_usec == 0)
+      timerValue.it_value.tv_usec = 1;
+    if (control & HOSTSIM_SCU_TIMER_AUTO_RELOAD_MASK)
+      timerValue.it_interval = timerValue.it_value;
+  }
+  setitimer(ITIMER_REAL, &timerValue, NULL);
+}
+
+// Virtual time: raises the interrupt once the expiry has passed. Like the hardware, an auto-reload
+// timer that was not looked at for several periods has just the one interrupt pending.
+static void hostSim_scuTimerExpire() {
+  if (!hostSim_scuTimerExpiryNs || hostSim_virtualNanoseconds < hostSim_scuTimerExpiryNs)
+    return;
+  bool autoReload = hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_CONTROL_OFFSET) & HOSTSIM_SCU_TIMER_AUTO_RELOAD_MASK;
+  uint64_t periodNs = hostSim_scuTimerPeriodNs();
+  while (hostSim_scuTimerExpiryNs && hostSim_scuTimerExpiryNs <= hostSim_virtualNanoseconds)
+    hostSim_scuTimerExpiryNs = autoReload ? hostSim_scuTimerExpiryNs + periodNs : 0;
+  hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_ISR_OFFSET) |= HOSTSIM_SCU_TIMER_EVENT_FLAG_MASK;
+  hostSim_raiseInterrupt(XPAR_SCUTIMER_INTR);
+}
+
+// How far a sleeping core moves the virtual clock in one step: a poll interval, but no further
+// than the timer expiry or the next replayed touch, so that both come on the nanosecond.
+static uint64_t hostSim_virtualSleepNanoseconds() {
+  uint64_t wakeNs = hostSim_virtualNanoseconds + HOSTSIM_WFI_POLL_NANOSECONDS;
+  if (hostSim_scuTimerExpiryNs > hostSim_virtualNanoseconds && hostSim_scuTimerExpiryNs < wakeNs)
+    wakeNs = hostSim_scuTimerExpiryNs;
+  uint64_t replayNs = hostSimReplay_getNextEventNanoseconds();
+  if (replayNs > hostSim_virtualNanoseconds && replayNs < wakeNs)
+    wakeNs = replayNs;
+  return wakeNs - hostSim_virtualNanoseconds;
+}
+
+void hostSim_useVirtualTime() {
+  if (hostSim_virtualTime)
+    return;
+  hostSim_virtualNanoseconds = hostSim_getElapsedNanoseconds();
+  hostSim_virtualTime = true;
+  hostSim_scuTimerUpdateAlarm();  // Moves a running timer over from SIGALRM.
+}
+
+// The counter counts down from the load value; with auto-reload it wraps back to the load value.
+static uint32_t hostSim_scuTimerRead(uint32_t offset) {
+  if (offset == HOSTSIM_SCU_TIMER_COUNTER_OFFSET &&
+      (hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_CONTROL_OFFSET) & HOSTSIM_SCU_TIMER_ENABLE_MASK)) {
+    uint32_t control = hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_CONTROL_OFFSET);
+    uint64_t prescaler = ((control & HOSTSIM_SCU_TIMER_PRESCALER_MASK) >> HOSTSIM_SCU_TIMER_PRESCALER_SHIFT) + 1;
+    uint64_t load = hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_LOAD_OFFSET);
+    uint64_t ticks = hostSim_nanosecondsToTicks(hostSim_getElapsedNanoseconds() - hostSim_scuTimerStartedAtNs,
+                                                HOSTSIM_CPU_PRIVATE_CLOCK_HZ) / prescaler;
+    if (control & HOSTSIM_SCU_TIMER_AUTO_RELOAD_MASK)
+      return (uint32_t)(load - ticks % (load + 1));
+    return ticks >= load ? 0 : (uint32_t)(load - ticks);
+  }
+  return hostSim_reg(HOSTSIM_SCU_TIMER, offset);
+}
+
+static void hostSim_scuTimerWrite(uint32_t offset, uint32_t value) {
+  uint32_t oldControl = hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_CONTROL_OFFSET);
+  switch (offset) {
+  case HOSTSIM_SCU_TIMER_ISR_OFFSET:
+    hostSim_reg(HOSTSIM_SCU_TIMER, offset) &= ~value;  // Write 1 to clear.
+    return;
+  case HOSTSIM_SCU_TIMER_LOAD_OFFSET:
+    // Writing the load register also reloads the counter.
+    hostSim_reg(HOSTSIM_SCU_TIMER, offset) = value;
+    hostSim_reg(HOSTSIM_SCU_TIMER, HOSTSIM_SCU_TIMER_COUNTER_OFFSET) = value;
+    hostSim_scuTimerStartedAtNs = hostSim_getElapsedNanoseconds();
+    break;
+  case HOSTSIM_SCU_TIMER_CONTROL_OFFSET:
+    hostSim_reg(HOSTSIM_SCU_TIMER, offset) = value;
+    if ((value & HOSTSIM_SCU_TIMER_ENABLE_MASK) && !(oldControl & HOSTSIM_SCU_TIMER_ENABLE_MASK))
+      hostSim_scuTimerStartedAtNs = hostSim_getElapsedNanoseconds();
+    else if (value == oldControl)
+      return;  // Nothing changed, don't disturb the running alarm.
+    break;
+  default:
+    hostSim_reg(HOSTSIM_SCU_TIMER, offset) = value;
+    return;
+  }
+  hostSim_scuTimerUpdateAlarm();
+}
+
+// ********************************* PS GPIO (MIO) *********************************
+
+// MASK_DATA registers update the pins whose mask bit (upper half) is 0.
+static void hostSim_mioWrite(uint32_t offset, uint32_t value) {
+  if (offset < HOSTSIM_MIO_DATA_OFFSET) {
+    uint32_t bank = offset / 8;
+    uint32_t shift = (offset & 0x4) ? 16 : 0;
+    uint32_t updateMask = (~value >> 16) & 0xFFFF;
+    uint32_t dataOffset = HOSTSIM_MIO_DATA_OFFSET + bank * 4;
+    uint32_t data = hostSim_reg(HOSTSIM_MIO_GPIO, dataOffset);
+    data = (data & ~(updateMask << shift)) | ((value & updateMask) << shift);
+    hostSim_reg(HOSTSIM_MIO_GPIO, dataOffset) = data;
+    return;
+  }
+  hostSim_reg(HOSTSIM_MIO_GPIO, offset) = value;
+}
+
+static uint32_t hostSim_mioRead(uint32_t offset) {
+  if (offset >= HOSTSIM_MIO_DATA_RO_OFFSET && offset < HOSTSIM_MIO_DATA_RO_OFFSET + HOSTSIM_MIO_BANK_COUNT * 4) {
+    uint32_t bank = (offset - HOSTSIM_MIO_DATA_RO_OFFSET) / 4;
+    uint32_t direction = hostSim_reg(HOSTSIM_MIO_GPIO, HOSTSIM_MIO_DIRM_OFFSET + bank * HOSTSIM_MIO_BANK_STRIDE);
+    return hostSim_reg(HOSTSIM_MIO_GPIO, HOSTSIM_MIO_DATA_OFFSET + bank * 4) & direction;
+  }
+  return hostSim_reg(HOSTSIM_MIO_GPIO, offset);
+}
+
+// ************************************* XADC **************************************
+
+// Aux channel conversions return mid-scale plus a few LSBs of noise, like a floating input.
+static uint32_t hostSim_xadcRead(uint32_t offset) {
+  static uint32_t noiseState = 0x2545F491;
+  if (offset >= HOSTSIM_XADC_DATA_FIRST_OFFSET && offset <= HOSTSIM_XADC_DATA_LAST_OFFSET) {
+    noiseState = noiseState * 1664525 + 1013904223;
+    return (0x8000 + ((noiseState >> 16) & 0x3F0)) & 0xFFF0;
+  }
+  return hostSim_reg(HOSTSIM_XADC, offset);
+}
+
+static void hostSim_xadcWrite(uint32_t offset, uint32_t value) {
+  if (offset == HOSTSIM_XADC_IPISR_OFFSET)
+    hostSim_reg(HOSTSIM_XADC, offset) &= ~value;  // Write 1 to clear (toggle-on-write in the core).
+  else
+    hostSim_reg(HOSTSIM_XADC, offset) = value;
+}
+
+// ****************************** Dispatch and accounting **************************
+
+// Saves the LCD contents to the file named by HOSTSIM_SCREENSHOT, if set.
+static void hostSim_writeScreenshot() {
+  const char *fileName = getenv("HOSTSIM_SCREENSHOT");
+  if (fileName)
+    hostSimLcd_writePpm(fileName);
+}
+
+// Runs on the first access: picks up the stimulus script and the touch recording to make or
+// replay, and arranges for the access counts to be printed (and the screen saved) at exit.
+static void hostSim_initialize() {
+  static bool initialized = false;
+  if (initialized)
+    return;
+  initialized = true;
+  if (getenv("HOSTSIM_VIRTUAL_TIME"))
+    hostSim_useVirtualTime();
+  const char *stimulusFileName = getenv("HOSTSIM_STIMULUS");
+  if (stimulusFileName)
+    hostSim_loadStimulus(stimulusFileName);
+  const char *recordFileName = getenv("HOSTSIM_TOUCH_RECORD");
+  if (recordFileName)
+    hostSimReplay_startRecording(recordFileName);
+  const char *replayFileName = getenv("HOSTSIM_TOUCH_REPLAY");
+  if (replayFileName)
+    hostSimReplay_start(replayFileName);
+  atexit(hostSim_printAccessCounts);
+  atexit(hostSim_writeScreenshot);
+}
+
+// Devices that change state on their own: the stimulus script, the virtual player, a touch
+// replay, the touch controller and, in virtual time, the SCU timer.
+static void hostSim_updateDevices() {
+  hostSim_applyStimulus();
+  hostSimPlayer_update();
+  hostSimReplay_update();
+  hostSimSpi_update();
+  if (hostSim_virtualTime)
+    hostSim_scuTimerExpire();
+}
+
+// Common to every access: stimulus is applied from the main program only, never from an ISR.
+// Returns true for the outermost access, the one that has to deliver deferred interrupts.
+static bool hostSim_beginAccess() {
+  hostSim_initialize();
+  bool outermost = !hostSim_accessInProgress;
+  hostSim_accessInProgress = true;
+  if (hostSim_virtualTime)
+    hostSim_virtualNanoseconds += HOSTSIM_VIRTUAL_ACCESS_NANOSECONDS;
+  if (!hostSim_inIrq)
+    hostSim_updateDevices();
+  return outermost;
+}
+
+static void hostSim_endAccess(bool outermost) {
+  if (!outermost)
+    return;
+  hostSim_accessInProgress = false;
+  if (hostSim_deliveryDeferred) {
+    hostSim_deliveryDeferred = false;
+    hostSim_deliverInterrupts();
+  }
+}
+
+// Returns the device that decodes address, or HOSTSIM_DEVICE_COUNT if nothing does.
+static hostSim_device_t hostSim_findDevice(uint32_t address) {
+  for (int i = 0; i < HOSTSIM_DEVICE_COUNT; i++) {
+    if (address >= hostSim_devices[i].baseAddress && address < hostSim_devices[i].baseAddress + hostSim_devices[i].span)
+      return (hostSim_device_t) i;
+  }
+  return HOSTSIM_DEVICE_COUNT;
+}
+
+static uint32_t hostSim_dispatchRead(uint32_t address) {
+  hostSim_device_t device = hostSim_findDevice(address);
+  if (device == HOSTSIM_DEVICE_COUNT) {
+    printf("hostSim: read from unmapped address 0x%08x\n\r", (unsigned) address);
+    return 0;
+  }
+  hostSim_readCounts[device]++;
+  uint32_t offset = (address - hostSim_devices[device].baseAddress) & ~0x3;
+  switch (device) {
+  case HOSTSIM_TFT_CONTROL_GPIO:
+  case HOSTSIM_TFT_DATA_BUS_GPIO:
+  case HOSTSIM_TFT_GPIO:
+    hostSimLcd_observeAccess(device, offset, false, 0);
+    return hostSim_gpioRead(device, offset);
+  case HOSTSIM_LEDS_GPIO:
+  case HOSTSIM_BUTTONS_GPIO:
+    return hostSim_gpioRead(device, offset);
+  case HOSTSIM_SPI:
+    return hostSimSpi_readRegister(offset);
+  case HOSTSIM_AXI_TIMER_0:
+  case HOSTSIM_AXI_TIMER_1:
+  case HOSTSIM_AXI_TIMER_2:
+    return hostSim_axiTimerRead(device, offset);
+  case HOSTSIM_XADC:
+    return hostSim_xadcRead(offset);
+  case HOSTSIM_MIO_GPIO:
+    return hostSim_mioRead(offset);
+  case HOSTSIM_GIC_CPU:
+    return hostSim_gicCpuRead(offset);
+  case HOSTSIM_GLOBAL_TIMER:
+    return hostSim_globalTimerRead(offset);
+  case HOSTSIM_SCU_TIMER:
+    return hostSim_scuTimerRead(offset);
+  default:
+    return hostSim_reg(device, offset);
+  }
+}
+
+static void hostSim_dispatchWrite(uint32_t address, uint32_t value) {
+  hostSim_device_t device = hostSim_findDevice(address);
+  if (device == HOSTSIM_DEVICE_COUNT) {
+    printf("hostSim: write of 0x%08x to unmapped address 0x%08x\n\r", (unsigned) value, (unsigned) address);
+    return;
+  }
+  hostSim_writeCounts[device]++;
+  uint32_t offset = (address - hostSim_devices[device].baseAddress) & ~0x3;
+  switch (device) {
+  case HOSTSIM_TFT_CONTROL_GPIO:
+  case HOSTSIM_TFT_DATA_BUS_GPIO:
+  case HOSTSIM_TFT_GPIO:
+    hostSimLcd_observeAccess(device, offset, true, value);
+    hostSim_reg(device, offset) = value;
+    break;
+  case HOSTSIM_SPI:
+    hostSimSpi_writeRegister(offset, value);
+    break;
+  case HOSTSIM_AXI_TIMER_0:
+  case HOSTSIM_AXI_TIMER_1:
+  case HOSTSIM_AXI_TIMER_2:
+    hostSim_axiTimerWrite(device, offset, value);
+    break;
+  case HOSTSIM_XADC:
+    hostSim_xadcWrite(offset, value);
+    break;
+  case HOSTSIM_MIO_GPIO:
+    hostSim_mioWrite(offset, value);
+    break;
+  case HOSTSIM_GIC_CPU:
+    hostSim_gicCpuWrite(offset, value);
+    break;
+  case HOSTSIM_GIC_DIST:
+    hostSim_gicDistWrite(offset, value);
+    break;
+  case HOSTSIM_GLOBAL_TIMER:
+    hostSim_globalTimerWrite(offset, value);
+    break;
+  case HOSTSIM_SCU_TIMER:
+    hostSim_scuTimerWrite(offset, value);
+    break;
+  default:
+    hostSim_reg(device, offset) = value;
+    break;
+  }
+}
+
+uint32_t hostSim_read32(uint32_t address) {
+  bool outermost = hostSim_beginAccess();
+  uint32_t value = hostSim_dispatchRead(address);
+  hostSim_endAccess(outermost);
+  return value;
+}
+
+void hostSim_write32(uint32_t address, uint32_t value) {
+  bool outermost = hostSim_beginAccess();
+  hostSim_dispatchWrite(address, value);
+  hostSim_endAccess(outermost);
+}
+
+uint64_t hostSim_getReadCount(hostSim_device_t device) {
+  return hostSim_readCounts[device];
+}
+
+uint64_t hostSim_getWriteCount(hostSim_device_t device) {
+  return hostSim_writeCounts[device];
+}
+
+uint64_t hostSim_getTotalAccessCount() {
+  uint64_t total = 0;
+  for (int i = 0; i < HOSTSIM_DEVICE_COUNT; i++)
+    total += hostSim_readCounts[i] + hostSim_writeCounts[i];
+  return total;
+}
+
+const char *hostSim_getDeviceName(hostSim_device_t device) {
+  return hostSim_devices[device].name;
+}
+
+void hostSim_resetAccessCounts() {
+  memset(hostSim_readCounts, 0, sizeof(hostSim_readCounts));
+  memset(hostSim_writeCounts, 0, sizeof(hostSim_writeCounts));
+}
+
+// Prints one line per device that has seen any traffic.
+void hostSim_printAccessCounts() {
+  printf("%-20s %12s %12s\n\r", "device", "reads", "writes");
+  for (int i = 0; i < HOSTSIM_DEVICE_COUNT; i++) {
+    if (hostSim_readCounts[i] || hostSim_writeCounts[i])
+      printf("%-20s %12llu %12llu\n\r", hostSim_devices[i].name,
+             (unsigned long long) hostSim_readCounts[i], (unsigned long long) hostSim_writeCounts[i]);
+  }
+}
@@ -0,0 +1,95 @@
+/*
+ * hostSim.h
+ *
+ * Host-side model of the ZYBO hardware. Everything that the supportFiles and src code
+ * reaches through Xil_In32/Xil_Out32 (or the Xilinx drivers that sit on top of them)
+ * lands here: the AXI GPIO blocks, the AXI SPI controller (with the STMPE610 behind it),
+ * the AXI timers, the XADC, the PS GPIO (MIO), the GIC and the Cortex-A9 private and
+ * global timers. Every MMIO access is counted per device so that bus traffic per
+ * operation can be measured without a board.
+ */
+
+#ifndef HOSTSIM_H_
+#define HOSTSIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// One entry per modeled register file.
+typedef enum {
+  HOSTSIM_LEDS_GPIO,
+  HOSTSIM_BUTTONS_GPIO,
+  HOSTSIM_TFT_CONTROL_GPIO,
+  HOSTSIM_TFT_DATA_BUS_GPIO,
+  HOSTSIM_TFT_GPIO,
+  HOSTSIM_SPI,
+  HOSTSIM_AXI_TIMER_0,
+  HOSTSIM_AXI_TIMER_1,
+  HOSTSIM_AXI_TIMER_2,
+  HOSTSIM_XADC,
+  HOSTSIM_MIO_GPIO,
+  HOSTSIM_GIC_CPU,
+  HOSTSIM_GIC_DIST,
+  HOSTSIM_GLOBAL_TIMER,
+  HOSTSIM_SCU_TIMER,
+  HOSTSIM_DEVICE_COUNT
+} hostSim_device_t;
+
+// Register access. These are what Xil_In32 and Xil_Out32 map to on the host.
+uint32_t hostSim_read32(uint32_t address);
+void hostSim_write32(uint32_t address, uint32_t value);
+
+// Per-device access accounting.
+uint64_t hostSim_getReadCount(hostSim_device_t device);
+uint64_t hostSim_getWriteCount(hostSim_device_t device);
+uint64_t hostSim_getTotalAccessCount();
+const char *hostSim_getDeviceName(hostSim_device_t device);
+void hostSim_resetAccessCounts();
+void hostSim_printAccessCounts();
+
+// Elapsed time since the model came up. All of the modeled counters derive from this.
+uint64_t hostSim_getElapsedNanoseconds();
+// Switches the model from the host's clock to a virtual one, for good: every bus access costs
+// 100 ns (an uncached AXI access) and a WFI skips ahead to the next thing that can happen.
+// Runs are deterministic and as fast as the host allows. Code that spins on memory without
+// touching the bus or waiting for an interrupt doesn't move the clock (utils_msDelay() is free).
+// Setting the HOSTSIM_VIRTUAL_TIME environment variable does this before the first access.
+void hostSim_useVirtualTime();
+
+// Interrupt model. Devices raise GIC interrupt IDs; delivery to the registered IRQ
+// handler is gated by the ARM IRQ enable (Xil_ExceptionEnable/Disable).
+void hostSim_raiseInterrupt(uint32_t interruptId);
+void hostSim_registerIrqHandler(void (*handler)(void *data), void *data);
+void hostSim_setIrqEnabled(bool enabled);
+// Level-sensitive interrupt lines from the device models. The interrupt stays pending while
+// the line is asserted and is raised again after the handler's EOI if it still is.
+void hostSim_setInterruptLine(uint32_t interruptId, bool asserted);
+// WFI. Returns once an interrupt that is enabled at the GIC is pending, or has been taken if the
+// ARM IRQ is enabled. The devices and the stimulus script keep running while the core sleeps.
+void hostSim_waitForInterrupt();
+
+// Used by the device models to look up GPIO inputs and SPI slaves.
+uint32_t hostSim_getGpioInputs(hostSim_device_t device);
+void hostSim_setGpioInputs(hostSim_device_t device, uint32_t value);
+
+// Stimulus for the four push buttons (bit3 = BTN3 ... bit0 = BTN0, '1' = pressed).
+void hostSim_setButtons(uint32_t value);
+
+// Stimulus for the touch panel, in raw STMPE610 ADC coordinates (12 bits).
+void hostSim_touchDown(uint16_t rawX, uint16_t rawY, uint8_t z);
+void hostSim_touchUp();
+bool hostSim_isTouchDown();
+
+// Timed stimulus script, one event per line: "<ms> touch <rawX> <rawY> <z>", "<ms> release"
+// or "<ms> buttons <mask>". Events are applied as soon as the model's time reaches them.
+// The script named by the HOSTSIM_STIMULUS environment variable is loaded automatically.
+bool hostSim_loadStimulus(const char *fileName);
+void hostSim_applyStimulus();
+
+// SPI controller model (hostSimSpi.c).
+uint32_t hostSimSpi_readRegister(uint32_t offset);
+void hostSimSpi_writeRegister(uint32_t offset, uint32_t value);
+// Lets the STMPE610 take the samples that are due and updates its INT line.
+void hostSimSpi_update();
+
+#endif /* HOSTSIM_H_ */
@@ -0,0 +1,332 @@
+/*
+ * hostSimLcd.c
+ *
+ * 8080 bus decoder, ILI9341 GRAM model and bus cost accounting. See hostSimLcd.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hostSimLcd.h"
+
+// Control GPIO bits (same as lcd.h).
+#define HOSTSIMLCD_DCX_BIT_MASK 0x1
+#define HOSTSIMLCD_RD_BIT_MASK 0x2
+#define HOSTSIMLCD_WR_BIT_MASK 0x4
+#define HOSTSIMLCD_GPIO_DATA_OFFSET 0x0
+
+// Default AXI GPIO latencies. 76800 pixels * 6 reads + 6 writes each = 165 ms.
+#define HOSTSIMLCD_DEFAULT_READ_NS 200
+#define HOSTSIMLCD_DEFAULT_WRITE_NS 160
+
+// ILI9341 8080-I write timing minimums.
+#define HOSTSIMLCD_MIN_WR_LOW_NS 15
+#define HOSTSIMLCD_MIN_WR_HIGH_NS 15
+#define HOSTSIMLCD_MIN_WRITE_CYCLE_NS 66
+
+// ILI9341 commands that the GRAM model follows.
+#define HOSTSIMLCD_CMD_COLUMN_ADDRESS_SET 0x2A
+#define HOSTSIMLCD_CMD_PAGE_ADDRESS_SET 0x2B
+#define HOSTSIMLCD_CMD_MEMORY_WRITE 0x2C
+#define HOSTSIMLCD_CMD_MEMORY_ACCESS_CONTROL 0x36
+#define HOSTSIMLCD_CMD_WRITE_MEMORY_CONTINUE 0x3C
+#define HOSTSIMLCD_MADCTL_MY 0x80
+#define HOSTSIMLCD_MADCTL_MX 0x40
+#define HOSTSIMLCD_MADCTL_MV 0x20
+
+#define HOSTSIMLCD_MAX_PRIMITIVES 64
+
+// *********************************** Bus state ***********************************
+
+static uint32_t hostSimLcd_readLatencyNs = HOSTSIMLCD_DEFAULT_READ_NS;
+static uint32_t hostSimLcd_writeLatencyNs = HOSTSIMLCD_DEFAULT_WRITE_NS;
+static bool hostSimLcd_latencyConfigured = false;
+
+static hostSimLcd_counts_t hostSimLcd_counts;
+static uint32_t hostSimLcd_controlValue = HOSTSIMLCD_RD_BIT_MASK | HOSTSIMLCD_WR_BIT_MASK;
+static uint32_t hostSimLcd_dataBusValue = 0;
+static uint64_t hostSimLcd_wrFallNs = 0;
+static uint64_t hostSimLcd_wrRiseNs = 0;
+static bool hostSimLcd_wrHasRisen = false;
+
+// ********************************** GRAM model ***********************************
+
+static uint16_t hostSimLcd_gram[HOSTSIMLCD_PANEL_HEIGHT][HOSTSIMLCD_PANEL_WIDTH];
+static uint8_t hostSimLcd_madctl = 0;
+static uint16_t hostSimLcd_startColumn = 0, hostSimLcd_endColumn = HOSTSIMLCD_PANEL_WIDTH - 1;
+static uint16_t hostSimLcd_startPage = 0, hostSimLcd_endPage = HOSTSIMLCD_PANEL_HEIGHT - 1;
+static uint16_t hostSimLcd_column = 0, hostSimLcd_page = 0;
+static uint8_t hostSimLcd_command = 0;
+static uint32_t hostSimLcd_parameterIndex = 0;
+static uint8_t hostSimLcd_parameters[4];
+static uint8_t hostSimLcd_pixelHighByte = 0;
+
+// Maps a (column, page) address to a GRAM cell through the MADCTL exchange/mirror bits.
+// Returns false if the address is outside of the panel.
+static bool hostSimLcd_mapAddress(uint16_t column, uint16_t page, uint16_t *physicalColumn, uint16_t *physicalRow) {
+  uint16_t c = column, r = page;
+  if (hostSimLcd_madctl & HOSTSIMLCD_MADCTL_MV) {
+    c = page;
+    r = column;
+  }
+  if (c >= HOSTSIMLCD_PANEL_WIDTH || r >= HOSTSIMLCD_PANEL_HEIGHT)
+    return false;
+  if (hostSimLcd_madctl & HOSTSIMLCD_MADCTL_MX)
+    c = HOSTSIMLCD_PANEL_WIDTH - 1 - c;
+  if (hostSimLcd_madctl & HOSTSIMLCD_MADCTL_MY)
+    r = HOSTSIMLCD_PANEL_HEIGHT - 1 - r;
+  *physicalColumn = c;
+  *physicalRow = r;
+  return true;
+}
+
+// Stores one pixel at the address pointer and advances it through the window.
+static void hostSimLcd_writePixel(uint16_t color) {
+  uint16_t c, r;
+  if (hostSimLcd_mapAddress(hostSimLcd_column, hostSimLcd_page, &c, &r))
+    hostSimLcd_gram[r][c] = color;
+  if (hostSimLcd_column >= hostSimLcd_endColumn) {
+    hostSimLcd_column = hostSimLcd_startColumn;
+    hostSimLcd_page = hostSimLcd_page >= hostSimLcd_endPage ? hostSimLcd_startPage : hostSimLcd_page + 1;
+  } else {
+    hostSimLcd_column++;
+  }
+}
+
+static void hostSimLcd_decodeCommand(uint8_t command) {
+  hostSimLcd_command = command;
+  hostSimLcd_parameterIndex = 0;
+  if (command == HOSTSIMLCD_CMD_MEMORY_WRITE) {
+    hostSimLcd_column = hostSimLcd_startColumn;
+    hostSimLcd_page = hostSimLcd_startPage;
+  }
+}
+
+static void hostSimLcd_decodeData(uint8_t data) {
+  uint32_t index = hostSimLcd_parameterIndex++;
+  switch (hostSimLcd_command) {
+  case HOSTSIMLCD_CMD_COLUMN_ADDRESS_SET:
+  case HOSTSIMLCD_CMD_PAGE_ADDRESS_SET:
+    if (index < 4)
+      hostSimLcd_parameters[index] = data;
+    if (index == 3) {
+      uint16_t start = (hostSimLcd_parameters[0] << 8) | hostSimLcd_parameters[1];
+      uint16_t end = (hostSimLcd_parameters[2] << 8) | hostSimLcd_parameters[3];
+      if (hostSimLcd_command == HOSTSIMLCD_CMD_COLUMN_ADDRESS_SET) {
+        hostSimLcd_startColumn = start;
+        hostSimLcd_endColumn = end;
+      } else {
+        hostSimLcd_startPage = start;
+        hostSimLcd_endPage = end;
+      }
+    }
+    break;
+  case HOSTSIMLCD_CMD_MEMORY_ACCESS_CONTROL:
+    if (index == 0)
+      hostSimLcd_madctl = data;
+    break;
+  case HOSTSIMLCD_CMD_MEMORY_WRITE:
+  case HOSTSIMLCD_CMD_WRITE_MEMORY_CONTINUE:
+    // RGB565: high byte first.
+    if (index & 1)
+      hostSimLcd_writePixel((hostSimLcd_pixelHighByte << 8) | data);
+    else
+      hostSimLcd_pixelHighByte = data;
+    break;
+  default:
+    break;
+  }
+}
+
+// ********************************* Bus decoding **********************************
+
+static void hostSimLcd_configureLatency() {
+  if (hostSimLcd_latencyConfigured)
+    return;
+  hostSimLcd_latencyConfigured = true;
+  const char *readNs = getenv("HOSTSIM_AXI_GPIO_READ_NS");
+  const char *writeNs = getenv("HOSTSIM_AXI_GPIO_WRITE_NS");
+  if (readNs)
+    hostSimLcd_readLatencyNs = strtoul(readNs, NULL, 0);
+  if (writeNs)
+    hostSimLcd_writeLatencyNs = strtoul(writeNs, NULL, 0);
+}
+
+// Each access advances the modeled bus clock; the edge it causes happens when it completes.
+void hostSimLcd_observeAccess(hostSim_device_t device, uint32_t offset, bool isWrite, uint32_t value) {
+  hostSimLcd_configureLatency();
+  if (!isWrite) {
+    hostSimLcd_counts.gpioReads++;
+    hostSimLcd_counts.busTimeNs += hostSimLcd_readLatencyNs;
+    return;
+  }
+  hostSimLcd_counts.gpioWrites++;
+  hostSimLcd_counts.busTimeNs += hostSimLcd_writeLatencyNs;
+  if (offset != HOSTSIMLCD_GPIO_DATA_OFFSET)
+    return;  // Direction changes don't put anything on the bus.
+  if (device == HOSTSIM_TFT_DATA_BUS_GPIO) {
+    hostSimLcd_dataBusValue = value & 0xFF;
+    return;
+  }
+  if (device != HOSTSIM_TFT_CONTROL_GPIO)
+    return;
+  uint32_t previous = hostSimLcd_controlValue;
+  hostSimLcd_controlValue = value;
+  uint64_t now = hostSimLcd_counts.busTimeNs;
+  if ((previous & HOSTSIMLCD_WR_BIT_MASK) && !(value & HOSTSIMLCD_WR_BIT_MASK)) {
+    // Falling edge of WR.
+    if (hostSimLcd_wrHasRisen && now - hostSimLcd_wrRiseNs < HOSTSIMLCD_MIN_WR_HIGH_NS)
+      hostSimLcd_counts.timingViolations++;
+    hostSimLcd_wrFallNs = now;
+  } else if (!(previous & HOSTSIMLCD_WR_BIT_MASK) && (value & HOSTSIMLCD_WR_BIT_MASK)) {
+    // Rising edge of WR: the ILI9341 latches D[7:0] and D/CX here.
+    if (now - hostSimLcd_wrFallNs < HOSTSIMLCD_MIN_WR_LOW_NS ||
+        (hostSimLcd_wrHasRisen && now - hostSimLcd_wrRiseNs < HOSTSIMLCD_MIN_WRITE_CYCLE_NS))
+      hostSimLcd_counts.timingViolations++;
+    hostSimLcd_wrRiseNs = now;
+    hostSimLcd_wrHasRisen = true;
+    if (!(value & HOSTSIMLCD_RD_BIT_MASK))
+      return;  // RD and WR both asserted: not a valid write cycle.
+    hostSimLcd_counts.wrStrobes++;
+    if (value & HOSTSIMLCD_DCX_BIT_MASK) {
+      hostSimLcd_counts.dataBytes++;
+      hostSimLcd_decodeData(hostSimLcd_dataBusValue);
+    } else {
+      hostSimLcd_counts.commandBytes++;
+      hostSimLcd_decodeCommand(hostSimLcd_dataBusValue);
+    }
+  }
+}
+
+void hostSimLcd_setAxiGpioLatency(uint32_t readNs, uint32_t writeNs) {
+  hostSimLcd_latencyConfigured = true;
+  hostSimLcd_readLatencyNs = readNs;
+  hostSimLcd_writeLatencyNs = writeNs;
+}
+
+void hostSimLcd_getCounts(hostSimLcd_counts_t *counts) {
+  *counts = hostSimLcd_counts;
+}
+
+void hostSimLcd_resetCounts() {
+  memset(&hostSimLcd_counts, 0, sizeof(hostSimLcd_counts));
+  hostSimLcd_wrHasRisen = false;
+}
+
+// ***************************** Per-primitive accounting ***************************
+
+typedef struct {
+  const char *name;
+  uint64_t calls;
+  hostSimLcd_counts_t counts;
+} hostSimLcd_primitive_t;
+
+static hostSimLcd_primitive_t hostSimLcd_primitives[HOSTSIMLCD_MAX_PRIMITIVES];
+static uint32_t hostSimLcd_primitiveCount = 0;
+static uint32_t hostSimLcd_primitiveDepth = 0;
+static const char *hostSimLcd_currentPrimitive = NULL;
+static hostSimLcd_counts_t hostSimLcd_primitiveStart;
+static bool hostSimLcd_reportRegistered = false;
+
+static hostSimLcd_primitive_t *hostSimLcd_findPrimitive(const char *name) {
+  for (uint32_t i = 0; i < hostSimLcd_primitiveCount; i++) {
+    if (hostSimLcd_primitives[i].name == name || !strcmp(hostSimLcd_primitives[i].name, name))
+      return &hostSimLcd_primitives[i];
+  }
+  if (hostSimLcd_primitiveCount == HOSTSIMLCD_MAX_PRIMITIVES)
+    return NULL;
+  hostSimLcd_primitive_t *primitive = &hostSimLcd_primitives[hostSimLcd_primitiveCount++];
+  memset(primitive, 0, sizeof(*primitive));
+  primitive->name = name;
+  return primitive;
+}
+
+void hostSimLcd_beginPrimitive(const char *name) {
+  if (hostSimLcd_primitiveDepth++)
+    return;
+  if (!hostSimLcd_reportRegistered) {
+    hostSimLcd_reportRegistered = true;
+    atexit(hostSimLcd_printReport);
+  }
+  hostSimLcd_currentPrimitive = name;
+  hostSimLcd_primitiveStart = hostSimLcd_counts;
+}
+
+void hostSimLcd_endPrimitive() {
+  if (!hostSimLcd_primitiveDepth || --hostSimLcd_primitiveDepth)
+    return;
+  hostSimLcd_primitive_t *primitive = hostSimLcd_findPrimitive(hostSimLcd_currentPrimitive);
+  if (!primitive)
+    return;
+  primitive->calls++;
+  primitive->counts.gpioReads += hostSimLcd_counts.gpioReads - hostSimLcd_primitiveStart.gpioReads;
+  primitive->counts.gpioWrites += hostSimLcd_counts.gpioWrites - hostSimLcd_primitiveStart.gpioWrites;
+  primitive->counts.wrStrobes += hostSimLcd_counts.wrStrobes - hostSimLcd_primitiveStart.wrStrobes;
+  primitive->counts.commandBytes += hostSimLcd_counts.commandBytes - hostSimLcd_primitiveStart.commandBytes;
+  primitive->counts.dataBytes += hostSimLcd_counts.dataBytes - hostSimLcd_primitiveStart.dataBytes;
+  primitive->counts.timingViolations += hostSimLcd_counts.timingViolations - hostSimLcd_primitiveStart.timingViolations;
+  primitive->counts.busTimeNs += hostSimLcd_counts.busTimeNs - hostSimLcd_primitiveStart.busTimeNs;
+}
+
+void hostSimLcd_resetPrimitiveCounts() {
+  hostSimLcd_primitiveCount = 0;
+}
+
+// One line per display_* function that was called, sorted by first use.
+void hostSimLcd_printReport() {
+  if (!hostSimLcd_primitiveCount)
+    return;
+  printf("LCD bus traffic (AXI GPIO read %u ns, write %u ns)\n\r",
+         (unsigned) hostSimLcd_readLatencyNs, (unsigned) hostSimLcd_writeLatencyNs);
+  printf("%-24s %8s %10s %10s %10s %8s %10s %12s %12s\n\r", "primitive", "calls", "reads", "writes",
+         "strobes", "commands", "data", "total us", "us/call");
+  for (uint32_t i = 0; i < hostSimLcd_primitiveCount; i++) {
+    hostSimLcd_primitive_t *p = &hostSimLcd_primitives[i];
+    printf("%-24s %8llu %10llu %10llu %10llu %8llu %10llu %12.1f %12.2f\n\r", p->name,
+           (unsigned long long) p->calls, (unsigned long long) p->counts.gpioReads,
+           (unsigned long long) p->counts.gpioWrites, (unsigned long long) p->counts.wrStrobes,
+           (unsigned long long) p->counts.commandBytes, (unsigned long long) p->counts.dataBytes,
+           p->counts.busTimeNs / 1000.0, p->counts.busTimeNs / 1000.0 / p->calls);
+    if (p->counts.timingViolations)
+      printf("%-24s %llu WR timing violations\n\r", "", (unsigned long long) p->counts.timingViolations);
+  }
+}
+
+// ********************************** GRAM access **********************************
+
+uint16_t hostSimLcd_getPixel(uint16_t column, uint16_t page) {
+  uint16_t c, r;
+  if (!hostSimLcd_mapAddress(column, page, &c, &r))
+    return 0;
+  return hostSimLcd_gram[r][c];
+}
+
+// FNV-1a over the GRAM in storage order.
+uint32_t hostSimLcd_getFrameChecksum() {
+  uint32_t hash = 2166136261U;
+  const uint8_t *bytes = (const uint8_t *) hostSimLcd_gram;
+  for (size_t i = 0; i < sizeof(hostSimLcd_gram); i++)
+    hash = (hash ^ bytes[i]) * 16777619U;
+  return hash;
+}
+
+bool hostSimLcd_writePpm(const char *fileName) {
+  FILE *file = fopen(fileName, "wb");
+  if (!file) {
+    printf("hostSimLcd: can't create %s\n\r", fileName);
+    return false;
+  }
+  bool exchanged = hostSimLcd_madctl & HOSTSIMLCD_MADCTL_MV;
+  uint16_t width = exchanged ? HOSTSIMLCD_PANEL_HEIGHT : HOSTSIMLCD_PANEL_WIDTH;
+  uint16_t height = exchanged ? HOSTSIMLCD_PANEL_WIDTH : HOSTSIMLCD_PANEL_HEIGHT;
+  fprintf(file, "P6\n%u %u\n255\n", (unsigned) width, (unsigned) height);
+  for (uint16_t y = 0; y < height; y++) {
+    for (uint16_t x = 0; x < width; x++) {
+      uint16_t color = hostSimLcd_getPixel(x, y);
+      uint8_t rgb[3] = {(uint8_t)((color >> 8) & 0xF8), (uint8_t)((color >> 3) & 0xFC), (uint8_t)(color << 3)};
+      fwrite(rgb, 1, sizeof(rgb), file);
+    }
+  }
+  fclose(file);
+  return true;
+}
@@ -0,0 +1,69 @@
+/*
+ * hostSimLcd.h
+ *
+ * Model of the 8080-style parallel bus between the TFT GPIO blocks and the ILI9341.
+ * hostSim.c hands every access to the TFT control and data-bus GPIOs to this model, which
+ * decodes WR strobes into command/data bytes, keeps a copy of the panel's GRAM and
+ * accumulates the cost of the traffic at a configurable AXI GPIO latency. The display_*
+ * functions bracket themselves with a primitive scope so that the totals can be reported
+ * per public display call.
+ */
+
+#ifndef HOSTSIMLCD_H_
+#define HOSTSIMLCD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hostSim.h"
+
+#define HOSTSIMLCD_PANEL_WIDTH 240   // Native (unrotated) panel size.
+#define HOSTSIMLCD_PANEL_HEIGHT 320
+
+// Bus traffic counters. Times are estimates: GPIO accesses times the AXI GPIO latency.
+typedef struct {
+  uint64_t gpioReads;
+  uint64_t gpioWrites;
+  uint64_t wrStrobes;
+  uint64_t commandBytes;
+  uint64_t dataBytes;
+  uint64_t timingViolations;  // WR strobes shorter than the ILI9341 minimums.
+  uint64_t busTimeNs;
+} hostSimLcd_counts_t;
+
+// Called by hostSim.c for every access to one of the TFT GPIO blocks.
+void hostSimLcd_observeAccess(hostSim_device_t device, uint32_t offset, bool isWrite, uint32_t value);
+
+// Latency of one AXI GPIO read and one write, as seen by the ARM. The defaults reproduce
+// the 165 ms measured for a black display_fillScreen() on the board. They can also be set
+// with the HOSTSIM_AXI_GPIO_READ_NS and HOSTSIM_AXI_GPIO_WRITE_NS environment variables.
+void hostSimLcd_setAxiGpioLatency(uint32_t readNs, uint32_t writeNs);
+
+// Totals since start-up (or the last reset).
+void hostSimLcd_getCounts(hostSimLcd_counts_t *counts);
+void hostSimLcd_resetCounts();
+
+// Per-primitive accounting. Scopes nest; traffic is charged to the outermost one only.
+void hostSimLcd_beginPrimitive(const char *name);
+void hostSimLcd_endPrimitive();
+void hostSimLcd_resetPrimitiveCounts();
+void hostSimLcd_printReport();
+
+// GRAM contents, addressed the same way the driver addresses them (column, page under the
+// current MADCTL setting), so (x, y) on the screen for any rotation.
+uint16_t hostSimLcd_getPixel(uint16_t column, uint16_t page);
+// Checksum of the whole GRAM; handy for checking that two drawing paths produce the
+// same picture.
+uint32_t hostSimLcd_getFrameChecksum();
+// Writes the screen, as currently oriented, as a binary PPM.
+bool hostSimLcd_writePpm(const char *fileName);
+
+#ifdef __cplusplus
+// Brackets a block of code as one primitive for the report.
+class hostSimLcd_primitiveScope {
+ public:
+  hostSimLcd_primitiveScope(const char *name) { hostSimLcd_beginPrimitive(name); }
+  ~hostSimLcd_primitiveScope() { hostSimLcd_endPrimitive(); }
+};
+#endif
+
+#endif /* HOSTSIMLCD_H_ */
@@ -0,0 +1,578 @@
+/*
+ * hostSimPlayer.c
+ *
+ * See hostSimPlayer.h. The player reacts to the simonControl, flashSequence and verifySequence
+ * transitions as they show up in the trace ring, and keeps the books on every game and level.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "hostSim.h"
+#include "hostSimPlayer.h"
+#include "globals.h"
+#include "scheduler.h"
+#include "simonControl.h"
+#include "simonDisplay.h"
+#include "flashSequence.h"
+#include "verifySequence.h"
+#include "supportFiles/display.h"
+#include "supportFiles/globalTimer.h"
+#include "supportFiles/interrupts.h"
+#include "supportFiles/leds.h"
+#include "supportFiles/prng.h"
+#include "supportFiles/trace.h"
+
+#define HOSTSIM_PLAYER_NANOSECONDS_PER_MS 1000000ULL
+#define HOSTSIM_PLAYER_NANOSECONDS_PER_SECOND 1000000000ULL
+#define HOSTSIM_PLAYER_REACTION_MS 300     // From a prompt to the first touch.
+#define HOSTSIM_PLAYER_HOLD_MS 120         // From touching a region to letting go.
+#define HOSTSIM_PLAYER_GAP_MS 150          // From letting go to the next touch.
+#define HOSTSIM_PLAYER_TOUCH_Z 64
+#define HOSTSIM_PLAYER_MAX_LEVELS 3        // Most levels a game clears.
+#define HOSTSIM_PLAYER_MAX_LENGTH 32       // Longest sequence the player can tap and account for.
+#define HOSTSIM_PLAYER_MAX_ACTIONS (2 * HOSTSIM_PLAYER_MAX_LENGTH)
+#define HOSTSIM_PLAYER_RECORD_BATCH 64     // Most new trace records between two updates.
+#define HOSTSIM_PLAYER_RELEASE -1          // Action that lifts the finger.
+#define HOSTSIM_PLAYER_RUN_SECONDS 1       // The game runs this long between checks on progress.
+#define HOSTSIM_PLAYER_GAME_LIMIT_SECONDS 300  // A game that takes longer than this is stuck.
+#define HOSTSIM_PLAYER_MAX_REPORTED_FAILURES 10
+// A duration may end this much early (the machines take their deadline and record the
+// transition a few accesses apart) and up to one timer period late (entry actions that draw,
+// and tick mode).
+#define HOSTSIM_PLAYER_EARLY_TOLERANCE 1E-3
+#define HOSTSIM_PLAYER_LATE_TOLERANCE GLOBALS_TIMER_PERIOD
+
+// State numbers, in the order of the state enums in src/ (hostSim/traceDecode.c has the names).
+enum {
+  HOSTSIM_PLAYER_CONTROL_TOUCH_TO_START = 1,
+  HOSTSIM_PLAYER_CONTROL_WAIT_FOR_RELEASE,
+  HOSTSIM_PLAYER_CONTROL_PAUSE_BEFORE_FLASH,
+  HOSTSIM_PLAYER_CONTROL_FLASH_SEQUENCE,
+  HOSTSIM_PLAYER_CONTROL_VERIFY_SEQUENCE,
+  HOSTSIM_PLAYER_CONTROL_CONGRATS,
+  HOSTSIM_PLAYER_CONTROL_TOUCH_FOR_NEW_LEVEL,
+  HOSTSIM_PLAYER_CONTROL_DISPLAY_SCORE
+};
+#define HOSTSIM_PLAYER_FLASH_DELAY_TIMER 2
+enum {
+  HOSTSIM_PLAYER_VERIFY_INITIAL,
+  HOSTSIM_PLAYER_VERIFY_WAIT_FOR_PRESS,
+  HOSTSIM_PLAYER_VERIFY_VERIFY,
+  HOSTSIM_PLAYER_VERIFY_FINAL
+};
+
+// How a game ends.
+typedef enum {
+  HOSTSIM_PLAYER_USER_ERROR,  // A wrong region.
+  HOSTSIM_PLAYER_TIMEOUT,     // No more taps.
+  HOSTSIM_PLAYER_QUIT,        // No touch at the new level prompt.
+  HOSTSIM_PLAYER_ENDING_COUNT
+} hostSimPlayer_ending_t;
+
+static const char *hostSimPlayer_endingNames[HOSTSIM_PLAYER_ENDING_COUNT + 1] = {"user error", "timeout", "quit", "?"};
+
+typedef struct {
+  uint8_t levelsToClear;
+  hostSimPlayer_ending_t ending;
+  uint16_t failIteration;  // User error and timeout: the iteration of the last level that goes wrong,
+  uint16_t failTap;        // and the tap in it that is wrong or never made.
+} hostSimPlayer_plan_t;
+
+typedef struct {
+  uint64_t timeNs;
+  int8_t region;  // Or HOSTSIM_PLAYER_RELEASE.
+} hostSimPlayer_action_t;
+
+typedef enum {
+  HOSTSIM_PLAYER_PAUSE,
+  HOSTSIM_PLAYER_FLASH_DELAY,
+  HOSTSIM_PLAYER_VERIFY_TIMEOUT,
+  HOSTSIM_PLAYER_CONGRATS,
+  HOSTSIM_PLAYER_NEW_LEVEL_TIMEOUT,
+  HOSTSIM_PLAYER_DISPLAY_SCORE,
+  HOSTSIM_PLAYER_DURATION_COUNT
+} hostSimPlayer_durationId_t;
+
+typedef struct {
+  const char *name;
+  double expected;  // Seconds.
+  uint32_t count;
+  uint32_t failures;
+  double min;
+  double max;
+} hostSimPlayer_duration_t;
+
+// The game's durations, as defined in simonControl.h, flashSequence.h and verifySequence.h.
+#define HOSTSIM_PLAYER_DURATION(name) {#name, name}
+static hostSimPlayer_duration_t hostSimPlayer_durations[HOSTSIM_PLAYER_DURATION_COUNT] = {
+  HOSTSIM_PLAYER_DURATION(SIMONCONTROL_PAUSE_BEFORE_FLASHING_SEQUENCE_DURATION),
+  HOSTSIM_PLAYER_DURATION(FLASHSEQUENCE_DELAY_DURATION),
+  HOSTSIM_PLAYER_DURATION(VERIFYSEQUENCE_TIMEOUT_DURATION),
+  HOSTSIM_PLAYER_DURATION(SIMONCONTROL_CONGRATS_TIMER_DURATION),
+  HOSTSIM_PLAYER_DURATION(SIMONCONTROL_NEW_LEVEL_TIMOUT_TIMER_DURATION),
+  HOSTSIM_PLAYER_DURATION(SIMONCONTROL_DISPLAY_SCORE_TIMER_DURATION),
+};
+
+typedef struct {
+  uint32_t count;
+  uint64_t lcdAccesses;
+  uint64_t spiAccesses;
+} hostSimPlayer_level_t;
+
+// The run.
+static bool hostSimPlayer_playing = false;
+static uint32_t hostSimPlayer_gameCount;
+static uint32_t hostSimPlayer_gamesStarted;
+static uint32_t hostSimPlayer_gamesPlayed;
+static uint32_t hostSimPlayer_random;
+static uint32_t hostSimPlayer_failures;
+static uint32_t hostSimPlayer_recordsRead;
+static uint16_t hostSimPlayer_regionX[SIMON_DISPLAY_NUMBER_OF_REGIONS];
+static uint16_t hostSimPlayer_regionY[SIMON_DISPLAY_NUMBER_OF_REGIONS];
+static hostSimPlayer_action_t hostSimPlayer_actions[HOSTSIM_PLAYER_MAX_ACTIONS];
+static uint32_t hostSimPlayer_actionHead;
+static uint32_t hostSimPlayer_actionCount;
+static uint32_t hostSimPlayer_startTimestamps[HOSTSIM_PLAYER_DURATION_COUNT];
+
+// The books.
+static uint32_t hostSimPlayer_endingCounts[HOSTSIM_PLAYER_ENDING_COUNT + 1];
+static uint32_t hostSimPlayer_totalLevelsCleared;
+static hostSimPlayer_level_t hostSimPlayer_levels[HOSTSIM_PLAYER_MAX_LENGTH + 1];
+static uint64_t hostSimPlayer_taskRunTimes[SCHEDULER_MAX_TASKS];     // Summed over the games.
+static uint64_t hostSimPlayer_taskMaxRunTimes[SCHEDULER_MAX_TASKS];  // Worst game.
+static uint64_t hostSimPlayer_maxGameRunTime;
+
+// The game being played.
+static hostSimPlayer_plan_t hostSimPlayer_plan;
+static uint8_t hostSimPlayer_levelsCleared;
+static uint64_t hostSimPlayer_gameStartNs;
+static uint64_t hostSimPlayer_taskRunTimesAtGameStart[SCHEDULER_MAX_TASKS];
+static uint16_t hostSimPlayer_levelLength;
+static uint64_t hostSimPlayer_lcdAccessesAtLevelStart;
+static uint64_t hostSimPlayer_spiAccessesAtLevelStart;
+
+// xorshift32: the player has its own numbers, so that it doesn't disturb the game's rand().
+static uint32_t hostSimPlayer_nextRandom() {
+  hostSimPlayer_random ^= hostSimPlayer_random << 13;
+  hostSimPlayer_random ^= hostSimPlayer_random >> 17;
+  hostSimPlayer_random ^= hostSimPlayer_random << 5;
+  return hostSimPlayer_random;
+}
+
+static void hostSimPlayer_fail() {
+  hostSimPlayer_failures++;
+}
+
+static bool hostSimPlayer_reportFailure() {
+  return hostSimPlayer_failures <= HOSTSIM_PLAYER_MAX_REPORTED_FAILURES;
+}
+
+static uint64_t hostSimPlayer_accessCount(hostSim_device_t device) {
+  return hostSim_getReadCount(device) + hostSim_getWriteCount(device);
+}
+
+// The LCD hangs off three GPIO blocks.
+static uint64_t hostSimPlayer_lcdAccessCount() {
+  return hostSimPlayer_accessCount(HOSTSIM_TFT_CONTROL_GPIO) + hostSimPlayer_accessCount(HOSTSIM_TFT_DATA_BUS_GPIO) +
+         hostSimPlayer_accessCount(HOSTSIM_TFT_GPIO);
+}
+
+// Picks a raw touch point in the middle of each region, under the current calibration.
+static bool hostSimPlayer_findRegions() {
+  bool found[SIMON_DISPLAY_NUMBER_OF_REGIONS] = {false};
+  for (uint16_t rawX = 1024; rawX < 4096; rawX += 2048) {
+    for (uint16_t rawY = 1024; rawY < 4096; rawY += 2048) {
+      int8_t region = simonDisplay_computeRegionNumberRaw(rawX, rawY);
+      if (region >= 0 && region < SIMON_DISPLAY_NUMBER_OF_REGIONS) {
+        hostSimPlayer_regionX[region] = rawX;
+        hostSimPlayer_regionY[region] = rawY;
+        found[region] = true;
+      }
+    }
+  }
+  for (int i = 0; i < SIMON_DISPLAY_NUMBER_OF_REGIONS; i++) {
+    if (!found[i])
+      return false;
+  }
+  return true;
+}
+
+// ********************************* Touches ***************************************
+
+// Queues a touch on each region and its release, starting a reaction time from now.
+static void hostSimPlayer_tap(const uint8_t regions[], uint16_t count) {
+  uint64_t touchNs = hostSim_getElapsedNanoseconds() + HOSTSIM_PLAYER_REACTION_MS * HOSTSIM_PLAYER_NANOSECONDS_PER_MS;
+  for (uint16_t i = 0; i < count && hostSimPlayer_actionCount + 2 <= HOSTSIM_PLAYER_MAX_ACTIONS; i++) {
+    hostSimPlayer_action_t *touch =
+      &hostSimPlayer_actions[(hostSimPlayer_actionHead + hostSimPlayer_actionCount++) % HOSTSIM_PLAYER_MAX_ACTIONS];
+    touch->timeNs = touchNs;
+    touch->region = regions[i];
+    touchNs += HOSTSIM_PLAYER_HOLD_MS * HOSTSIM_PLAYER_NANOSECONDS_PER_MS;
+    hostSimPlayer_action_t *release =
+      &hostSimPlayer_actions[(hostSimPlayer_actionHead + hostSimPlayer_actionCount++) % HOSTSIM_PLAYER_MAX_ACTIONS];
+    release->timeNs = touchNs;
+    release->region = HOSTSIM_PLAYER_RELEASE;
+    touchNs += HOSTSIM_PLAYER_GAP_MS * HOSTSIM_PLAYER_NANOSECONDS_PER_MS;
+  }
+}
+
+// Touches anywhere, to answer a prompt.
+static void hostSimPlayer_tapPrompt() {
+  uint8_t region = SIMON_DISPLAY_REGION_0;
+  hostSimPlayer_tap(&region, 1);
+}
+
+// Makes the touches and releases that are due.
+static void hostSimPlayer_act() {
+  uint64_t now = hostSim_getElapsedNanoseconds();
+  while (hostSimPlayer_actionCount && hostSimPlayer_actions[hostSimPlayer_actionHead].timeNs <= now) {
+    hostSimPlayer_action_t *action = &hostSimPlayer_actions[hostSimPlayer_actionHead];
+    hostSimPlayer_actionHead = (hostSimPlayer_actionHead + 1) % HOSTSIM_PLAYER_MAX_ACTIONS;
+    hostSimPlayer_actionCount--;
+    if (action->region == HOSTSIM_PLAYER_RELEASE)
+      hostSim_touchUp();
+    else
+      hostSim_touchDown(hostSimPlayer_regionX[action->region], hostSimPlayer_regionY[action->region],
+                        HOSTSIM_PLAYER_TOUCH_Z);
+  }
+}
+
+// ****************************** Games and levels *********************************
+
+// Checks a duration that ends with the record at endTimestamp against the game's definition.
+static void hostSimPlayer_measure(hostSimPlayer_durationId_t id, uint32_t endTimestamp) {
+  hostSimPlayer_duration_t *duration = &hostSimPlayer_durations[id];
+  double seconds = (int32_t) (endTimestamp - hostSimPlayer_startTimestamps[id]) *
+                   (double) (1 << TRACE_TIMESTAMP_SHIFT) / GLOBAL_TIMER_TICKS_PER_SECOND;
+  if (!duration->count || seconds < duration->min)
+    duration->min = seconds;
+  if (!duration->count || seconds > duration->max)
+    duration->max = seconds;
+  duration->count++;
+  if (seconds < duration->expected - HOSTSIM_PLAYER_EARLY_TOLERANCE ||
+      seconds > duration->expected + HOSTSIM_PLAYER_LATE_TOLERANCE) {
+    duration->failures++;
+    hostSimPlayer_fail();
+    if (hostSimPlayer_reportFailure())
+      fprintf(stderr, "game %lu: %s took %.3f ms\n\r", (unsigned long) hostSimPlayer_gamesStarted, duration->name,
+              seconds * 1E3);
+  }
+}
+
+// Adds the run time of the game that just finished to the books.
+static void hostSimPlayer_endGame() {
+  const char *name;
+  scheduler_runStatistics_t statistics;
+  uint64_t gameRunTime = 0;
+  for (uint8_t i = 0; scheduler_getTaskStatistics(i, &name, &statistics); i++) {
+    uint64_t runTime = statistics.totalRunTime - hostSimPlayer_taskRunTimesAtGameStart[i];
+    hostSimPlayer_taskRunTimes[i] += runTime;
+    if (runTime > hostSimPlayer_taskMaxRunTimes[i])
+      hostSimPlayer_taskMaxRunTimes[i] = runTime;
+    gameRunTime += runTime;
+  }
+  if (gameRunTime > hostSimPlayer_maxGameRunTime)
+    hostSimPlayer_maxGameRunTime = gameRunTime;
+  hostSimPlayer_gamesPlayed++;
+}
+
+// A game runs from one touch-to-start screen to the next. Plans how this one is going to end.
+static void hostSimPlayer_startGame() {
+  if (hostSimPlayer_gamesStarted)
+    hostSimPlayer_endGame();
+  if (hostSimPlayer_gamesStarted == hostSimPlayer_gameCount)
+    return;
+  hostSimPlayer_gamesStarted++;
+  hostSimPlayer_plan.ending = (hostSimPlayer_ending_t) (hostSimPlayer_nextRandom() % HOSTSIM_PLAYER_ENDING_COUNT);
+  hostSimPlayer_plan.levelsToClear = hostSimPlayer_nextRandom() % (HOSTSIM_PLAYER_MAX_LEVELS + 1);
+  if (hostSimPlayer_plan.ending == HOSTSIM_PLAYER_QUIT && !hostSimPlayer_plan.levelsToClear)
+    hostSimPlayer_plan.levelsToClear = 1;  // The only chance to quit is at the new level prompt.
+  hostSimPlayer_levelsCleared = 0;
+  hostSimPlayer_gameStartNs = hostSim_getElapsedNanoseconds();
+  const char *name;
+  scheduler_runStatistics_t statistics;
+  for (uint8_t i = 0; scheduler_getTaskStatistics(i, &name, &statistics); i++)
+    hostSimPlayer_taskRunTimesAtGameStart[i] = statistics.totalRunTime;
+  hostSimPlayer_tapPrompt();
+}
+
+// On the last level of a game that ends in an error, picks where it goes wrong.
+static void hostSimPlayer_startLevel() {
+  hostSimPlayer_levelLength = globals_getSequenceLength();
+  hostSimPlayer_lcdAccessesAtLevelStart = hostSimPlayer_lcdAccessCount();
+  hostSimPlayer_spiAccessesAtLevelStart = hostSimPlayer_accessCount(HOSTSIM_SPI);
+  if (hostSimPlayer_levelsCleared == hostSimPlayer_plan.levelsToClear && hostSimPlayer_plan.ending != HOSTSIM_PLAYER_QUIT) {
+    hostSimPlayer_plan.failIteration = 1 + hostSimPlayer_nextRandom() % hostSimPlayer_levelLength;
+    hostSimPlayer_plan.failTap = hostSimPlayer_nextRandom() % hostSimPlayer_plan.failIteration;
+  }
+}
+
+// A level's traffic runs from the touch that starts it to the congratulations or the score, drawn.
+static void hostSimPlayer_endLevel() {
+  uint16_t length = hostSimPlayer_levelLength < HOSTSIM_PLAYER_MAX_LENGTH ? hostSimPlayer_levelLength : HOSTSIM_PLAYER_MAX_LENGTH;
+  hostSimPlayer_level_t *level = &hostSimPlayer_levels[length];
+  level->count++;
+  level->lcdAccesses += hostSimPlayer_lcdAccessCount() - hostSimPlayer_lcdAccessesAtLevelStart;
+  level->spiAccesses += hostSimPlayer_accessCount(HOSTSIM_SPI) - hostSimPlayer_spiAccessesAtLevelStart;
+}
+
+// Taps this iteration's sequence, or as much of it as the plan says.
+static void hostSimPlayer_startIteration() {
+  uint8_t regions[HOSTSIM_PLAYER_MAX_LENGTH];
+  uint16_t length = globals_getSequenceIterationLength();
+  length = length < HOSTSIM_PLAYER_MAX_LENGTH ? length : HOSTSIM_PLAYER_MAX_LENGTH;
+  uint16_t tapCount = length;
+  for (uint16_t i = 0; i < length; i++)
+    regions[i] = globals_getSequenceValue(i);
+  if (hostSimPlayer_levelsCleared == hostSimPlayer_plan.levelsToClear && hostSimPlayer_plan.ending != HOSTSIM_PLAYER_QUIT &&
+      length == hostSimPlayer_plan.failIteration) {
+    tapCount = hostSimPlayer_plan.failTap;
+    if (hostSimPlayer_plan.ending == HOSTSIM_PLAYER_USER_ERROR) {
+      regions[tapCount] = (regions[tapCount] + 1) % SIMON_DISPLAY_NUMBER_OF_REGIONS;
+      tapCount++;
+    }
+  }
+  hostSimPlayer_tap(regions, tapCount);
+}
+
+// The game is over: did it end the way it was planned?
+static void hostSimPlayer_checkEnding(uint8_t oldState) {
+  hostSimPlayer_ending_t ending = HOSTSIM_PLAYER_ENDING_COUNT;
+  if (oldState == HOSTSIM_PLAYER_CONTROL_TOUCH_FOR_NEW_LEVEL)
+    ending = HOSTSIM_PLAYER_QUIT;
+  else if (verifySequence_isUserInputError())
+    ending = HOSTSIM_PLAYER_USER_ERROR;
+  else if (verifySequence_isTimeOutError())
+    ending = HOSTSIM_PLAYER_TIMEOUT;
+  hostSimPlayer_endingCounts[ending]++;
+  if (ending != hostSimPlayer_plan.ending || hostSimPlayer_levelsCleared != hostSimPlayer_plan.levelsToClear) {
+    hostSimPlayer_fail();
+    if (hostSimPlayer_reportFailure())
+      fprintf(stderr, "game %lu: planned a %s after %u levels, got a %s after %u\n\r",
+              (unsigned long) hostSimPlayer_gamesStarted, hostSimPlayer_endingNames[hostSimPlayer_plan.ending],
+              hostSimPlayer_plan.levelsToClear, hostSimPlayer_endingNames[ending], hostSimPlayer_levelsCleared);
+  }
+}
+
+// ********************************* Watching **************************************
+
+static void hostSimPlayer_watchSimonControl(const trace_record_t *record) {
+  switch (record->newState) {
+  case HOSTSIM_PLAYER_CONTROL_TOUCH_TO_START:
+    if (record->oldState == HOSTSIM_PLAYER_CONTROL_DISPLAY_SCORE)
+      hostSimPlayer_measure(HOSTSIM_PLAYER_DISPLAY_SCORE, record->timestamp);
+    hostSimPlayer_startGame();
+    break;
+  case HOSTSIM_PLAYER_CONTROL_WAIT_FOR_RELEASE:
+    if (record->oldState != HOSTSIM_PLAYER_CONTROL_VERIFY_SEQUENCE)  // Not just the next iteration.
+      hostSimPlayer_startLevel();
+    break;
+  case HOSTSIM_PLAYER_CONTROL_PAUSE_BEFORE_FLASH:
+    hostSimPlayer_startTimestamps[HOSTSIM_PLAYER_PAUSE] = record->timestamp;
+    break;
+  case HOSTSIM_PLAYER_CONTROL_FLASH_SEQUENCE:
+    hostSimPlayer_measure(HOSTSIM_PLAYER_PAUSE, record->timestamp);
+    break;
+  case HOSTSIM_PLAYER_CONTROL_CONGRATS:
+    hostSimPlayer_startTimestamps[HOSTSIM_PLAYER_CONGRATS] = record->timestamp;
+    hostSimPlayer_endLevel();
+    hostSimPlayer_levelsCleared++;
+    hostSimPlayer_totalLevelsCleared++;
+    break;
+  case HOSTSIM_PLAYER_CONTROL_TOUCH_FOR_NEW_LEVEL:
+    hostSimPlayer_measure(HOSTSIM_PLAYER_CONGRATS, record->timestamp);
+    hostSimPlayer_startTimestamps[HOSTSIM_PLAYER_NEW_LEVEL_TIMEOUT] = record->timestamp;
+    if (hostSimPlayer_plan.ending != HOSTSIM_PLAYER_QUIT || hostSimPlayer_levelsCleared < hostSimPlayer_plan.levelsToClear)
+      hostSimPlayer_tapPrompt();
+    break;
+  case HOSTSIM_PLAYER_CONTROL_DISPLAY_SCORE:
+    hostSimPlayer_startTimestamps[HOSTSIM_PLAYER_DISPLAY_SCORE] = record->timestamp;
+    if (record->oldState == HOSTSIM_PLAYER_CONTROL_TOUCH_FOR_NEW_LEVEL)
+      hostSimPlayer_measure(HOSTSIM_PLAYER_NEW_LEVEL_TIMEOUT, record->timestamp);
+    else
+      hostSimPlayer_endLevel();
+    hostSimPlayer_checkEnding(record->oldState);
+    break;
+  }
+}
+
+static void hostSimPlayer_watchFlashSequence(const trace_record_t *record) {
+  if (record->newState == HOSTSIM_PLAYER_FLASH_DELAY_TIMER)
+    hostSimPlayer_startTimestamps[HOSTSIM_PLAYER_FLASH_DELAY] = record->timestamp;
+  else if (record->oldState == HOSTSIM_PLAYER_FLASH_DELAY_TIMER)
+    hostSimPlayer_measure(HOSTSIM_PLAYER_FLASH_DELAY, record->timestamp);
+}
+
+// A timeout is the only way from waiting for a press straight to the end.
+static void hostSimPlayer_watchVerifySequence(const trace_record_t *record) {
+  if (record->oldState == HOSTSIM_PLAYER_VERIFY_INITIAL && record->newState == HOSTSIM_PLAYER_VERIFY_WAIT_FOR_PRESS) {
+    hostSimPlayer_startTimestamps[HOSTSIM_PLAYER_VERIFY_TIMEOUT] = record->timestamp;
+    hostSimPlayer_startIteration();
+  } else if (record->oldState == HOSTSIM_PLAYER_VERIFY_WAIT_FOR_PRESS && record->newState == HOSTSIM_PLAYER_VERIFY_FINAL) {
+    hostSimPlayer_measure(HOSTSIM_PLAYER_VERIFY_TIMEOUT, record->timestamp);
+  }
+}
+
+// Reads the records written since the last look.
+static void hostSimPlayer_watch() {
+  trace_record_t records[HOSTSIM_PLAYER_RECORD_BATCH];
+  uint32_t writeCount = trace_getWriteCount();
+  uint32_t newCount = writeCount - hostSimPlayer_recordsRead;
+  if (!newCount)
+    return;
+  if (newCount > HOSTSIM_PLAYER_RECORD_BATCH) {
+    hostSimPlayer_fail();
+    if (hostSimPlayer_reportFailure())
+      fprintf(stderr, "game %lu: lost %lu trace records\n\r", (unsigned long) hostSimPlayer_gamesStarted,
+              (unsigned long) (newCount - HOSTSIM_PLAYER_RECORD_BATCH));
+  }
+  uint32_t count = trace_getRecords(records, newCount < HOSTSIM_PLAYER_RECORD_BATCH ? newCount : HOSTSIM_PLAYER_RECORD_BATCH);
+  hostSimPlayer_recordsRead = writeCount;
+  for (uint32_t i = 0; i < count; i++) {
+    if (records[i].event != TRACE_EVENT_TRANSITION)
+      continue;
+    switch (records[i].source) {
+    case TRACE_SOURCE_SIMON_CONTROL:
+      hostSimPlayer_watchSimonControl(&records[i]);
+      break;
+    case TRACE_SOURCE_FLASH_SEQUENCE:
+      hostSimPlayer_watchFlashSequence(&records[i]);
+      break;
+    case TRACE_SOURCE_VERIFY_SEQUENCE:
+      hostSimPlayer_watchVerifySequence(&records[i]);
+      break;
+    }
+  }
+}
+
+void hostSimPlayer_update() {
+  if (!hostSimPlayer_playing)
+    return;
+  hostSimPlayer_watch();
+  hostSimPlayer_act();
+}
+
+// ********************************** The run **************************************
+
+static void hostSimPlayer_reset(uint32_t gameCount, uint32_t seed) {
+  hostSimPlayer_gameCount = gameCount;
+  hostSimPlayer_gamesStarted = hostSimPlayer_gamesPlayed = 0;
+  hostSimPlayer_random = seed ? seed : 1;  // xorshift never leaves 0.
+  hostSimPlayer_failures = 0;
+  hostSimPlayer_actionHead = hostSimPlayer_actionCount = 0;
+  hostSimPlayer_totalLevelsCleared = 0;
+  hostSimPlayer_maxGameRunTime = 0;
+  memset(hostSimPlayer_endingCounts, 0, sizeof(hostSimPlayer_endingCounts));
+  memset(hostSimPlayer_levels, 0, sizeof(hostSimPlayer_levels));
+  memset(hostSimPlayer_taskRunTimes, 0, sizeof(hostSimPlayer_taskRunTimes));
+  memset(hostSimPlayer_taskMaxRunTimes, 0, sizeof(hostSimPlayer_taskMaxRunTimes));
+  for (int i = 0; i < HOSTSIM_PLAYER_DURATION_COUNT; i++)
+    hostSimPlayer_durations[i].count = hostSimPlayer_durations[i].failures = 0;
+  trace_clear();
+  hostSimPlayer_recordsRead = 0;
+}
+
+static double hostSimPlayer_ticksToMs(uint64_t ticks) {
+  return ticks * 1E3 / GLOBAL_TIMER_TICKS_PER_SECOND;
+}
+
+static void hostSimPlayer_printReport(double virtualSeconds, double hostSeconds) {
+  uint32_t games = hostSimPlayer_gamesPlayed ? hostSimPlayer_gamesPlayed : 1;
+  printf("%lu games in %.1f s of virtual time, %.2f s on the host (%.0fx real time)\n\r",
+         (unsigned long) hostSimPlayer_gamesPlayed, virtualSeconds, hostSeconds,
+         hostSeconds > 0 ? virtualSeconds / hostSeconds : 0);
+  printf("endings: %lu user errors, %lu timeouts, %lu quits; %lu levels cleared\n\r",
+         (unsigned long) hostSimPlayer_endingCounts[HOSTSIM_PLAYER_USER_ERROR],
+         (unsigned long) hostSimPlayer_endingCounts[HOSTSIM_PLAYER_TIMEOUT],
+         (unsigned long) hostSimPlayer_endingCounts[HOSTSIM_PLAYER_QUIT], (unsigned long) hostSimPlayer_totalLevelsCleared);
+
+  printf("\n\rstate machine run time per game, in virtual time (bus accesses at 100 ns)\n\r");
+  printf("%-16s %12s %12s\n\r", "task", "average ms", "max ms");
+  const char *name;
+  scheduler_runStatistics_t statistics;
+  uint64_t totalRunTime = 0;
+  for (uint8_t i = 0; scheduler_getTaskStatistics(i, &name, &statistics); i++) {
+    printf("%-16s %12.3f %12.3f\n\r", name, hostSimPlayer_ticksToMs(hostSimPlayer_taskRunTimes[i]) / games,
+           hostSimPlayer_ticksToMs(hostSimPlayer_taskMaxRunTimes[i]));
+    totalRunTime += hostSimPlayer_taskRunTimes[i];
+  }
+  printf("%-16s %12.3f %12.3f\n\r", "all", hostSimPlayer_ticksToMs(totalRunTime) / games,
+         hostSimPlayer_ticksToMs(hostSimPlayer_maxGameRunTime));
+
+  printf("\n\rdisplay bus traffic per level, from the touch that starts it to the congratulations or the score\n\r");
+  printf("%8s %8s %14s %14s\n\r", "length", "levels", "lcd accesses", "spi accesses");
+  for (int length = 0; length <= HOSTSIM_PLAYER_MAX_LENGTH; length++) {
+    hostSimPlayer_level_t *level = &hostSimPlayer_levels[length];
+    if (level->count)
+      printf("%8d %8lu %14llu %14llu\n\r", length, (unsigned long) level->count,
+             (unsigned long long) (level->lcdAccesses / level->count), (unsigned long long) (level->spiAccesses / level->count));
+  }
+
+  printf("\n\rdurations, measured from the trace\n\r");
+  printf("%-52s %10s %8s %10s %10s\n\r", "duration", "expected", "count", "min ms", "max ms");
+  for (int i = 0; i < HOSTSIM_PLAYER_DURATION_COUNT; i++) {
+    hostSimPlayer_duration_t *duration = &hostSimPlayer_durations[i];
+    printf("%-52s %10.1f %8lu %10.3f %10.3f%s\n\r", duration->name, duration->expected * 1E3,
+           (unsigned long) duration->count, duration->count ? duration->min * 1E3 : 0,
+           duration->count ? duration->max * 1E3 : 0, duration->failures ? "  FAILED" : "");
+  }
+  printf("\n\r%s: %lu failures\n\r", hostSimPlayer_failures ? "FAILED" : "passed", (unsigned long) hostSimPlayer_failures);
+}
+
+bool hostSimPlayer_runGames(uint32_t gameCount, uint32_t seed) {
+  hostSim_useVirtualTime();
+  leds_init(true);
+  interrupts_initAll(true);
+  interrupts_enableTimerGlobalInts();
+  display_init();
+  display_fillScreen(DISPLAY_BLACK);
+  display_setQueuedMode(true);  // As in simonMain, so the timings are the game's own.
+  interrupts_enableSpiGlobalInts();
+  if (interrupts_enableTouchGlobalInts() != 0) {
+    printf("the player needs the touch interrupt\n\r");
+    return false;
+  }
+  if (!hostSimPlayer_findRegions()) {
+    printf("can't find a touch point in every region\n\r");
+    return false;
+  }
+  scheduler_init();
+  simonControl_addTasks();
+  prng_seed(seed);  // The game's sequences follow from the seed too.
+  hostSimPlayer_reset(gameCount, seed);
+
+  // The game prints a few lines per iteration: thousands of games' worth are of no use here.
+  fflush(stdout);
+  int console = dup(STDOUT_FILENO);
+  int discard = open("/dev/null", O_WRONLY);
+  dup2(discard, STDOUT_FILENO);
+  close(discard);
+
+  clock_t hostStart = clock();
+  uint64_t virtualStart = hostSim_getElapsedNanoseconds();
+  hostSimPlayer_gameStartNs = virtualStart;
+  hostSimPlayer_playing = true;
+  interrupts_enableArmInts();
+  while (hostSimPlayer_gamesPlayed < gameCount) {
+    scheduler_runTickless(scheduler_getDeadline(HOSTSIM_PLAYER_RUN_SECONDS));
+    if (hostSim_getElapsedNanoseconds() - hostSimPlayer_gameStartNs >
+        HOSTSIM_PLAYER_GAME_LIMIT_SECONDS * HOSTSIM_PLAYER_NANOSECONDS_PER_SECOND) {
+      hostSimPlayer_fail();
+      fprintf(stderr, "game %lu: stuck\n\r", (unsigned long) hostSimPlayer_gamesStarted);
+      break;
+    }
+  }
+  interrupts_disableArmInts();
+  hostSimPlayer_playing = false;
+  double virtualSeconds = (double) (hostSim_getElapsedNanoseconds() - virtualStart) / HOSTSIM_PLAYER_NANOSECONDS_PER_SECOND;
+  double hostSeconds = (double) (clock() - hostStart) / CLOCKS_PER_SEC;
+
+  fflush(stdout);
+  dup2(console, STDOUT_FILENO);
+  close(console);
+  hostSimPlayer_printReport(virtualSeconds, hostSeconds);
+  return hostSimPlayer_failures == 0;
+}
@@ -0,0 +1,26 @@
+/*
+ * hostSimPlayer.h
+ *
+ * A virtual Simon player. It follows the game through the trace ring (supportFiles/trace.h),
+ * the way a person follows the screen, and taps the touch panel model: the expected sequence,
+ * a wrong region, or nothing at all, as planned for each game. With the model in virtual time
+ * it plays complete games much faster than real time, and always the same games for a seed.
+ */
+
+#ifndef HOSTSIMPLAYER_H_
+#define HOSTSIMPLAYER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Brings the player up to date with the game and makes the touches that are due. The model
+// calls this whenever it updates its devices; it does nothing unless games are being played.
+void hostSimPlayer_update();
+
+// Brings up the hardware and the game like simonMain.c, switches the model to virtual time and
+// plays gameCount games. Prints the state machine run time per game, the display bus traffic
+// per level and the game's timer durations as measured from the trace. Returns false if a game
+// didn't end the way the player planned or a duration was off.
+bool hostSimPlayer_runGames(uint32_t gameCount, uint32_t seed);
+
+#endif /* HOSTSIMPLAYER_H_ */
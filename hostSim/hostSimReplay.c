@@ -0,0 +1,110 @@
+/*
+ * hostSimReplay.c
+ *
+ * See hostSimReplay.h. Both ends of the file are the host's, which is little endian like the
+ * board, so headers and records go in and out as they are in memory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hostSim.h"
+#include "hostSimReplay.h"
+#include "xparameters.h"
+
+#define HOSTSIM_REPLAY_MAX_RECORDS 65536  // 512 KB, hours of play.
+#define HOSTSIM_REPLAY_NANOSECONDS_PER_SECOND 1000000000ULL
+
+static display_touchRecordingHeader_t hostSimReplay_recordingHeader;
+static display_touchRecord_t hostSimReplay_recordedRecords[HOSTSIM_REPLAY_MAX_RECORDS];
+static const char *hostSimReplay_recordingFileName = NULL;
+
+static display_touchRecord_t hostSimReplay_records[HOSTSIM_REPLAY_MAX_RECORDS];
+static uint32_t hostSimReplay_recordCount = 0;
+static uint32_t hostSimReplay_nextRecord = 0;
+static uint32_t hostSimReplay_timerTicksPerSecond;
+static uint64_t hostSimReplay_startNs;
+
+static void hostSimReplay_saveAtExit() {
+  display_stopTouchRecording();
+  hostSimReplay_saveRecording(hostSimReplay_recordingFileName, &hostSimReplay_recordingHeader,
+                              hostSimReplay_recordedRecords);
+}
+
+bool hostSimReplay_startRecording(const char *fileName) {
+  if (!hostSimReplay_recordingFileName)
+    atexit(hostSimReplay_saveAtExit);
+  hostSimReplay_recordingFileName = fileName;
+  display_startTouchRecording(&hostSimReplay_recordingHeader, hostSimReplay_recordedRecords,
+                              HOSTSIM_REPLAY_MAX_RECORDS);
+  return true;
+}
+
+bool hostSimReplay_saveRecording(const char *fileName, const display_touchRecordingHeader_t *header,
+                                 const display_touchRecord_t *records) {
+  FILE *file = fopen(fileName, "wb");
+  if (!file) {
+    printf("hostSim: can't create touch recording %s\n\r", fileName);
+    return false;
+  }
+  bool written = fwrite(header, sizeof(*header), 1, file) == 1 &&
+                 fwrite(records, sizeof(*records), header->count, file) == header->count;
+  if (fclose(file) || !written) {
+    printf("hostSim: can't write touch recording %s\n\r", fileName);
+    return false;
+  }
+  if (header->droppedCount)
+    printf("hostSim: %lu touch events didn't fit in %s\n\r", (unsigned long) header->droppedCount, fileName);
+  return true;
+}
+
+bool hostSimReplay_start(const char *fileName) {
+  FILE *file = fopen(fileName, "rb");
+  if (!file) {
+    printf("hostSim: can't open touch recording %s\n\r", fileName);
+    return false;
+  }
+  display_touchRecordingHeader_t header;
+  bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == DISPLAY_TOUCH_RECORDING_MAGIC &&
+               header.timerTicksPerSecond && header.count <= HOSTSIM_REPLAY_MAX_RECORDS &&
+               fread(hostSimReplay_records, sizeof(hostSimReplay_records[0]), header.count, file) == header.count;
+  fclose(file);
+  if (!valid) {
+    printf("hostSim: %s is not a touch recording\n\r", fileName);
+    return false;
+  }
+  hostSimReplay_recordCount = header.count;
+  hostSimReplay_nextRecord = 0;
+  hostSimReplay_timerTicksPerSecond = header.timerTicksPerSecond;
+  hostSimReplay_startNs = hostSim_getElapsedNanoseconds();
+  display_startTouchReplay();
+  return true;
+}
+
+uint64_t hostSimReplay_getNextEventNanoseconds() {
+  if (hostSimReplay_nextRecord == hostSimReplay_recordCount)
+    return UINT64_MAX;
+  uint64_t ticks = (uint64_t) display_getTouchRecordTime(&hostSimReplay_records[hostSimReplay_nextRecord])
+                   << DISPLAY_TOUCH_RECORD_TIME_SHIFT;
+  // Whole seconds first so that the product can't overflow. The rest is rounded up, so that a
+  // replay that is recorded again gets the same times.
+  uint64_t rate = hostSimReplay_timerTicksPerSecond;
+  return hostSimReplay_startNs + ticks / rate * HOSTSIM_REPLAY_NANOSECONDS_PER_SECOND +
+         (ticks % rate * HOSTSIM_REPLAY_NANOSECONDS_PER_SECOND + rate - 1) / rate;
+}
+
+// Runs inside an access, where no interrupt is delivered, so the display's queue is safe. Queuing
+// an event reads the global timer, which comes back here: that must not queue the next one first.
+void hostSimReplay_update() {
+  static bool updating = false;
+  if (updating)
+    return;
+  updating = true;
+  bool queued = false;
+  while (hostSimReplay_getNextEventNanoseconds() <= hostSim_getElapsedNanoseconds()) {
+    display_replayTouchRecord(&hostSimReplay_records[hostSimReplay_nextRecord++]);
+    queued = true;
+  }
+  if (queued)
+    hostSim_raiseInterrupt(XPAR_FABRIC_TOUCH_INT_INTR);
+  updating = false;
+}
@@ -0,0 +1,37 @@
+/*
+ * hostSimReplay.h
+ *
+ * Touch recordings (display_startTouchRecording() in supportFiles/display.h) in files, and their
+ * replay into the game. A session recorded on the board or on the host replays with the same
+ * touches at the same times, so it can be run again and again, in virtual time if need be, to
+ * check the game's responses and time them.
+ *
+ * The environment variables do it all for build/simon and build/simonTest:
+ *   HOSTSIM_TOUCH_RECORD=<file>  records from the first access on and saves the file at exit,
+ *   HOSTSIM_TOUCH_REPLAY=<file>  replays the file from the first access on.
+ * Both can be set at once, to record a replay.
+ */
+
+#ifndef HOSTSIMREPLAY_H_
+#define HOSTSIMREPLAY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "supportFiles/display.h"
+
+// Starts recording into memory; the file is written when the program exits.
+bool hostSimReplay_startRecording(const char *fileName);
+// Writes a recording file: the header and its header->count records.
+bool hostSimReplay_saveRecording(const char *fileName, const display_touchRecordingHeader_t *header,
+                                 const display_touchRecord_t *records);
+
+// Loads a recording file and replays it from now on: the display stops reading the touch
+// controller, and each record is queued once its time has come, then the touch interrupt is raised.
+bool hostSimReplay_start(const char *fileName);
+// Queues the records that are due. The model calls this whenever it updates its devices.
+void hostSimReplay_update();
+// When the next record is due, in model nanoseconds, or UINT64_MAX if none is left. A sleeping
+// core in virtual time doesn't skip past it.
+uint64_t hostSimReplay_getNextEventNanoseconds();
+
+#endif /* HOSTSIMREPLAY_H_ */
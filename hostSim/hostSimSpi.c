@@ -0,0 +1,435 @@
+/*
+ * hostSimSpi.c
+ *
+ * Model of the AXI SPI controller and of the STMPE610 touch controller that hangs off of
+ * slave select 1. Bytes shift instantly once the controller is enabled as a master and the
+ * inhibit bit is cleared, so the register traffic seen by spi.c is the same as on the board.
+ * The STMPE610 INT pin drives XPAR_FABRIC_TOUCH_INT_INTR and the core's own interrupt (only
+ * DTR empty is modeled) drives XPAR_FABRIC_SPI_0_IP2INTC_IRPT_INTR.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "hostSim.h"
+#include "xparameters.h"
+
+// AXI SPI register offsets and bits (axi_spi_ds742.pdf, same values as spi.h).
+#define HOSTSIM_SPI_DGIER_OFFSET 0x1C
+#define HOSTSIM_SPI_IPISR_OFFSET 0x20
+#define HOSTSIM_SPI_IPIER_OFFSET 0x28
+#define HOSTSIM_SPI_SRR_OFFSET 0x40
+#define HOSTSIM_SPI_CR_OFFSET 0x60
+#define HOSTSIM_SPI_SR_OFFSET 0x64
+#define HOSTSIM_SPI_DTR_OFFSET 0x68
+#define HOSTSIM_SPI_DRR_OFFSET 0x6C
+#define HOSTSIM_SPI_SSR_OFFSET 0x70
+#define HOSTSIM_SPI_TX_OCCUPANCY_OFFSET 0x74
+#define HOSTSIM_SPI_RX_OCCUPANCY_OFFSET 0x78
+#define HOSTSIM_SPI_SRR_RESET_VALUE 0x0000000A
+#define HOSTSIM_SPI_CR_RESET_VALUE 0x00000180
+#define HOSTSIM_SPI_CR_LOOP_MASK 0x001
+#define HOSTSIM_SPI_CR_SPE_MASK 0x002
+#define HOSTSIM_SPI_CR_MASTER_MASK 0x004
+#define HOSTSIM_SPI_CR_TX_FIFO_RESET_MASK 0x020
+#define HOSTSIM_SPI_CR_RX_FIFO_RESET_MASK 0x040
+#define HOSTSIM_SPI_CR_INHIBIT_MASK 0x100
+#define HOSTSIM_SPI_SR_RX_EMPTY_MASK 0x01
+#define HOSTSIM_SPI_SR_RX_FULL_MASK 0x02
+#define HOSTSIM_SPI_SR_TX_EMPTY_MASK 0x04
+#define HOSTSIM_SPI_SR_TX_FULL_MASK 0x08
+#define HOSTSIM_SPI_DGIER_GIE_MASK 0x80000000
+#define HOSTSIM_SPI_INTERRUPT_DTR_EMPTY_MASK 0x04
+#define HOSTSIM_SPI_FIFO_DEPTH 16
+#define HOSTSIM_SPI_TOUCH_SLAVE_SELECT_MASK 0x2
+#define HOSTSIM_SPI_NO_SLAVE_DATA 0xFF         // MISO is pulled up when nothing is selected.
+
+// STMPE610 registers that the model gives behavior to.
+#define HOSTSIM_STMPE_CHIP_ID_MSB 0x00
+#define HOSTSIM_STMPE_CHIP_ID_LSB 0x01
+#define HOSTSIM_STMPE_ID_VER 0x02
+#define HOSTSIM_STMPE_SYS_CTRL1 0x03
+#define HOSTSIM_STMPE_SYS_CTRL1_RESET 0x02
+#define HOSTSIM_STMPE_INT_CTRL 0x09
+#define HOSTSIM_STMPE_INT_CTRL_ENABLE 0x01
+#define HOSTSIM_STMPE_INT_EN 0x0A
+#define HOSTSIM_STMPE_INT_STA 0x0B
+#define HOSTSIM_STMPE_INT_STA_TOUCH_DET 0x01
+#define HOSTSIM_STMPE_INT_STA_FIFO_TH 0x02
+#define HOSTSIM_STMPE_INT_STA_FIFO_OFLOW 0x04
+#define HOSTSIM_STMPE_TSC_CTRL 0x40
+#define HOSTSIM_STMPE_TSC_CTRL_EN 0x01
+#define HOSTSIM_STMPE_TSC_CTRL_TOUCH_DET 0x80
+#define HOSTSIM_STMPE_TSC_CFG 0x41
+#define HOSTSIM_STMPE_FIFO_TH 0x4A
+#define HOSTSIM_STMPE_FIFO_STA 0x4B
+#define HOSTSIM_STMPE_FIFO_STA_RESET 0x01
+#define HOSTSIM_STMPE_FIFO_STA_THTRIG 0x10
+#define HOSTSIM_STMPE_FIFO_STA_EMPTY 0x20
+#define HOSTSIM_STMPE_FIFO_STA_FULL 0x40
+#define HOSTSIM_STMPE_FIFO_STA_OFLOW 0x80
+#define HOSTSIM_STMPE_FIFO_SIZE 0x4C
+#define HOSTSIM_STMPE_TSC_DATA_NON_INC 0x57    // Read as 0xD7: the read bit plus this address.
+#define HOSTSIM_STMPE_READ_MASK 0x80
+#define HOSTSIM_STMPE_REGISTER_COUNT 128
+#define HOSTSIM_STMPE_FIFO_DEPTH 128
+#define HOSTSIM_STMPE_BYTES_PER_SAMPLE 4
+
+// ******************************** STMPE610 model ********************************
+
+typedef struct {
+  uint16_t x;
+  uint16_t y;
+  uint8_t z;
+} hostSimSpi_touchSample_t;
+
+static uint8_t hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_REGISTER_COUNT];
+static bool hostSimSpi_stmpeInitialized = false;
+static hostSimSpi_touchSample_t hostSimSpi_fifo[HOSTSIM_STMPE_FIFO_DEPTH];
+static uint32_t hostSimSpi_fifoHead = 0;       // Oldest sample.
+static uint32_t hostSimSpi_fifoCount = 0;
+static uint32_t hostSimSpi_fifoByteIndex = 0;  // Next byte of the oldest sample to be read.
+
+static bool hostSimSpi_touched = false;
+static hostSimSpi_touchSample_t hostSimSpi_touchPoint;
+static uint64_t hostSimSpi_lastSampleNs = 0;
+
+// Transaction state (reset whenever slave select is released).
+static uint32_t hostSimSpi_transactionByteCount = 0;
+static uint8_t hostSimSpi_transactionAddress = 0;
+static bool hostSimSpi_transactionIsRead = false;
+
+// Power-on/soft-reset register values.
+static void hostSimSpi_stmpeReset() {
+  memset(hostSimSpi_stmpeRegisters, 0, sizeof(hostSimSpi_stmpeRegisters));
+  hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_CHIP_ID_MSB] = 0x08;
+  hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_CHIP_ID_LSB] = 0x11;
+  hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_ID_VER] = 0x03;
+  hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_SYS_CTRL1 + 1] = 0x0F;  // SYS_CTRL2: clocks off.
+  hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_TSC_CTRL] = 0x90;
+  hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_FIFO_STA] = HOSTSIM_STMPE_FIFO_STA_EMPTY;
+  hostSimSpi_fifoHead = hostSimSpi_fifoCount = hostSimSpi_fifoByteIndex = 0;
+  hostSimSpi_stmpeInitialized = true;
+}
+
+// Time between FIFO samples while touched: touch-detect delay plus settling time from TSC_CFG.
+static uint64_t hostSimSpi_samplePeriodNs() {
+  static const uint64_t delayNs[8] = {10000, 50000, 100000, 500000, 1000000, 5000000, 10000000, 50000000};
+  static const uint64_t settleNs[8] = {10000, 100000, 500000, 1000000, 5000000, 10000000, 50000000, 100000000};
+  uint8_t config = hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_TSC_CFG];
+  return delayNs[(config >> 3) & 0x7] + settleNs[config & 0x7];
+}
+
+static bool hostSimSpi_fifoIsHeldInReset() {
+  return hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_FIFO_STA] & HOSTSIM_STMPE_FIFO_STA_RESET;
+}
+
+// Adds the samples that the controller would have taken since the last time anyone looked.
+static void hostSimSpi_updateFifo() {
+  if (!hostSimSpi_touched || hostSimSpi_fifoIsHeldInReset() ||
+      !(hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_TSC_CTRL] & HOSTSIM_STMPE_TSC_CTRL_EN))
+    return;
+  uint64_t now = hostSim_getElapsedNanoseconds();
+  uint64_t period = hostSimSpi_samplePeriodNs();
+  while (now - hostSimSpi_lastSampleNs >= period) {
+    hostSimSpi_lastSampleNs += period;
+    if (hostSimSpi_fifoCount == HOSTSIM_STMPE_FIFO_DEPTH) {
+      hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_INT_STA] |= HOSTSIM_STMPE_INT_STA_FIFO_OFLOW;
+      hostSimSpi_lastSampleNs = now;  // Full: no point in catching up any further.
+      break;
+    }
+    hostSimSpi_fifo[(hostSimSpi_fifoHead + hostSimSpi_fifoCount) % HOSTSIM_STMPE_FIFO_DEPTH] = hostSimSpi_touchPoint;
+    hostSimSpi_fifoCount++;
+    uint8_t threshold = hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_FIFO_TH];
+    if (threshold && hostSimSpi_fifoCount >= threshold)
+      hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_INT_STA] |= HOSTSIM_STMPE_INT_STA_FIFO_TH;
+  }
+}
+
+// INT is asserted while an enabled interrupt status bit is set (level mode; the polarity
+// setting only matters on the wire).
+static void hostSimSpi_updateInterruptLine() {
+  bool asserted = (hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_INT_CTRL] & HOSTSIM_STMPE_INT_CTRL_ENABLE) &&
+                  (hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_INT_STA] & hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_INT_EN]);
+  hostSim_setInterruptLine(XPAR_FABRIC_TOUCH_INT_INTR, asserted);
+}
+
+void hostSimSpi_update() {
+  if (!hostSimSpi_stmpeInitialized)
+    return;
+  hostSimSpi_updateFifo();
+  hostSimSpi_updateInterruptLine();
+}
+
+// Returns the next byte of the oldest sample, in the packed 12-bit X/Y plus 8-bit Z format.
+static uint8_t hostSimSpi_readFifoByte() {
+  if (!hostSimSpi_fifoCount)
+    return 0;
+  hostSimSpi_touchSample_t *sample = &hostSimSpi_fifo[hostSimSpi_fifoHead];
+  uint8_t value = 0;
+  switch (hostSimSpi_fifoByteIndex) {
+  case 0: value = sample->x >> 4; break;
+  case 1: value = ((sample->x & 0xF) << 4) | ((sample->y >> 8) & 0xF); break;
+  case 2: value = sample->y & 0xFF; break;
+  case 3: value = sample->z; break;
+  }
+  if (++hostSimSpi_fifoByteIndex == HOSTSIM_STMPE_BYTES_PER_SAMPLE) {
+    hostSimSpi_fifoByteIndex = 0;
+    hostSimSpi_fifoHead = (hostSimSpi_fifoHead + 1) % HOSTSIM_STMPE_FIFO_DEPTH;
+    hostSimSpi_fifoCount--;
+  }
+  return value;
+}
+
+static uint8_t hostSimSpi_stmpeReadRegister(uint8_t address) {
+  switch (address) {
+  case HOSTSIM_STMPE_TSC_CTRL:
+    return (hostSimSpi_stmpeRegisters[address] & ~HOSTSIM_STMPE_TSC_CTRL_TOUCH_DET) |
+           (hostSimSpi_touched && (hostSimSpi_stmpeRegisters[address] & HOSTSIM_STMPE_TSC_CTRL_EN) ?
+            HOSTSIM_STMPE_TSC_CTRL_TOUCH_DET : 0);
+  case HOSTSIM_STMPE_FIFO_STA: {
+    uint8_t status = hostSimSpi_stmpeRegisters[address] & HOSTSIM_STMPE_FIFO_STA_RESET;
+    uint8_t threshold = hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_FIFO_TH];
+    if (!hostSimSpi_fifoCount)
+      status |= HOSTSIM_STMPE_FIFO_STA_EMPTY;
+    if (hostSimSpi_fifoCount == HOSTSIM_STMPE_FIFO_DEPTH)
+      status |= HOSTSIM_STMPE_FIFO_STA_FULL;
+    if (threshold && hostSimSpi_fifoCount >= threshold)
+      status |= HOSTSIM_STMPE_FIFO_STA_THTRIG;
+    if (hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_INT_STA] & HOSTSIM_STMPE_INT_STA_FIFO_OFLOW)
+      status |= HOSTSIM_STMPE_FIFO_STA_OFLOW;
+    return status;
+  }
+  case HOSTSIM_STMPE_FIFO_SIZE:
+    return hostSimSpi_fifoCount;
+  case HOSTSIM_STMPE_TSC_DATA_NON_INC:
+    return hostSimSpi_readFifoByte();
+  default:
+    return hostSimSpi_stmpeRegisters[address];
+  }
+}
+
+static void hostSimSpi_stmpeWriteRegister(uint8_t address, uint8_t value) {
+  switch (address) {
+  case HOSTSIM_STMPE_CHIP_ID_MSB:
+  case HOSTSIM_STMPE_CHIP_ID_LSB:
+  case HOSTSIM_STMPE_ID_VER:
+    break;  // Read-only.
+  case HOSTSIM_STMPE_SYS_CTRL1:
+    if (value & HOSTSIM_STMPE_SYS_CTRL1_RESET)
+      hostSimSpi_stmpeReset();
+    else
+      hostSimSpi_stmpeRegisters[address] = value;
+    break;
+  case HOSTSIM_STMPE_INT_STA: {
+    hostSimSpi_stmpeRegisters[address] &= ~value;  // Write 1 to clear.
+    uint8_t threshold = hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_FIFO_TH];
+    if (threshold && hostSimSpi_fifoCount >= threshold)  // Comes straight back while the FIFO is still at threshold.
+      hostSimSpi_stmpeRegisters[address] |= HOSTSIM_STMPE_INT_STA_FIFO_TH;
+    break;
+  }
+  case HOSTSIM_STMPE_FIFO_STA:
+    hostSimSpi_stmpeRegisters[address] = value & HOSTSIM_STMPE_FIFO_STA_RESET;
+    if (value & HOSTSIM_STMPE_FIFO_STA_RESET)
+      hostSimSpi_fifoHead = hostSimSpi_fifoCount = hostSimSpi_fifoByteIndex = 0;
+    else
+      hostSimSpi_lastSampleNs = hostSim_getElapsedNanoseconds();
+    break;
+  default:
+    hostSimSpi_stmpeRegisters[address] = value;
+    break;
+  }
+}
+
+// One byte on the wire. The first byte is the address (bit 7 set for a read). A read
+// shifts out one dummy byte and then data; writes take data from the second byte on.
+// Accesses auto-increment the address except for the FIFO data port.
+static uint8_t hostSimSpi_stmpeTransfer(uint8_t mosi) {
+  if (!hostSimSpi_stmpeInitialized)
+    hostSimSpi_stmpeReset();
+  hostSimSpi_updateFifo();
+  uint32_t byteIndex = hostSimSpi_transactionByteCount++;
+  if (byteIndex == 0) {
+    hostSimSpi_transactionIsRead = mosi & HOSTSIM_STMPE_READ_MASK;
+    hostSimSpi_transactionAddress = mosi & ~HOSTSIM_STMPE_READ_MASK;
+    return 0;
+  }
+  uint8_t address = hostSimSpi_transactionAddress;
+  if (address != HOSTSIM_STMPE_TSC_DATA_NON_INC)
+    hostSimSpi_transactionAddress = (address + 1) % HOSTSIM_STMPE_REGISTER_COUNT;
+  if (hostSimSpi_transactionIsRead) {
+    if (byteIndex == 1) {
+      hostSimSpi_transactionAddress = address;  // The dummy byte doesn't advance the address.
+      return 0;
+    }
+    return hostSimSpi_stmpeReadRegister(address);
+  }
+  hostSimSpi_stmpeWriteRegister(address, mosi);
+  hostSimSpi_updateInterruptLine();
+  return 0;
+}
+
+void hostSim_touchDown(uint16_t rawX, uint16_t rawY, uint8_t z) {
+  if (!hostSimSpi_stmpeInitialized)
+    hostSimSpi_stmpeReset();
+  if (!hostSimSpi_touched) {
+    hostSimSpi_lastSampleNs = hostSim_getElapsedNanoseconds();
+    hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_INT_STA] |= HOSTSIM_STMPE_INT_STA_TOUCH_DET;
+  } else {
+    hostSimSpi_updateFifo();  // Samples up to now were taken at the old position.
+  }
+  hostSimSpi_touchPoint.x = rawX & 0xFFF;
+  hostSimSpi_touchPoint.y = rawY & 0xFFF;
+  hostSimSpi_touchPoint.z = z;
+  hostSimSpi_touched = true;
+  hostSimSpi_updateInterruptLine();
+}
+
+void hostSim_touchUp() {
+  if (!hostSimSpi_touched)
+    return;
+  hostSimSpi_updateFifo();
+  hostSimSpi_touched = false;
+  hostSimSpi_stmpeRegisters[HOSTSIM_STMPE_INT_STA] |= HOSTSIM_STMPE_INT_STA_TOUCH_DET;
+  hostSimSpi_updateInterruptLine();
+}
+
+bool hostSim_isTouchDown() {
+  return hostSimSpi_touched;
+}
+
+// ******************************* AXI SPI controller *******************************
+
+static uint32_t hostSimSpi_controlRegister = HOSTSIM_SPI_CR_RESET_VALUE;
+static uint32_t hostSimSpi_slaveSelectRegister = 0xFFFFFFFF;
+static uint8_t hostSimSpi_txFifo[HOSTSIM_SPI_FIFO_DEPTH];
+static uint8_t hostSimSpi_rxFifo[HOSTSIM_SPI_FIFO_DEPTH];
+static uint32_t hostSimSpi_txHead = 0, hostSimSpi_txCount = 0;
+static uint32_t hostSimSpi_rxHead = 0, hostSimSpi_rxCount = 0;
+static uint32_t hostSimSpi_globalInterruptEnable = 0;
+static uint32_t hostSimSpi_interruptStatus = 0;
+static uint32_t hostSimSpi_interruptEnable = 0;
+
+static void hostSimSpi_updateCoreInterruptLine() {
+  hostSim_setInterruptLine(XPAR_FABRIC_SPI_0_IP2INTC_IRPT_INTR,
+                           (hostSimSpi_globalInterruptEnable & HOSTSIM_SPI_DGIER_GIE_MASK) &&
+                           (hostSimSpi_interruptStatus & hostSimSpi_interruptEnable));
+}
+
+static bool hostSimSpi_isTouchSelected() {
+  return !(hostSimSpi_slaveSelectRegister & HOSTSIM_SPI_TOUCH_SLAVE_SELECT_MASK);
+}
+
+// Empties the TX FIFO onto the wire if the controller is allowed to run.
+static void hostSimSpi_shift() {
+  uint32_t required = HOSTSIM_SPI_CR_SPE_MASK | HOSTSIM_SPI_CR_MASTER_MASK;
+  if ((hostSimSpi_controlRegister & required) != required || (hostSimSpi_controlRegister & HOSTSIM_SPI_CR_INHIBIT_MASK))
+    return;
+  if (!hostSimSpi_txCount)
+    return;
+  while (hostSimSpi_txCount) {
+    uint8_t mosi = hostSimSpi_txFifo[hostSimSpi_txHead];
+    hostSimSpi_txHead = (hostSimSpi_txHead + 1) % HOSTSIM_SPI_FIFO_DEPTH;
+    hostSimSpi_txCount--;
+    uint8_t miso = HOSTSIM_SPI_NO_SLAVE_DATA;
+    if (hostSimSpi_controlRegister & HOSTSIM_SPI_CR_LOOP_MASK)
+      miso = mosi;
+    else if (hostSimSpi_isTouchSelected())
+      miso = hostSimSpi_stmpeTransfer(mosi);
+    if (hostSimSpi_rxCount < HOSTSIM_SPI_FIFO_DEPTH) {  // Like the core, drop data on overrun.
+      hostSimSpi_rxFifo[(hostSimSpi_rxHead + hostSimSpi_rxCount) % HOSTSIM_SPI_FIFO_DEPTH] = miso;
+      hostSimSpi_rxCount++;
+    }
+  }
+  hostSimSpi_interruptStatus |= HOSTSIM_SPI_INTERRUPT_DTR_EMPTY_MASK;
+  hostSimSpi_updateCoreInterruptLine();
+}
+
+static void hostSimSpi_reset() {
+  hostSimSpi_controlRegister = HOSTSIM_SPI_CR_RESET_VALUE;
+  hostSimSpi_slaveSelectRegister = 0xFFFFFFFF;
+  hostSimSpi_txHead = hostSimSpi_txCount = 0;
+  hostSimSpi_rxHead = hostSimSpi_rxCount = 0;
+  hostSimSpi_transactionByteCount = 0;
+  hostSimSpi_globalInterruptEnable = hostSimSpi_interruptStatus = hostSimSpi_interruptEnable = 0;
+  hostSimSpi_updateCoreInterruptLine();
+}
+
+uint32_t hostSimSpi_readRegister(uint32_t offset) {
+  switch (offset) {
+  case HOSTSIM_SPI_DGIER_OFFSET:
+    return hostSimSpi_globalInterruptEnable;
+  case HOSTSIM_SPI_IPISR_OFFSET:
+    return hostSimSpi_interruptStatus;
+  case HOSTSIM_SPI_IPIER_OFFSET:
+    return hostSimSpi_interruptEnable;
+  case HOSTSIM_SPI_CR_OFFSET:
+    return hostSimSpi_controlRegister;
+  case HOSTSIM_SPI_SR_OFFSET:
+    return (hostSimSpi_rxCount == 0 ? HOSTSIM_SPI_SR_RX_EMPTY_MASK : 0) |
+           (hostSimSpi_rxCount == HOSTSIM_SPI_FIFO_DEPTH ? HOSTSIM_SPI_SR_RX_FULL_MASK : 0) |
+           (hostSimSpi_txCount == 0 ? HOSTSIM_SPI_SR_TX_EMPTY_MASK : 0) |
+           (hostSimSpi_txCount == HOSTSIM_SPI_FIFO_DEPTH ? HOSTSIM_SPI_SR_TX_FULL_MASK : 0);
+  case HOSTSIM_SPI_DRR_OFFSET: {
+    if (!hostSimSpi_rxCount)
+      return 0;
+    uint8_t value = hostSimSpi_rxFifo[hostSimSpi_rxHead];
+    hostSimSpi_rxHead = (hostSimSpi_rxHead + 1) % HOSTSIM_SPI_FIFO_DEPTH;
+    hostSimSpi_rxCount--;
+    return value;
+  }
+  case HOSTSIM_SPI_SSR_OFFSET:
+    return hostSimSpi_slaveSelectRegister;
+  case HOSTSIM_SPI_TX_OCCUPANCY_OFFSET:
+    return hostSimSpi_txCount ? hostSimSpi_txCount - 1 : 0;
+  case HOSTSIM_SPI_RX_OCCUPANCY_OFFSET:
+    return hostSimSpi_rxCount ? hostSimSpi_rxCount - 1 : 0;
+  default:
+    return 0;
+  }
+}
+
+void hostSimSpi_writeRegister(uint32_t offset, uint32_t value) {
+  switch (offset) {
+  case HOSTSIM_SPI_DGIER_OFFSET:
+    hostSimSpi_globalInterruptEnable = value & HOSTSIM_SPI_DGIER_GIE_MASK;
+    hostSimSpi_updateCoreInterruptLine();
+    break;
+  case HOSTSIM_SPI_IPISR_OFFSET:
+    hostSimSpi_interruptStatus ^= value & HOSTSIM_SPI_INTERRUPT_DTR_EMPTY_MASK;  // Toggle on write.
+    hostSimSpi_updateCoreInterruptLine();
+    break;
+  case HOSTSIM_SPI_IPIER_OFFSET:
+    hostSimSpi_interruptEnable = value & HOSTSIM_SPI_INTERRUPT_DTR_EMPTY_MASK;
+    hostSimSpi_updateCoreInterruptLine();
+    break;
+  case HOSTSIM_SPI_SRR_OFFSET:
+    if (value == HOSTSIM_SPI_SRR_RESET_VALUE)
+      hostSimSpi_reset();
+    break;
+  case HOSTSIM_SPI_CR_OFFSET:
+    if (value & HOSTSIM_SPI_CR_TX_FIFO_RESET_MASK)
+      hostSimSpi_txHead = hostSimSpi_txCount = 0;
+    if (value & HOSTSIM_SPI_CR_RX_FIFO_RESET_MASK)
+      hostSimSpi_rxHead = hostSimSpi_rxCount = 0;
+    // The FIFO reset bits are self-clearing.
+    hostSimSpi_controlRegister = value & ~(HOSTSIM_SPI_CR_TX_FIFO_RESET_MASK | HOSTSIM_SPI_CR_RX_FIFO_RESET_MASK);
+    hostSimSpi_shift();
+    break;
+  case HOSTSIM_SPI_DTR_OFFSET:
+    if (hostSimSpi_txCount < HOSTSIM_SPI_FIFO_DEPTH) {
+      hostSimSpi_txFifo[(hostSimSpi_txHead + hostSimSpi_txCount) % HOSTSIM_SPI_FIFO_DEPTH] = value;
+      hostSimSpi_txCount++;
+    }
+    hostSimSpi_shift();
+    break;
+  case HOSTSIM_SPI_SSR_OFFSET: {
+    bool wasSelected = hostSimSpi_isTouchSelected();
+    hostSimSpi_slaveSelectRegister = value;
+    if (wasSelected != hostSimSpi_isTouchSelected())
+      hostSimSpi_transactionByteCount = 0;  // Chip select edge starts a new transaction.
+    break;
+  }
+  default:
+    break;
+  }
+}
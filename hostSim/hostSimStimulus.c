@@ -0,0 +1,96 @@
+/*
+ * hostSimStimulus.c
+ *
+ * Plays a timed script of button and touch-panel events into the hardware model so that
+ * the interactive tests and the game itself can run without anyone at the keyboard.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "hostSim.h"
+
+#define HOSTSIM_STIMULUS_MAX_EVENTS 1024
+#define HOSTSIM_STIMULUS_LINE_LENGTH 128
+#define HOSTSIM_STIMULUS_NANOSECONDS_PER_MS 1000000ULL
+
+typedef enum {
+  HOSTSIM_STIMULUS_TOUCH,
+  HOSTSIM_STIMULUS_RELEASE,
+  HOSTSIM_STIMULUS_BUTTONS
+} hostSimStimulus_eventType_t;
+
+typedef struct {
+  uint64_t timeNs;
+  hostSimStimulus_eventType_t type;
+  uint32_t arg0;
+  uint32_t arg1;
+  uint32_t arg2;
+} hostSimStimulus_event_t;
+
+static hostSimStimulus_event_t hostSimStimulus_events[HOSTSIM_STIMULUS_MAX_EVENTS];
+static uint32_t hostSimStimulus_eventCount = 0;
+static uint32_t hostSimStimulus_nextEvent = 0;
+
+// Parses the script. Blank lines and lines starting with '#' are ignored.
+bool hostSim_loadStimulus(const char *fileName) {
+  FILE *file = fopen(fileName, "r");
+  if (!file) {
+    printf("hostSim: can't open stimulus file %s\n\r", fileName);
+    return false;
+  }
+  char line[HOSTSIM_STIMULUS_LINE_LENGTH];
+  uint32_t lineNumber = 0;
+  hostSimStimulus_eventCount = hostSimStimulus_nextEvent = 0;
+  while (fgets(line, sizeof(line), file)) {
+    lineNumber++;
+    unsigned long long timeMs;
+    char command[16];
+    unsigned int a = 0, b = 0, c = 0;
+    if (line[0] == '#' || sscanf(line, "%llu %15s", &timeMs, command) != 2)
+      continue;
+    if (hostSimStimulus_eventCount == HOSTSIM_STIMULUS_MAX_EVENTS) {
+      printf("hostSim: %s has more than %d events, ignoring the rest\n\r", fileName, HOSTSIM_STIMULUS_MAX_EVENTS);
+      break;
+    }
+    hostSimStimulus_event_t *event = &hostSimStimulus_events[hostSimStimulus_eventCount];
+    event->timeNs = timeMs * HOSTSIM_STIMULUS_NANOSECONDS_PER_MS;
+    if (!strcmp(command, "touch") && sscanf(line, "%*u %*s %u %u %u", &a, &b, &c) == 3) {
+      event->type = HOSTSIM_STIMULUS_TOUCH;
+    } else if (!strcmp(command, "release")) {
+      event->type = HOSTSIM_STIMULUS_RELEASE;
+    } else if (!strcmp(command, "buttons") && sscanf(line, "%*u %*s %i", (int *) &a) == 1) {
+      event->type = HOSTSIM_STIMULUS_BUTTONS;
+    } else {
+      printf("hostSim: %s:%u: can't parse \"%s\"\n\r", fileName, (unsigned) lineNumber, command);
+      continue;
+    }
+    event->arg0 = a;
+    event->arg1 = b;
+    event->arg2 = c;
+    hostSimStimulus_eventCount++;
+  }
+  fclose(file);
+  return true;
+}
+
+// Applies every event whose time has come.
+void hostSim_applyStimulus() {
+  if (hostSimStimulus_nextEvent == hostSimStimulus_eventCount)
+    return;
+  uint64_t now = hostSim_getElapsedNanoseconds();
+  while (hostSimStimulus_nextEvent < hostSimStimulus_eventCount &&
+         hostSimStimulus_events[hostSimStimulus_nextEvent].timeNs <= now) {
+    hostSimStimulus_event_t *event = &hostSimStimulus_events[hostSimStimulus_nextEvent++];
+    switch (event->type) {
+    case HOSTSIM_STIMULUS_TOUCH:
+      hostSim_touchDown(event->arg0, event->arg1, event->arg2);
+      break;
+    case HOSTSIM_STIMULUS_RELEASE:
+      hostSim_touchUp();
+      break;
+    case HOSTSIM_STIMULUS_BUTTONS:
+      hostSim_setButtons(event->arg0);
+      break;
+    }
+  }
+}
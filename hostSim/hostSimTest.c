@@ -0,0 +1,211 @@
+/*
+ * hostSimTest.c
+ *
+ * Host entry point for the test routines. simonMain.c provides main() for the game, so the
+ * *_runTest() functions get their own executable: "simonTest <test> [argument]".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "buttons.h"
+#include "buttonHandler.h"
+#include "flashSequence.h"
+#include "verifySequence.h"
+#include "simonDisplay.h"
+#include "simonControl.h"
+#include "intervalTimer.h"
+#include "supportFiles/leds.h"
+#include "supportFiles/globalTimer.h"
+#include "supportFiles/display.h"
+#include "supportFiles/interrupts.h"
+#include "scheduler.h"
+#include "hostSim.h"
+#include "hostSimPlayer.h"
+#include "hostSimReplay.h"
+
+#define HOSTSIM_TEST_DEFAULT_TOUCH_COUNT 10
+#define HOSTSIM_TEST_CIRCLE_RADIUS 10
+#define HOSTSIM_TEST_DEFAULT_BENCHMARK_RUNS 5
+#define HOSTSIM_TEST_DEFAULT_GAME_COUNT 100
+#define HOSTSIM_TEST_DEFAULT_GAME_SEED 1
+#define HOSTSIM_TEST_DEFAULT_RECORDING_FILE "touchRoundTrip.trc"
+#define HOSTSIM_TEST_ROUND_TRIP_GAME_COUNT 5
+#define HOSTSIM_TEST_ROUND_TRIP_RUN_SECONDS 1.0
+#define HOSTSIM_TEST_MAX_RECORDS 65536
+#define HOSTSIM_TEST_FILE_NAME_LENGTH 256
+
+static display_touchRecordingHeader_t hostSimTest_recordingHeader;
+static display_touchRecord_t hostSimTest_records[HOSTSIM_TEST_MAX_RECORDS];
+
+// Runs all of the display_test*() drawing routines once, either straight to the panel or
+// through the frame buffer with a flush after each routine.
+static void hostSimTest_display(bool useFrameBuffer) {
+  display_init();
+  display_setFrameBufferEnabled(useFrameBuffer);
+  display_testFillScreen();
+  display_flush();
+  display_testText();
+  display_flush();
+  display_testLines(DISPLAY_CYAN);
+  display_flush();
+  display_testFastLines(DISPLAY_RED, DISPLAY_BLUE);
+  display_flush();
+  display_testRects(DISPLAY_GREEN);
+  display_flush();
+  display_testFilledRects(DISPLAY_YELLOW, DISPLAY_MAGENTA);
+  display_flush();
+  display_testFilledCircles(HOSTSIM_TEST_CIRCLE_RADIUS, DISPLAY_MAGENTA);
+  display_flush();
+  display_testCircles(HOSTSIM_TEST_CIRCLE_RADIUS, DISPLAY_WHITE);
+  display_flush();
+  display_testTriangles();
+  display_flush();
+  display_testFilledTriangles();
+  display_flush();
+  display_testRoundRects();
+  display_flush();
+  display_testFilledRoundRects();
+  display_flush();
+}
+
+// Loads the touch calibration from the file if it holds a valid one, otherwise runs the
+// touch-to-calibrate routine and saves the result there. This is the host's stand-in for the
+// non-volatile storage that the board doesn't have.
+static int hostSimTest_touchCalibration(const char *fileName) {
+  display_init();
+  display_touchCalibration_t calibration;
+  FILE *file = fileName ? fopen(fileName, "rb") : NULL;
+  bool loaded = file && fread(&calibration, sizeof(calibration), 1, file) == 1 && display_setTouchCalibration(&calibration);
+  if (file)
+    fclose(file);
+  if (loaded) {
+    printf("loaded touch calibration from %s\n\r", fileName);
+  } else {
+    if (!display_runTouchCalibration(&calibration)) {
+      printf("touch calibration failed\n\r");
+      return 1;
+    }
+    file = fileName ? fopen(fileName, "wb") : NULL;
+    if (file) {
+      fwrite(&calibration, sizeof(calibration), 1, file);
+      fclose(file);
+      printf("saved touch calibration to %s\n\r", fileName);
+    }
+  }
+  display_getTouchCalibration(&calibration);
+  printf("lcdX = (%ld * rawX + %ld * rawY + %ld) >> %d\n\r", (long) calibration.xx, (long) calibration.xy,
+         (long) calibration.x0, DISPLAY_TOUCH_CALIBRATION_FRACTION_BITS);
+  printf("lcdY = (%ld * rawX + %ld * rawY + %ld) >> %d\n\r", (long) calibration.yx, (long) calibration.yy,
+         (long) calibration.y0, DISPLAY_TOUCH_CALIBRATION_FRACTION_BITS);
+  return 0;
+}
+
+// Compares two files byte for byte and prints where they first differ.
+static bool hostSimTest_compareFiles(const char *firstName, const char *secondName) {
+  FILE *first = fopen(firstName, "rb");
+  FILE *second = fopen(secondName, "rb");
+  bool same = first && second;
+  long offset = 0;
+  while (same) {
+    int a = fgetc(first);
+    int b = fgetc(second);
+    same = a == b;
+    if (a == EOF || b == EOF)
+      break;
+    offset++;
+  }
+  if (first && second && !same)
+    printf("%s and %s differ at byte %ld\n\r", firstName, secondName, offset);
+  if (first)
+    fclose(first);
+  if (second)
+    fclose(second);
+  return same;
+}
+
+// Records the virtual player's touches over a few games into fileName, then replays the file
+// while recording it again into fileName.replay. The two files have to be the same, byte for
+// byte: a replay reproduces the recorded session, down to the time of each event.
+static int hostSimTest_touchReplay(const char *fileName, uint32_t seed) {
+  hostSim_useVirtualTime();  // Before the recording takes its start time.
+  display_startTouchRecording(&hostSimTest_recordingHeader, hostSimTest_records, HOSTSIM_TEST_MAX_RECORDS);
+  bool played = hostSimPlayer_runGames(HOSTSIM_TEST_ROUND_TRIP_GAME_COUNT, seed);
+  display_stopTouchRecording();
+  if (!played || !hostSimReplay_saveRecording(fileName, &hostSimTest_recordingHeader, hostSimTest_records))
+    return 1;
+  uint32_t recordCount = hostSimTest_recordingHeader.count;
+
+  char replayFileName[HOSTSIM_TEST_FILE_NAME_LENGTH];
+  snprintf(replayFileName, sizeof(replayFileName), "%s.replay", fileName);
+  // The recording starts ahead of the replay, as it does with both environment variables set.
+  display_startTouchRecording(&hostSimTest_recordingHeader, hostSimTest_records, HOSTSIM_TEST_MAX_RECORDS);
+  if (!hostSimReplay_start(fileName))
+    return 1;
+  interrupts_enableArmInts();
+  while (hostSimReplay_getNextEventNanoseconds() != UINT64_MAX)
+    scheduler_runTickless(scheduler_getDeadline(HOSTSIM_TEST_ROUND_TRIP_RUN_SECONDS));
+  interrupts_disableArmInts();
+  display_stopTouchRecording();
+  if (!hostSimReplay_saveRecording(replayFileName, &hostSimTest_recordingHeader, hostSimTest_records))
+    return 1;
+
+  bool same = hostSimTest_compareFiles(fileName, replayFileName);
+  printf("\n\rtouch replay round trip %s: %lu records\n\r", same ? "passed" : "FAILED", (unsigned long) recordCount);
+  return same ? 0 : 1;
+}
+
+// Prints the list of tests.
+static void hostSimTest_usage(const char *programName) {
+  printf("usage: %s <test> [argument] [seed]\n\r", programName);
+  printf("tests: buttons, buttonHandler [touchCount], flashSequence, verifySequence,\n\r");
+  printf("       simonDisplay [touchCount], simonControl, intervalTimer [timerNumber],\n\r");
+  printf("       leds, globalTimer, display [useFrameBuffer], displayBenchmark [runCount],\n\r");
+  printf("       touchCalibration [file], games [gameCount] [seed], touchReplay [file] [seed]\n\r");
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    hostSimTest_usage(argv[0]);
+    return 1;
+  }
+  const char *test = argv[1];
+  bool hasArgument = argc > 2;
+  long argument = hasArgument ? strtol(argv[2], NULL, 0) : 0;
+  if (!strcmp(test, "buttons")) {
+    buttons_runTest();
+  } else if (!strcmp(test, "buttonHandler")) {
+    buttonHandler_runTest(hasArgument ? argument : HOSTSIM_TEST_DEFAULT_TOUCH_COUNT);
+  } else if (!strcmp(test, "flashSequence")) {
+    flashSequence_runTest();
+  } else if (!strcmp(test, "verifySequence")) {
+    verifySequence_runTest();
+  } else if (!strcmp(test, "simonDisplay")) {
+    simonDisplay_runTest(hasArgument ? argument : HOSTSIM_TEST_DEFAULT_TOUCH_COUNT);
+  } else if (!strcmp(test, "simonControl")) {
+    simonControl_test();
+  } else if (!strcmp(test, "intervalTimer")) {
+    return intervalTimer_runTest(argument) == INTERVAL_TIMER_STATUS_OK ? 0 : 1;
+  } else if (!strcmp(test, "leds")) {
+    leds_init(true);
+    leds_runTest();
+  } else if (!strcmp(test, "globalTimer")) {
+    globalTimer_test(true);
+  } else if (!strcmp(test, "displayBenchmark")) {
+    display_runBenchmarks(hasArgument ? argument : HOSTSIM_TEST_DEFAULT_BENCHMARK_RUNS);
+  } else if (!strcmp(test, "display")) {
+    hostSimTest_display(argument != 0);
+  } else if (!strcmp(test, "touchCalibration")) {
+    return hostSimTest_touchCalibration(hasArgument ? argv[2] : NULL);
+  } else if (!strcmp(test, "games")) {
+    uint32_t seed = argc > 3 ? strtoul(argv[3], NULL, 0) : HOSTSIM_TEST_DEFAULT_GAME_SEED;
+    return hostSimPlayer_runGames(hasArgument ? argument : HOSTSIM_TEST_DEFAULT_GAME_COUNT, seed) ? 0 : 1;
+  } else if (!strcmp(test, "touchReplay")) {
+    uint32_t seed = argc > 3 ? strtoul(argv[3], NULL, 0) : HOSTSIM_TEST_DEFAULT_GAME_SEED;
+    return hostSimTest_touchReplay(hasArgument ? argv[2] : HOSTSIM_TEST_DEFAULT_RECORDING_FILE, seed);
+  } else {
+    hostSimTest_usage(argv[0]);
+    return 1;
+  }
+  return 0;
+}
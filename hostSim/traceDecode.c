@@ -0,0 +1,133 @@
+/*
+ * traceDecode.c
+ *
+ * Turns a trace_dump() (see supportFiles/trace.h) into a timeline. The input can be a whole
+ * console log, from the board's UART or from build/simon: everything outside the dump is
+ * skipped. "traceDecode [file]" reads standard input without a file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+#define TRACE_DECODE_LINE_LENGTH 256
+
+// State names, in the order of the state enums in src/.
+static const char *simonControlStates[] = {"initial_st", "touch_to_start_st", "wait_for_release_st",
+  "pause_before_flash_st", "flash_sequence_st", "verify_sequence_st", "congrats_st", "touch_for_new_level_st",
+  "display_score_st"};
+static const char *flashSequenceStates[] = {"initial_st", "flashRegion_st", "delay_timer_st", "final_st"};
+static const char *verifySequenceStates[] = {"initial_st", "wait_for_press_st", "verify_st", "final_st"};
+static const char *buttonHandlerStates[] = {"initial_st", "wait_for_touch_st", "wait_for_release_st", "final_st"};
+
+typedef struct {
+  const char *name;
+  const char **states;
+  unsigned stateCount;
+} traceDecode_source_t;
+
+#define TRACE_DECODE_STATES(states) states, sizeof(states) / sizeof(states[0])
+
+// Indexed by trace_source_t.
+static const traceDecode_source_t traceDecode_sources[TRACE_SOURCE_COUNT] = {
+  {"simonControl", TRACE_DECODE_STATES(simonControlStates)},
+  {"flashSequence", TRACE_DECODE_STATES(flashSequenceStates)},
+  {"verifySequence", TRACE_DECODE_STATES(verifySequenceStates)},
+  {"buttonHandler", TRACE_DECODE_STATES(buttonHandlerStates)},
+  {"display", NULL, 0},
+  {"spi", NULL, 0},
+};
+
+static const char *traceDecode_touchTypes[] = {"DOWN", "MOVE", "UP"};
+
+static const char *traceDecode_stateName(const traceDecode_source_t *source, unsigned state) {
+  static char unknown[16];
+  if (source && state < source->stateCount)
+    return source->states[state];
+  snprintf(unknown, sizeof(unknown), "state %u", state);
+  return unknown;
+}
+
+// Prints one record. time is in seconds since the first record.
+static void traceDecode_print(double time, unsigned sourceId, unsigned event, unsigned oldState, unsigned newState,
+                              unsigned long arg) {
+  const traceDecode_source_t *source = sourceId < TRACE_SOURCE_COUNT ? &traceDecode_sources[sourceId] : NULL;
+  printf("%12.3f ms  %-15s ", time * 1000, source ? source->name : "?");
+  switch (event) {
+  case TRACE_EVENT_TRANSITION:
+    printf("%s -> ", traceDecode_stateName(source, oldState));
+    printf("%s (%lu)\n", traceDecode_stateName(source, newState), arg);
+    break;
+  case TRACE_EVENT_ENABLE:
+    printf("enabled in %s\n", traceDecode_stateName(source, oldState));
+    break;
+  case TRACE_EVENT_DISABLE:
+    printf("disabled in %s\n", traceDecode_stateName(source, oldState));
+    break;
+  case TRACE_EVENT_TOUCH_ISR:
+    printf("touch interrupt%s\n", arg ? "" : " (read already running)");
+    break;
+  case TRACE_EVENT_TOUCH_EVENT:
+    printf("touch %s raw %lu, %lu\n", (arg >> 24) < 3 ? traceDecode_touchTypes[arg >> 24] : "?",
+           (arg >> 12) & 0xFFF, arg & 0xFFF);
+    break;
+  case TRACE_EVENT_SPI_SUBMIT:
+    printf("submit %lu bytes\n", arg);
+    break;
+  case TRACE_EVENT_SPI_COMPLETE:
+    printf("complete %lu bytes\n", arg);
+    break;
+  default:
+    printf("event %u: %u %u %lu\n", event, oldState, newState, arg);
+    break;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  FILE *input = argc > 1 ? fopen(argv[1], "r") : stdin;
+  if (!input) {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+  char line[TRACE_DECODE_LINE_LENGTH];
+  bool inDump = false;
+  int dumpCount = 0;
+  double countsPerSecond = 1;
+  long long firstTime = 0, time = 0;
+  unsigned long previous = 0;
+  unsigned long recordCount = 0;
+  while (fgets(line, sizeof(line), input)) {
+    unsigned long count, rate, timestamp, fields, arg;
+    // The board ends its lines with "\n\r", so the '\r' starts the next line.
+    char *text = line + strspn(line, "\r");
+    if (!strncmp(text, TRACE_DUMP_BEGIN, strlen(TRACE_DUMP_BEGIN))) {
+      if (sscanf(text + strlen(TRACE_DUMP_BEGIN), "%lu %lu", &count, &rate) != 2 || !rate)
+        continue;
+      printf("%strace of %lu records\n", dumpCount++ ? "\n" : "", count);
+      inDump = true;
+      countsPerSecond = rate;
+      recordCount = 0;
+    } else if (inDump && !strncmp(text, TRACE_DUMP_END, strlen(TRACE_DUMP_END))) {
+      inDump = false;
+    } else if (inDump && sscanf(text, "%lx %lx %lx", &timestamp, &fields, &arg) == 3) {
+      // Timestamps are 32 bits and wrap. The signed difference also copes with an ISR's record
+      // that landed just ahead of one with an earlier timestamp.
+      if (recordCount == 0)
+        time = firstTime = timestamp;
+      else
+        time += (int32_t) (timestamp - previous);
+      previous = timestamp;
+      recordCount++;
+      traceDecode_print((time - firstTime) / countsPerSecond, fields >> 24, (fields >> 16) & 0xFF,
+                        (fields >> 8) & 0xFF, fields & 0xFF, arg);
+    }
+  }
+  if (input != stdin)
+    fclose(input);
+  if (!dumpCount) {
+    fprintf(stderr, "no trace found\n");
+    return 1;
+  }
+  return 0;
+}
@@ -1,7 +1,6 @@
 #define RUN_TEST_TERMINATION_MESSAGE1 "buttonHandler_runTest()"
 #define RUN_TEST_TERMINATION_MESSAGE2 "terminated."
 #define RUN_TEST_TEXT_SIZE 2
-#define AD_WAIT_DURATION  (100E-3 / GLOBALS_TIMER_PERIOD) //  100 ms
 
 #include "globals.h"
 #include "buttonHandler.h"
@@ -9,26 +8,41 @@
 #include "supportFiles/utils.h"
 #include "simonDisplay.h"
 #include "stdio.h"
+#include "scheduler.h"
+#include "supportFiles/trace.h"
 
 enum buttonHandler_states
 	{initial_st,
 	wait_for_touch_st,
-	ad_timer_st,
 	wait_for_release_st,
 	final_st} buttonHandler_state;
 
 bool pressed;
 uint8_t regionPressed;
+// The touch is followed through the display's touch events: the latest position, and
+// whether the release has already come in.
+display_touchEvent_t lastTouchEvent;
+bool releaseQueued;
+
+// Consumes the queued touch events. Returns true if a touch is in progress or just happened.
+bool buttonHandler_readTouchEvents()
+{
+	bool touchSeen = false;
+	display_touchEvent_t event;
+	while(display_getTouchEvent(&event))
+	{
+		lastTouchEvent = event;
+		touchSeen = true;
+		if(event.type == DISPLAY_TOUCH_UP)
+			releaseQueued = true;
+	}
+	return touchSeen;
+}
 
 // Get the simon region numbers. See the source code for the region numbering scheme.
 void buttonHandler_calculateRegion()
 {
-	// get touched coords
-	int16_t touched_x;
-	int16_t touched_y;
-	uint8_t touched_z;
-	display_getTouchedPoint(&touched_x, &touched_y, &touched_z);
-	regionPressed = simonDisplay_computeRegionNumber(touched_x, touched_y);
+	regionPressed = simonDisplay_computeRegionNumberRaw(lastTouchEvent.rawX, lastTouchEvent.rawY);
 }
 
 bool enabled;
@@ -37,12 +51,16 @@ bool enabled;
 void buttonHandler_enable()
 {
 	enabled = true;
+	trace_write(TRACE_SOURCE_BUTTON_HANDLER, TRACE_EVENT_ENABLE, buttonHandler_state, buttonHandler_state, 0);
+	scheduler_wake(buttonHandler_tick);
 }
 
 // Turn off the state machine. Part of the interlock.
 void buttonHandler_disable()
 {
 	enabled = false;
+	trace_write(TRACE_SOURCE_BUTTON_HANDLER, TRACE_EVENT_DISABLE, buttonHandler_state, buttonHandler_state, 0);
+	scheduler_wake(buttonHandler_tick);
 }
 
 // Get the simon region numbers. See the source code for the region numbering scheme.
@@ -60,7 +78,7 @@ bool buttonHandler_releaseDetected()
 // Standard tick function.
 void buttonHandler_tick()
 {
-	static int32_t adTimer;
+	uint8_t oldState = buttonHandler_state;
 
 	// Current state actions
 	switch (buttonHandler_state)
@@ -69,9 +87,6 @@ void buttonHandler_tick()
 	break;
 	case wait_for_touch_st:
 	break;
-	case ad_timer_st:
-		adTimer++;
-	break;
 	case wait_for_release_st:
 	break;
 	case final_st:
@@ -86,41 +101,64 @@ void buttonHandler_tick()
 		{
 			buttonHandler_state = wait_for_touch_st;
 			pressed = false;
+			display_clearOldTouchData();  // Only touches from here on count.
+		}
+		else
+		{
+			scheduler_idle(buttonHandler_tick);  // Nothing to do until enabled.
 		}
 	break;
 	case wait_for_touch_st:
-		if(display_isTouched())
+		releaseQueued = false;
+		// A touch still held from before the handler was enabled shows up as MOVE events.
+		// The display only reports touches once they have settled, so there is nothing to wait for.
+		if(!enabled)
 		{
-			buttonHandler_state = ad_timer_st;
-			adTimer = 0;
-			display_clearOldTouchData();
-			buttonHandler_state = ad_timer_st;
+			buttonHandler_state = initial_st;  // Disabled before a touch, e.g. on a timeout.
 		}
-	break;
-	case ad_timer_st:
-		if(adTimer == AD_WAIT_DURATION)
+		else if(buttonHandler_readTouchEvents())
 		{
 			buttonHandler_calculateRegion();
 			simonDisplay_drawSquare(regionPressed, false);
 			buttonHandler_state = wait_for_release_st;
 		}
+		else
+		{
+			scheduler_waitForEvent(buttonHandler_tick, SCHEDULER_NO_DEADLINE);
+		}
 	break;
 	case wait_for_release_st:
-		if(!display_isTouched())
+		buttonHandler_readTouchEvents();
+		if(!enabled)
+		{
+			simonDisplay_drawSquare(regionPressed, true);
+			simonDisplay_drawButton(regionPressed);
+			buttonHandler_state = initial_st;
+		}
+		else if(releaseQueued)
 		{
 			simonDisplay_drawSquare(regionPressed, true);
 			simonDisplay_drawButton(regionPressed);
 			pressed = true;
 			buttonHandler_state = final_st;
 		}
+		else
+		{
+			scheduler_waitForEvent(buttonHandler_tick, SCHEDULER_NO_DEADLINE);
+		}
 	break;
 	case final_st:
 		if(!enabled)
 		{
 			buttonHandler_state = initial_st;
 		}
+		else
+		{
+			scheduler_idle(buttonHandler_tick);  // Nothing to do until disabled.
+		}
 	break;
 	}
+	trace_transition(TRACE_SOURCE_BUTTON_HANDLER, oldState, buttonHandler_state, regionPressed);
 }
 
 // buttonHandler_runTest(int16_t touchCount) runs the test until
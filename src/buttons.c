@@ -1,6 +1,7 @@
 #include "buttons.h"
 #include "supportFiles/display.h"
 #include "xparameters.h"
+#include "xil_io.h"
 #include <stdint.h>
 #include <stdio.h>
 
@@ -12,7 +13,7 @@ int32_t buttons_setBit(int32_t x, int32_t k, int32_t b);
 int32_t buttons_getBit(int32_t x, int32_t k);
 
 #define BUTTONS_GPIO_DEVICE_BASE_ADDRESS XPAR_GPIO_PUSH_BUTTONS_BASEADDR
-#define TRI_STATE_OFFSET 4
+#define TRI_STATE_OFFSET 0x4  // Byte offset of the GPIO tri-state register.
 #define FOUR_BIT_TRI_STATE_INPUT 0xF
 
 // Initialize buttons
@@ -26,17 +27,13 @@ int buttons_init()
 // Helper function to read GPIO registers.
 int32_t buttons_readGpioRegister(int32_t offset)
 {
-  // Note that you have to include a cast (uint32_t *) to keep the compiler happy.
-  uint32_t *ptr = (uint32_t *) BUTTONS_GPIO_DEVICE_BASE_ADDRESS + offset;
-  return *ptr;
+  return Xil_In32(BUTTONS_GPIO_DEVICE_BASE_ADDRESS + offset);
 }
 
 // Helper function to write GPIO registers.
 void buttons_writeGpioRegister(int32_t offset, int32_t value)
 {
-  // Note that you have to include a cast (uint32_t *) to keep the compiler happy.
-  uint32_t *ptr = (uint32_t *) BUTTONS_GPIO_DEVICE_BASE_ADDRESS + offset;
-  *ptr = value;
+  Xil_Out32(BUTTONS_GPIO_DEVICE_BASE_ADDRESS + offset, value);
 }
 
 // Returns the current value of all 4 buttons as the lower 4 bits of the returned value.
@@ -4,6 +4,8 @@
 #include "globals.h"
 #include "supportFiles/utils.h"
 #include "stdio.h"
+#include "scheduler.h"
+#include "supportFiles/trace.h"
 
 
 // This will set the sequence to a simple sequential pattern.
@@ -22,8 +24,6 @@ uint8_t flashSequence_testSequence[TEST_SEQUENCE_LENGTH] = {SIMON_DISPLAY_REGION
 #define RUN_TEST_COMPLETE_MESSAGE "Runtest() Complete"		// Info message.
 #define MESSAGE_TEXT_SIZE 2	                                // Make the text easy to see.
 
-#define DELAY_DURATION (.5 / GLOBALS_TIMER_PERIOD) // .5 s
-
 enum flashSequence_states
 	{initial_st,
 	flashRegion_st,
@@ -32,18 +32,23 @@ enum flashSequence_states
 
 bool completed;
 uint16_t index;
+static uint32_t sequenceWord;  // The packed word that holds the value at index (see globals.h).
 bool flashSequence_enabled;
 
 // Turn on the state machine. Part of the interlock.
 void flashSequence_enable()
 {
 	flashSequence_enabled = true;
+	trace_write(TRACE_SOURCE_FLASH_SEQUENCE, TRACE_EVENT_ENABLE, flashSequence_state, flashSequence_state, 0);
+	scheduler_wake(flashSequence_tick);
 }
 
 // Turn off the state machine. Part of the interlock.
 void flashSequence_disable()
 {
 	flashSequence_enabled = false;
+	trace_write(TRACE_SOURCE_FLASH_SEQUENCE, TRACE_EVENT_DISABLE, flashSequence_state, flashSequence_state, 0);
+	scheduler_wake(flashSequence_tick);
 }
 
 bool flashSequence_completed()
@@ -55,7 +60,8 @@ bool flashSequence_completed()
 // Standard tick function.
 void flashSequence_tick()
 {
-	static int32_t delayTimer;
+	static uint64_t delayDeadline;
+	uint8_t oldState = flashSequence_state;
 
 	// Current state actions
 	switch (flashSequence_state)
@@ -65,7 +71,6 @@ void flashSequence_tick()
 	case flashRegion_st:
 	break;
 	case delay_timer_st:
-		delayTimer++;
 	break;
 	case final_st:
 	break;
@@ -81,18 +86,24 @@ void flashSequence_tick()
 			completed = false;
 			index = 0;
 		}
+		else
+		{
+			scheduler_idle(flashSequence_tick);  // Nothing to do until enabled.
+		}
 	break;
 	case flashRegion_st:
 		//Flash next region in sequence
-		simonDisplay_drawSquare(globals_getSequenceValue(index), false);
-		delayTimer = 0;
+		if(index % GLOBALS_SEQUENCE_VALUES_PER_WORD == 0)
+			sequenceWord = globals_getSequenceWord(index / GLOBALS_SEQUENCE_VALUES_PER_WORD);
+		simonDisplay_drawSquare(globals_getSequenceWordValue(sequenceWord, index), false);
+		delayDeadline = scheduler_getDeadline(FLASHSEQUENCE_DELAY_DURATION);
 		flashSequence_state = delay_timer_st;
 	break;
 	case delay_timer_st:
-		if(delayTimer == DELAY_DURATION)
+		if(scheduler_isPast(delayDeadline))
 		{
 			// Blank last region in sequence
-			simonDisplay_drawSquare(globals_getSequenceValue(index), true);
+			simonDisplay_drawSquare(globals_getSequenceWordValue(sequenceWord, index), true);
 			index++;
 			if(index < globals_getSequenceIterationLength())
 			{
@@ -104,14 +115,23 @@ void flashSequence_tick()
 				flashSequence_state = final_st;
 			}
 		}
+		else
+		{
+			scheduler_sleepUntil(flashSequence_tick, delayDeadline);
+		}
 	break;
 	case final_st:
 		if(!flashSequence_enabled)
 		{
 			flashSequence_state = initial_st;
 		}
+		else
+		{
+			scheduler_idle(flashSequence_tick);  // Nothing to do until disabled.
+		}
 	break;
 	}
+	trace_transition(TRACE_SOURCE_FLASH_SEQUENCE, oldState, flashSequence_state, index);
 }
 
 // Print the incrementing sequence message.
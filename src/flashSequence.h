@@ -11,6 +11,8 @@
 #ifndef FLASHSEQUENCE_H_
 #define FLASHSEQUENCE_H_
 
+#define FLASHSEQUENCE_DELAY_DURATION .5 // s, each square stays lit this long.
+
 // Turns on the state machine. Part of the interlock.
 void flashSequence_enable();
 
@@ -1,6 +1,6 @@
 #include "globals.h"
 
-uint8_t globalsSequence[GLOBALS_MAX_FLASH_SEQUENCE];
+uint32_t globalsSequence[GLOBALS_SEQUENCE_WORD_COUNT];  // Packed, see globals.h.
 uint16_t globalsSeqLength;
 uint16_t globalsIterLength;
 
@@ -9,17 +9,43 @@ uint16_t globalsIterLength;
 // Do not just grab the pointer as this will fail.
 void globals_setSequence(const uint8_t sequence[], uint16_t length)
 {
+	if(length > GLOBALS_MAX_FLASH_SEQUENCE)
+		length = GLOBALS_MAX_FLASH_SEQUENCE;
+	globalsSeqLength = 0;
 	for(int i = 0; i < length; i++)
 	{
-		globalsSequence[i] = sequence[i];
+		globals_appendSequenceValue(sequence[i]);
 	}
-	globalsSeqLength = length;
+}
+
+// Empties the sequence, for a new game.
+void globals_clearSequence()
+{
+	globalsSeqLength = 0;
+}
+
+// Adds one value at the end of the sequence. Returns false if the sequence is full.
+bool globals_appendSequenceValue(uint8_t value)
+{
+	if(globalsSeqLength >= GLOBALS_MAX_FLASH_SEQUENCE)
+		return false;
+	uint32_t *word = &globalsSequence[globalsSeqLength / GLOBALS_SEQUENCE_VALUES_PER_WORD];
+	uint8_t shift = globalsSeqLength % GLOBALS_SEQUENCE_VALUES_PER_WORD * GLOBALS_SEQUENCE_BITS_PER_VALUE;
+	*word = (*word & ~(GLOBALS_SEQUENCE_VALUE_MASK << shift)) | (uint32_t) (value & GLOBALS_SEQUENCE_VALUE_MASK) << shift;
+	globalsSeqLength++;
+	return true;
 }
 
 // This returns the value of the sequence at the index.
 uint8_t globals_getSequenceValue(uint16_t index)
 {
-	return globalsSequence[index];
+	return globals_getSequenceWordValue(globalsSequence[index / GLOBALS_SEQUENCE_VALUES_PER_WORD], index);
+}
+
+// Returns the word that holds values 16 * wordIndex to 16 * wordIndex + 15.
+uint32_t globals_getSequenceWord(uint16_t wordIndex)
+{
+	return wordIndex < GLOBALS_SEQUENCE_WORD_COUNT ? globalsSequence[wordIndex] : 0;
 }
 
 // Retrieve the sequence length.
@@ -7,14 +7,39 @@
 #define GLOBALS_MAX_FLASH_SEQUENCE 1000  // Make it big so you can use it for a splash screen.
 #define GLOBALS_TIMER_PERIOD 50.0E-3
 
+// The sequence is stored packed: values are 0-3, 2 bits each, 16 to a 32-bit word, with value
+// 16 * word + i in bits 2i+1:2i of the word. The whole sequence takes a quarter of a byte array.
+#define GLOBALS_SEQUENCE_BITS_PER_VALUE 2
+#define GLOBALS_SEQUENCE_VALUE_MASK 0x3
+#define GLOBALS_SEQUENCE_VALUES_PER_WORD 16
+#define GLOBALS_SEQUENCE_WORD_COUNT \
+	((GLOBALS_MAX_FLASH_SEQUENCE + GLOBALS_SEQUENCE_VALUES_PER_WORD - 1) / GLOBALS_SEQUENCE_VALUES_PER_WORD)
+
 // This is the length of the complete sequence at maximum length.
 // You must copy the contents of the sequence[] array into the global variable that you maintain.
 // Do not just grab the pointer as this will fail.
 void globals_setSequence(const uint8_t sequence[], uint16_t length);
 
+// Empties the sequence, for a new game.
+void globals_clearSequence();
+
+// Adds one value at the end of the sequence, so that a new level costs the same whatever the length.
+// Returns false, leaving the sequence as it is, once it holds GLOBALS_MAX_FLASH_SEQUENCE values.
+bool globals_appendSequenceValue(uint8_t value);
+
 // This returns the value of the sequence at the index.
 uint8_t globals_getSequenceValue(uint16_t index);
 
+// Bulk access: returns the word that holds values 16 * wordIndex to 16 * wordIndex + 15, so that a
+// walk through the sequence takes one call per 16 values. Slots past the sequence length are undefined.
+uint32_t globals_getSequenceWord(uint16_t wordIndex);
+
+// The value at index, out of the word globals_getSequenceWord() returned for it.
+static inline uint8_t globals_getSequenceWordValue(uint32_t word, uint16_t index)
+{
+	return (word >> (index % GLOBALS_SEQUENCE_VALUES_PER_WORD * GLOBALS_SEQUENCE_BITS_PER_VALUE)) & GLOBALS_SEQUENCE_VALUE_MASK;
+}
+
 // Retrieve the sequence length.
 uint16_t globals_getSequenceLength();
 
@@ -266,7 +266,7 @@ uint32_t intervalTimer_getTotalDurationInSeconds(uint32_t timerNumber, double *s
 	double timerFreq = intervalTimer_getTimerFrequency(timerNumber);
 	double ticks = (double)intervalTimer_getTotalDurationInTicks(timerNumber);
 	*seconds = ticks / timerFreq;
-	return (uint32_t)seconds;
+	return INTERVAL_TIMER_STATUS_OK;
 }
 
 // Helper function to read GPIO registers.
@@ -0,0 +1,377 @@
+#include "scheduler.h"
+#include "globals.h"
+#include "supportFiles/globalTimer.h"
+#include "supportFiles/interrupts.h"
+#include "supportFiles/display.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SCHEDULER_GLOBAL_TIMER_TICKS_PER_US (GLOBAL_TIMER_TICKS_PER_SECOND / 1000000)
+#define SCHEDULER_TICK_PERIOD ((uint64_t) (GLOBALS_TIMER_PERIOD * GLOBAL_TIMER_TICKS_PER_SECOND))
+#define SCHEDULER_MAX_SLEEP GLOBAL_TIMER_TICKS_PER_SECOND  // Keeps the one-shot load value in range.
+#define SCHEDULER_DISPLAY_SLICE ((uint64_t) (DISPLAY_COMMAND_SLICE_SECONDS * GLOBAL_TIMER_TICKS_PER_SECOND))
+
+typedef enum
+{
+	SCHEDULER_RUNNABLE,  // Runs every period.
+	SCHEDULER_IDLE,      // Runs after scheduler_wake().
+	SCHEDULER_SLEEPING,  // Runs at the deadline.
+	SCHEDULER_WAITING    // Runs on an event or at the deadline.
+} scheduler_taskState_t;
+
+typedef struct
+{
+	const char *name;
+	scheduler_tickFunction_t tick;
+	uint16_t period;       // In timer periods.
+	uint16_t ticksUntilDue;
+	scheduler_taskState_t state;
+	uint64_t deadline;
+	uint64_t nextRunTime;  // When a runnable task is due in tickless mode.
+	scheduler_runStatistics_t statistics;
+} scheduler_task_t;
+
+static scheduler_task_t tasks[SCHEDULER_MAX_TASKS];
+static uint8_t taskCount;
+static scheduler_tickStatistics_t tickStatistics;
+static uint32_t sleepCount;
+static u64 totalSleepTime;
+
+// Adds one run to the statistics.
+static void scheduler_recordRun(scheduler_runStatistics_t *statistics, uint64_t runTime)
+{
+	statistics->runCount++;
+	statistics->totalRunTime += runTime;
+	if(runTime > statistics->maxRunTime)
+	{
+		statistics->maxRunTime = runTime;
+	}
+	uint64_t us = runTime / SCHEDULER_GLOBAL_TIMER_TICKS_PER_US;
+	uint8_t bucket = 0;
+	while(us && bucket < SCHEDULER_HISTOGRAM_BUCKETS - 1)
+	{
+		us >>= 1;
+		bucket++;
+	}
+	statistics->histogram[bucket]++;
+}
+
+// Prints one line of statistics, and the histogram buckets that have something in them.
+static void scheduler_printRunStatistics(const char *name, const scheduler_runStatistics_t *statistics)
+{
+	unsigned long averageUs = statistics->runCount ?
+			(unsigned long) (statistics->totalRunTime / statistics->runCount / SCHEDULER_GLOBAL_TIMER_TICKS_PER_US) : 0;
+	printf("  %-16s runs: %lu, total: %lu us, average: %lu us, max: %lu us\n\r", name,
+			(unsigned long) statistics->runCount,
+			(unsigned long) (statistics->totalRunTime / SCHEDULER_GLOBAL_TIMER_TICKS_PER_US), averageUs,
+			(unsigned long) (statistics->maxRunTime / SCHEDULER_GLOBAL_TIMER_TICKS_PER_US));
+	for(uint8_t bucket = 0; bucket < SCHEDULER_HISTOGRAM_BUCKETS; bucket++)
+	{
+		if(!statistics->histogram[bucket])
+		{
+			continue;
+		}
+		unsigned long lowUs = bucket ? 1UL << (bucket - 1) : 0;
+		if(bucket == SCHEDULER_HISTOGRAM_BUCKETS - 1)
+		{
+			printf("    >= %6lu us: %lu\n\r", lowUs, (unsigned long) statistics->histogram[bucket]);
+		}
+		else
+		{
+			printf("    < %7lu us: %lu\n\r", 1UL << bucket, (unsigned long) statistics->histogram[bucket]);
+		}
+	}
+}
+
+// Returns the task with this tick function, or NULL if it was never added.
+static scheduler_task_t *scheduler_findTask(scheduler_tickFunction_t tick)
+{
+	for(uint8_t i = 0; i < taskCount; i++)
+	{
+		if(tasks[i].tick == tick)
+		{
+			return &tasks[i];
+		}
+	}
+	return NULL;
+}
+
+// Parks the task, if it was added.
+static void scheduler_park(scheduler_tickFunction_t tick, scheduler_taskState_t state, uint64_t deadline)
+{
+	scheduler_task_t *task = scheduler_findTask(tick);
+	if(task)
+	{
+		task->state = state;
+		task->deadline = deadline;
+	}
+}
+
+// True if the task has something to do now, apart from its period.
+static bool scheduler_isReady(scheduler_task_t *task, uint64_t now, bool eventPending)
+{
+	switch(task->state)
+	{
+	case SCHEDULER_RUNNABLE:
+		return true;
+	case SCHEDULER_SLEEPING:
+		return now >= task->deadline;
+	case SCHEDULER_WAITING:
+		return eventPending || now >= task->deadline;
+	default:
+		return false;
+	}
+}
+
+// Runs the task once. Returns true if it moved on, i.e. it didn't just go back to waiting for an
+// event: the other waiting tasks may be waiting for exactly that.
+static bool scheduler_runTask(scheduler_task_t *task, uint64_t now)
+{
+	task->state = SCHEDULER_RUNNABLE;  // Unless the tick function parks it again.
+	task->nextRunTime = now + task->period * SCHEDULER_TICK_PERIOD;
+	u64 startTime = globalTimer_getTimerValue();
+	task->tick();
+	scheduler_recordRun(&task->statistics, globalTimer_getTimerValue() - startTime);
+	return task->state != SCHEDULER_WAITING;
+}
+
+// The earliest time at which a task has to run, not counting events.
+static uint64_t scheduler_getNextRunTime()
+{
+	uint64_t nextRunTime = SCHEDULER_NO_DEADLINE;
+	for(uint8_t i = 0; i < taskCount; i++)
+	{
+		scheduler_task_t *task = &tasks[i];
+		uint64_t taskRunTime = task->state == SCHEDULER_RUNNABLE ? task->nextRunTime :
+				task->state == SCHEDULER_IDLE ? SCHEDULER_NO_DEADLINE : task->deadline;
+		if(taskRunTime < nextRunTime)
+		{
+			nextRunTime = taskRunTime;
+		}
+	}
+	return nextRunTime;
+}
+
+// Sleeps until an interrupt, at the latest after duration global timer ticks.
+static void scheduler_sleep(uint64_t duration)
+{
+	uint64_t startTime = scheduler_getTime();
+	interrupts_startArmPrivateTimerOneShot(duration < SCHEDULER_MAX_SLEEP ? duration : SCHEDULER_MAX_SLEEP);
+	interrupts_waitForInterrupt();
+	sleepCount++;
+	totalSleepTime += scheduler_getTime() - startTime;
+}
+
+// Clears the task table and the statistics.
+void scheduler_init()
+{
+	taskCount = 0;
+	scheduler_resetStatistics();
+	globalTimer_startTimer(false);  // Times the tasks and the deadlines.
+}
+
+// Adds a task. Returns its number or SCHEDULER_INVALID_TASK.
+int8_t scheduler_addTask(const char *name, scheduler_tickFunction_t tick, uint16_t periodInTicks, bool idleUntilWoken)
+{
+	if(taskCount == SCHEDULER_MAX_TASKS || !tick || !periodInTicks || scheduler_findTask(tick))
+	{
+		printf("scheduler_addTask: cannot add %s\n\r", name);
+		return SCHEDULER_INVALID_TASK;
+	}
+	scheduler_task_t *task = &tasks[taskCount];
+	task->name = name;
+	task->tick = tick;
+	task->period = periodInTicks;
+	task->ticksUntilDue = 0;  // Due on the first tick.
+	task->state = idleUntilWoken ? SCHEDULER_IDLE : SCHEDULER_RUNNABLE;
+	task->deadline = SCHEDULER_NO_DEADLINE;
+	task->nextRunTime = 0;
+	memset(&task->statistics, 0, sizeof(task->statistics));
+	return taskCount++;
+}
+
+// Time, in global timer ticks.
+uint64_t scheduler_getTime()
+{
+	return globalTimer_getTimerValue();
+}
+
+// The time secondsFromNow from now.
+uint64_t scheduler_getDeadline(double secondsFromNow)
+{
+	return scheduler_getTime() + (uint64_t) (secondsFromNow * GLOBAL_TIMER_TICKS_PER_SECOND);
+}
+
+// True once the time has reached the deadline.
+bool scheduler_isPast(uint64_t deadline)
+{
+	return scheduler_getTime() >= deadline;
+}
+
+// Parks the task until it is woken.
+void scheduler_idle(scheduler_tickFunction_t tick)
+{
+	scheduler_park(tick, SCHEDULER_IDLE, SCHEDULER_NO_DEADLINE);
+}
+
+// Parks the task until the deadline.
+void scheduler_sleepUntil(scheduler_tickFunction_t tick, uint64_t deadline)
+{
+	scheduler_park(tick, SCHEDULER_SLEEPING, deadline);
+}
+
+// Parks the task until an event or the deadline.
+void scheduler_waitForEvent(scheduler_tickFunction_t tick, uint64_t deadline)
+{
+	scheduler_park(tick, SCHEDULER_WAITING, deadline);
+}
+
+// Makes a parked task runnable again.
+void scheduler_wake(scheduler_tickFunction_t tick)
+{
+	scheduler_task_t *task = scheduler_findTask(tick);
+	if(task && task->state != SCHEDULER_RUNNABLE)
+	{
+		task->state = SCHEDULER_RUNNABLE;
+		task->nextRunTime = 0;  // Right away in tickless mode.
+	}
+}
+
+// Runs every due, runnable task once.
+void scheduler_tick()
+{
+	uint64_t startTime = scheduler_getTime();
+	if(tickStatistics.body.runCount)
+	{
+		// Round, so that jitter doesn't count. Anything more than a period late is a lost tick.
+		uint64_t periods = (startTime - tickStatistics.lastStartTime + SCHEDULER_TICK_PERIOD / 2) / SCHEDULER_TICK_PERIOD;
+		if(periods > 1)
+		{
+			tickStatistics.missedCount += periods - 1;
+		}
+	}
+	tickStatistics.lastStartTime = startTime;
+	for(uint8_t i = 0; i < taskCount; i++)
+	{
+		scheduler_task_t *task = &tasks[i];
+		// The period keeps counting while a task is parked, so waking it doesn't shift its phase.
+		bool due = task->ticksUntilDue == 0;
+		task->ticksUntilDue = due ? task->period - 1 : task->ticksUntilDue - 1;
+		uint64_t now = scheduler_getTime();
+		if(due && scheduler_isReady(task, now, true))
+		{
+			scheduler_runTask(task, now);
+		}
+	}
+	tickStatistics.lastEndTime = scheduler_getTime();
+	uint64_t bodyTime = tickStatistics.lastEndTime - startTime;
+	scheduler_recordRun(&tickStatistics.body, bodyTime);
+	if(bodyTime > SCHEDULER_TICK_PERIOD)
+	{
+		tickStatistics.overrunCount++;
+		if(bodyTime - SCHEDULER_TICK_PERIOD > tickStatistics.maxOverrun)
+		{
+			tickStatistics.maxOverrun = bodyTime - SCHEDULER_TICK_PERIOD;
+		}
+	}
+}
+
+// Runs the tasks without a periodic tick until endTime.
+void scheduler_runTickless(uint64_t endTime)
+{
+	uint32_t deviceIsrCount = interrupts_deviceIsrInvocationCount();
+	bool eventPending = true;  // Let every waiting task look at its inputs once.
+	while(!scheduler_isPast(endTime))
+	{
+		bool movedOn = false;
+		for(uint8_t i = 0; i < taskCount; i++)
+		{
+			scheduler_task_t *task = &tasks[i];
+			uint64_t now = scheduler_getTime();
+			bool due = task->state != SCHEDULER_RUNNABLE || now >= task->nextRunTime;
+			if(due && scheduler_isReady(task, now, eventPending))
+			{
+				movedOn |= scheduler_runTask(task, now);
+			}
+		}
+		eventPending = movedOn;
+		// Idle time goes to queued drawing, a slice at a time, so that a deadline or a touch waits
+		// for one slice at most. The core only sleeps once the queue is empty.
+		if(!eventPending && display_hasQueuedCommands())
+		{
+			uint64_t sliceEnd = scheduler_getTime() + SCHEDULER_DISPLAY_SLICE;
+			uint64_t wakeTime = scheduler_getNextRunTime();
+			wakeTime = wakeTime < endTime ? wakeTime : endTime;
+			display_drainCommands(sliceEnd < wakeTime ? sliceEnd : wakeTime);
+		}
+		// With the interrupts off, nothing can arrive between this last look and the WFI.
+		interrupts_disableArmInts();
+		uint32_t count = interrupts_deviceIsrInvocationCount();
+		if(count != deviceIsrCount)
+		{
+			deviceIsrCount = count;
+			eventPending = true;
+		}
+		uint64_t now = scheduler_getTime();
+		uint64_t wakeTime = scheduler_getNextRunTime();
+		wakeTime = wakeTime < endTime ? wakeTime : endTime;
+		if(!eventPending && !display_hasQueuedCommands() && wakeTime > now)
+		{
+			scheduler_sleep(wakeTime - now);
+		}
+		interrupts_enableArmInts();
+	}
+}
+
+// Copies a task's statistics.
+bool scheduler_getTaskStatistics(uint8_t taskNumber, const char **name, scheduler_runStatistics_t *statistics)
+{
+	if(taskNumber >= taskCount)
+	{
+		return false;
+	}
+	*name = tasks[taskNumber].name;
+	*statistics = tasks[taskNumber].statistics;
+	return true;
+}
+
+// Copies the tick statistics.
+void scheduler_getTickStatistics(scheduler_tickStatistics_t *statistics)
+{
+	*statistics = tickStatistics;
+}
+
+// Starts all of the statistics, including the timer ISR latency, over.
+void scheduler_resetStatistics()
+{
+	for(uint8_t i = 0; i < taskCount; i++)
+	{
+		memset(&tasks[i].statistics, 0, sizeof(tasks[i].statistics));
+	}
+	memset(&tickStatistics, 0, sizeof(tickStatistics));
+	sleepCount = 0;
+	totalSleepTime = 0;
+	interrupts_resetTimerIsrLatency();
+}
+
+// Prints the tick, task and timer ISR latency statistics.
+void scheduler_printStatistics()
+{
+	printf("scheduler: %lu ticks, %lu overruns (worst by %lu us), %lu missed; %lu sleeps, %lu ms asleep\n\r",
+			(unsigned long) tickStatistics.body.runCount, (unsigned long) tickStatistics.overrunCount,
+			(unsigned long) (tickStatistics.maxOverrun / SCHEDULER_GLOBAL_TIMER_TICKS_PER_US),
+			(unsigned long) tickStatistics.missedCount, (unsigned long) sleepCount,
+			(unsigned long) (totalSleepTime / (SCHEDULER_GLOBAL_TIMER_TICKS_PER_US * 1000)));
+	if(tickStatistics.body.runCount)
+	{
+		scheduler_printRunStatistics("tick", &tickStatistics.body);
+	}
+	for(uint8_t i = 0; i < taskCount; i++)
+	{
+		scheduler_printRunStatistics(tasks[i].name, &tasks[i].statistics);
+	}
+	printf("timer isr latency: %lu interrupts, average: %lu us, max: %lu us\n\r",
+			(unsigned long) interrupts_getTimerIsrLatencyCount(),
+			(unsigned long) (interrupts_getAverageTimerIsrLatency() / SCHEDULER_GLOBAL_TIMER_TICKS_PER_US),
+			(unsigned long) (interrupts_getMaxTimerIsrLatency() / SCHEDULER_GLOBAL_TIMER_TICKS_PER_US));
+}
@@ -0,0 +1,93 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+// Cooperative scheduler for the tick-based state machines. Each machine registers its tick
+// function once. The scheduler then runs it in one of two modes:
+//  - scheduler_tick(), called once per timer period, runs every task that is due, in the order
+//    the tasks were added.
+//  - scheduler_runTickless() has no periodic tick. It runs the tasks whose deadline has passed or
+//    whose input has arrived and sleeps in WFI, on a one-shot private timer, until the next one.
+//    The time in between first goes to queued drawing (display_setQueuedMode()).
+//
+// While a machine stays in a state it tells the scheduler what it is waiting for:
+//  - scheduler_idle(): an enable or a disable. Its enable()/disable() call scheduler_wake().
+//  - scheduler_sleepUntil(): a deadline.
+//  - scheduler_waitForEvent(): an input (touch), or another machine moving on, or a deadline.
+// A task that doesn't call any of these runs again after its period. Make the calls only in the
+// branch that stays in the state, so that the machine gets another run after a transition.
+// All of these do nothing for a tick function that was never added, so the *_runTest()
+// routines can still tick machines by hand.
+
+#define SCHEDULER_MAX_TASKS 8
+#define SCHEDULER_INVALID_TASK -1
+#define SCHEDULER_NO_DEADLINE UINT64_MAX
+// Run time histogram buckets: under 1 us, then [1, 2) us, [2, 4) us ... [262144, 524288) us, and
+// the last one is open-ended. That reaches ten timer periods, so overruns get their own buckets.
+#define SCHEDULER_HISTOGRAM_BUCKETS 21
+
+typedef void (*scheduler_tickFunction_t)();
+
+// Run times are in global timer ticks (GLOBAL_TIMER_TICKS_PER_SECOND).
+typedef struct
+{
+	uint32_t runCount;
+	uint64_t totalRunTime;
+	uint64_t maxRunTime;
+	uint32_t histogram[SCHEDULER_HISTOGRAM_BUCKETS];
+} scheduler_runStatistics_t;
+
+// The body of scheduler_tick(), i.e. all of the tasks that ran on one tick.
+typedef struct
+{
+	scheduler_runStatistics_t body;
+	uint32_t overrunCount;    // Bodies that took longer than the timer period.
+	uint64_t maxOverrun;      // By how much the worst one did.
+	uint32_t missedCount;     // Periods that went by without a tick, e.g. two timer interrupts for one tick.
+	uint64_t lastStartTime;   // Stamps of the most recent tick.
+	uint64_t lastEndTime;
+} scheduler_tickStatistics_t;
+
+// Clears the task table and the statistics.
+void scheduler_init();
+
+// Adds a task that runs every periodInTicks timer periods. If idleUntilWoken is true, the task
+// starts parked and first runs after scheduler_wake(). Returns the task number, or
+// SCHEDULER_INVALID_TASK if the table is full or the arguments are bad.
+int8_t scheduler_addTask(const char *name, scheduler_tickFunction_t tick, uint16_t periodInTicks, bool idleUntilWoken);
+
+// Time, in global timer ticks. Deadlines are absolute times.
+uint64_t scheduler_getTime();
+uint64_t scheduler_getDeadline(double secondsFromNow);
+bool scheduler_isPast(uint64_t deadline);
+
+// Parks the task until scheduler_wake() is called for it.
+void scheduler_idle(scheduler_tickFunction_t tick);
+
+// Parks the task until the deadline, or until scheduler_wake().
+void scheduler_sleepUntil(scheduler_tickFunction_t tick, uint64_t deadline);
+
+// Parks the task until an input arrives, another task moves on, the deadline passes (may be
+// SCHEDULER_NO_DEADLINE) or scheduler_wake(). In tick mode every tick counts as an event.
+void scheduler_waitForEvent(scheduler_tickFunction_t tick, uint64_t deadline);
+
+// Makes a parked task runnable again. It runs on its next due tick.
+void scheduler_wake(scheduler_tickFunction_t tick);
+
+// Tick mode: runs every due, runnable task once and records how long each one took.
+void scheduler_tick();
+
+// Tickless mode: runs the tasks until the time reaches endTime. Inputs must be interrupt driven.
+void scheduler_runTickless(uint64_t endTime);
+
+// Always-on instrumentation, for use at run time. Returns false if there is no such task.
+bool scheduler_getTaskStatistics(uint8_t taskNumber, const char **name, scheduler_runStatistics_t *statistics);
+void scheduler_getTickStatistics(scheduler_tickStatistics_t *statistics);
+void scheduler_resetStatistics();
+
+// Prints the tick, task and timer ISR latency statistics, with the run time histograms.
+void scheduler_printStatistics();
+
+#endif /* SCHEDULER_H_ */
@@ -2,7 +2,6 @@
 #include "stdlib.h"
 #include "supportFiles/display.h"
 #include "stdio.h"
-#include "intervalTimer.h"
 #include "flashSequence.h"
 #include "verifySequence.h"
 #include "globals.h"
@@ -10,14 +9,13 @@
 #include "simonDisplay.h"
 #include "supportFiles/utils.h"
 #include "buttonHandler.h"
-
-#define CONGRATS_TIMER_DURATION                 (1 / GLOBALS_TIMER_PERIOD)       // 1s
-#define NEW_LEVEL_TIMOUT_TIMER_DURATION         (5 / GLOBALS_TIMER_PERIOD)       // 5s
-#define DISPLAY_SCORE_TIMER_DURATION            (4 / GLOBALS_TIMER_PERIOD)       // 4s
-#define PAUSE_BEFORE_FLASHING_SEQUENCE_DURATION (500E-3 / GLOBALS_TIMER_PERIOD)  // 500ms
+#include "scheduler.h"
+#include "supportFiles/trace.h"
+#include "supportFiles/prng.h"
 
 #define STARTING_LEVEL_SEQUENCE_LENGTH 4
 #define NEW_LEVEL_INCREMENT_SEQUENCE_AMOUNT 1
+#define MAX_MOVES_PER_LEVEL STARTING_LEVEL_SEQUENCE_LENGTH  // The most moves a level adds.
 
 #define TEXT_HEIGHT 8
 #define TEXT_WIDTH 6
@@ -46,24 +44,39 @@ enum simonControl_states
 
 uint16_t longestSuccessfulSequence;
 
-int32_t congratsTimer;
-int32_t newLevelTimoutTimer;
-int32_t displayScoreTimer;
-int32_t pauseTimer;
+// Deadlines, in scheduler time.
+uint64_t congratsDeadline;
+uint64_t newLevelTimoutDeadline;
+uint64_t displayScoreDeadline;
+uint64_t pauseDeadline;
 
 //Internal functions
 void prepAndEnterState(simonControl_states newState);
 
-void generateRandomSequence(uint16_t sequenceLength)
+// The sequence comes from the prng, seeded once at startup, so a game follows from the seed.
+// Each level only appends its new moves to the sequence in globals, so that a level costs the
+// same whatever its length.
+void extendRandomSequence(uint16_t count)
 {
-	uint8_t sequence[GLOBALS_MAX_FLASH_SEQUENCE];
-	intervalTimer_stop(0);
-	srand(intervalTimer_getDurationInTicks(0));
-	for(int i = 0; i < sequenceLength; i++)
+	uint8_t moves[MAX_MOVES_PER_LEVEL];
+	while(count)
 	{
-		sequence[i] = rand() / (RAND_MAX / SIMON_DISPLAY_NUMBER_OF_REGIONS);
+		uint16_t chunk = count < MAX_MOVES_PER_LEVEL ? count : MAX_MOVES_PER_LEVEL;
+		prng_generate(moves, chunk, SIMON_DISPLAY_NUMBER_OF_REGIONS);
+		for(uint16_t i = 0; i < chunk; i++)
+		{
+			if(!globals_appendSequenceValue(moves[i]))
+				return;
+		}
+		count -= chunk;
 	}
-	globals_setSequence(sequence, sequenceLength);
+}
+
+// Starts a new game's sequence.
+void startRandomSequence(uint16_t length)
+{
+	globals_clearSequence();
+	extendRandomSequence(length);
 }
 
 // Centers text at a certain height. Returns the vertical position of the next line.
@@ -110,6 +123,19 @@ void displayScore(bool erase)
 	currentlyDisplayedMessage = erase ? MESSAGE_NONE : MESSAGE_DISPLAY_SCORE;
 }
 
+// True if a new touch has started since the last call. Moves and releases are of no interest here.
+bool touchStarted()
+{
+	bool started = false;
+	display_touchEvent_t event;
+	while(display_getTouchEvent(&event))
+	{
+		if(event.type == DISPLAY_TOUCH_DOWN)
+			started = true;
+	}
+	return started;
+}
+
 void eraseMessage()
 {
 	switch(currentlyDisplayedMessage)
@@ -138,20 +164,16 @@ void simonControl_tick()
 	case wait_for_release_st:
 		break;
 	case pause_before_flash_st:
-		pauseTimer++;
 		break;
 	case flash_sequence_st:
 		break;
 	case verify_sequence_st:
 		break;
 	case congrats_st:
-		congratsTimer++;
 		break;
 	case touch_for_new_level_st:
-		newLevelTimoutTimer++;
 		break;
 	case display_score_st:
-		displayScoreTimer++;
 		break;
 	}
 
@@ -159,19 +181,22 @@ void simonControl_tick()
 	switch (simonControl_state)
 	{
 	case initial_st:
-		intervalTimer_init(0);
 		prepAndEnterState(touch_to_start_st);
 		break;
 	case touch_to_start_st:
-		if(display_isTouched())
+		if(touchStarted())
 		{
 			printf("Touched\r\n");
 			//Init beginning level
 			longestSuccessfulSequence = 0;
-			generateRandomSequence(STARTING_LEVEL_SEQUENCE_LENGTH);
+			startRandomSequence(STARTING_LEVEL_SEQUENCE_LENGTH);
 			globals_setSequenceIterationLength(0);
 			prepAndEnterState(wait_for_release_st);
 		}
+		else
+		{
+			scheduler_waitForEvent(simonControl_tick, SCHEDULER_NO_DEADLINE);
+		}
 		break;
 	case wait_for_release_st:
 		if(!display_isTouched())
@@ -179,13 +204,21 @@ void simonControl_tick()
 			printf("Released - Blank screen\r\n");
 			prepAndEnterState(pause_before_flash_st);
 		}
+		else
+		{
+			scheduler_waitForEvent(simonControl_tick, SCHEDULER_NO_DEADLINE);
+		}
 		break;
 	case pause_before_flash_st:
-		if(pauseTimer > PAUSE_BEFORE_FLASHING_SEQUENCE_DURATION)
+		if(scheduler_isPast(pauseDeadline))
 		{
 			printf("Flashing sequence\r\n");
 			prepAndEnterState(flash_sequence_st);
 		}
+		else
+		{
+			scheduler_sleepUntil(simonControl_tick, pauseDeadline);
+		}
 		break;
 	case flash_sequence_st:
 		if(flashSequence_completed())
@@ -194,6 +227,10 @@ void simonControl_tick()
 			printf("   Blank screen\r\n");
 			prepAndEnterState(verify_sequence_st);
 		}
+		else
+		{
+			scheduler_waitForEvent(simonControl_tick, SCHEDULER_NO_DEADLINE);
+		}
 		break;
 	case verify_sequence_st:
 		if(verifySequence_isComplete())
@@ -217,31 +254,47 @@ void simonControl_tick()
 				prepAndEnterState(wait_for_release_st);
 			}
 		}
+		else
+		{
+			scheduler_waitForEvent(simonControl_tick, SCHEDULER_NO_DEADLINE);
+		}
 		break;
 	case congrats_st:
-		if(congratsTimer == CONGRATS_TIMER_DURATION)
+		if(scheduler_isPast(congratsDeadline))
 		{
 			prepAndEnterState(touch_for_new_level_st);
 		}
+		else
+		{
+			scheduler_sleepUntil(simonControl_tick, congratsDeadline);
+		}
 		break;
 	case touch_for_new_level_st:
-		if(display_isTouched())
+		if(touchStarted())
 		{
-			generateRandomSequence(globals_getSequenceLength() + NEW_LEVEL_INCREMENT_SEQUENCE_AMOUNT);
+			extendRandomSequence(NEW_LEVEL_INCREMENT_SEQUENCE_AMOUNT);
 			globals_setSequenceIterationLength(0);
 			prepAndEnterState(wait_for_release_st);
 		}
-		else if(newLevelTimoutTimer == NEW_LEVEL_TIMOUT_TIMER_DURATION)
+		else if(scheduler_isPast(newLevelTimoutDeadline))
 		{
 			printf("Timeout - display score\r\n");
 			prepAndEnterState(display_score_st);
 		}
+		else
+		{
+			scheduler_waitForEvent(simonControl_tick, newLevelTimoutDeadline);
+		}
 		break;
 	case display_score_st:
-		if(displayScoreTimer == DISPLAY_SCORE_TIMER_DURATION)
+		if(scheduler_isPast(displayScoreDeadline))
 		{
 			prepAndEnterState(touch_to_start_st);
 		}
+		else
+		{
+			scheduler_sleepUntil(simonControl_tick, displayScoreDeadline);
+		}
 		break;
 	}
 }
@@ -256,15 +309,14 @@ void prepAndEnterState(simonControl_states newState)
 	case touch_to_start_st:
 		eraseMessage();
 		showIntroScreen(false);
-		intervalTimer_reset(0);
-		intervalTimer_start(0);
+		display_clearOldTouchData();  // Only a touch made on this screen starts the game.
 		break;
 	case wait_for_release_st:
 		globals_setSequenceIterationLength(globals_getSequenceIterationLength() + 1);
 		break;
 	case pause_before_flash_st:
 		eraseMessage();
-		pauseTimer = 0;
+		pauseDeadline = scheduler_getDeadline(SIMONCONTROL_PAUSE_BEFORE_FLASHING_SEQUENCE_DURATION);
 		break;
 	case flash_sequence_st:
 		simonDisplay_eraseAllButtons();
@@ -279,37 +331,45 @@ void prepAndEnterState(simonControl_states newState)
 		simonDisplay_eraseAllButtons();
 		longestSuccessfulSequence = globals_getSequenceLength();
 		congratulateUser(false);
-		congratsTimer = 0;
+		congratsDeadline = scheduler_getDeadline(SIMONCONTROL_CONGRATS_TIMER_DURATION);
 		break;
 	case touch_for_new_level_st:
 		eraseMessage();
 		touchForNewLevel(false);
-		intervalTimer_reset(0);
-		intervalTimer_start(0);
-		newLevelTimoutTimer = 0;
+		display_clearOldTouchData();
+		newLevelTimoutDeadline = scheduler_getDeadline(SIMONCONTROL_NEW_LEVEL_TIMOUT_TIMER_DURATION);
 		break;
 	case display_score_st:
 		simonDisplay_eraseAllButtons();
 		eraseMessage();
 		displayScore(false);
-		displayScoreTimer = 0;
+		displayScoreDeadline = scheduler_getDeadline(SIMONCONTROL_DISPLAY_SCORE_TIMER_DURATION);
 		break;
 	}
+	trace_transition(TRACE_SOURCE_SIMON_CONTROL, simonControl_state, newState, globals_getSequenceIterationLength());
 	simonControl_state = newState;
 }
 
+// Adds the game's state machines to the scheduler. The others idle until simonControl enables them.
+void simonControl_addTasks()
+{
+	scheduler_addTask("simonControl", simonControl_tick, 1, false);
+	scheduler_addTask("buttonHandler", buttonHandler_tick, 1, true);
+	scheduler_addTask("verifySequence", verifySequence_tick, 1, true);
+	scheduler_addTask("flashSequence", flashSequence_tick, 1, true);
+}
+
 void simonControl_test()
 {
 	display_init();	// We are using the display.
 	display_fillScreen(DISPLAY_BLACK);	// Clear the display.
 
+	scheduler_init();
+	simonControl_addTasks();
 	while(true)
 	{
 		utils_msDelay(GLOBALS_TIMER_PERIOD);
-		simonControl_tick();
-		buttonHandler_tick();
-		verifySequence_tick();
-		flashSequence_tick();
+		scheduler_tick();
 	}
 }
 
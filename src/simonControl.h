@@ -1,7 +1,15 @@
 #ifndef SIMONCONTROL_H_
 #define SIMONCONTROL_H_
 
+// How long the game waits in each of its timed states.
+#define SIMONCONTROL_CONGRATS_TIMER_DURATION                 1       // 1s
+#define SIMONCONTROL_NEW_LEVEL_TIMOUT_TIMER_DURATION         5       // 5s
+#define SIMONCONTROL_DISPLAY_SCORE_TIMER_DURATION            4       // 4s
+#define SIMONCONTROL_PAUSE_BEFORE_FLASHING_SEQUENCE_DURATION 500E-3  // 500ms
+
 void simonControl_tick();
+// Adds simonControl and the state machines it drives to the scheduler, in tick order.
+void simonControl_addTasks();
 void simonControl_test();
 
 #endif
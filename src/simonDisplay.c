@@ -15,6 +15,22 @@ int8_t simonDisplay_computeRegionNumber(int16_t x, int16_t y)
 	return (y > display_height() / 2) * 2 + (x > display_width() / 2);
 }
 
+// The two boundaries above, in raw touch space. Recomputed whenever the calibration changes.
+int8_t simonDisplay_computeRegionNumberRaw(int16_t rawX, int16_t rawY)
+{
+	static display_touchLine_t columnLine, rowLine;
+	static uint32_t calibrationVersion;
+	static bool linesComputed = false;
+	if(!linesComputed || calibrationVersion != display_getTouchCalibrationVersion())
+	{
+		calibrationVersion = display_getTouchCalibrationVersion();
+		display_getTouchLineForColumn(display_width() / 2, &columnLine);
+		display_getTouchLineForRow(display_height() / 2, &rowLine);
+		linesComputed = true;
+	}
+	return display_isPastTouchLine(&rowLine, rawX, rawY) * 2 + display_isPastTouchLine(&columnLine, rawX, rawY);
+}
+
 uint16_t getRegionColor(uint8_t regionNo)
 {
 	switch(regionNo)
@@ -39,6 +39,10 @@
 
 int8_t simonDisplay_computeRegionNumber(int16_t x, int16_t y);
 
+// Same regions, but for raw touch-controller coordinates (display_touchEvent_t rawX/rawY).
+// The region boundaries are kept as lines in raw space, so this takes no coordinate mapping.
+int8_t simonDisplay_computeRegionNumberRaw(int16_t rawX, int16_t rawY);
+
 // Draws a colored "button" that the user can touch.
 // The colored button is centered in the region but does not fill the region.
 void simonDisplay_drawButton(uint8_t regionNumber);
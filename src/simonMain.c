@@ -10,6 +10,9 @@
 #include "stdio.h"
 #include "globals.h"
 #include "intervalTimer.h"
+#include "scheduler.h"
+#include "supportFiles/trace.h"
+#include "supportFiles/prng.h"
 
 #define TOTAL_SECONDS 120
 // The formula for computing the load value is based upon the formula from 4.1.1 (calculating timer intervals)
@@ -32,6 +35,8 @@ int main()
 	interrupts_setPrivateTimerLoadValue(TIMER_LOAD_VALUE);
 	u32 privateTimerTicksPerSecond = interrupts_getPrivateTimerTicksPerSecond();
 	printf("private timer ticks per second: %ld\n\r", privateTimerTicksPerSecond);
+	// The games follow from the seed. On the host, HOSTSIM_SEED=<seed> plays them again.
+	printf("seed: %lu\n\r", (unsigned long) prng_seedFromNoise());
 
 	// Allow the timer to generate interrupts.
 	interrupts_enableTimerGlobalInts();
@@ -39,38 +44,63 @@ int main()
 	// Initialization of the display is not time-dependent, do it outside of the state machine.
 	display_init();
 	display_fillScreen(DISPLAY_BLACK); // This takes 165 ms, so we shouldn't do it inside the loop.
+	// From here on the machines only queue their drawing. It is done between their runs, so a
+	// large fill doesn't hold up a tick.
+	display_setQueuedMode(true);
+	// Let the touch controller interrupt fill the touch-event queue (polled if the hardware has no touch interrupt).
+	interrupts_enableSpiGlobalInts();
+	// Touches only wake a sleeping core if they interrupt. Without that, tick like before.
+	bool tickless = interrupts_enableTouchGlobalInts() == 0;
+
+	// The scheduler runs the state machines and times each one.
+	scheduler_init();
+	simonControl_addTasks();
 
 	// Keep track of your personal interrupt count. Want to make sure that you don't miss any interrupts.
 	 int32_t personalInterruptCount = 0;
-	// Start the private ARM timer running.
-
-	 interrupts_startArmPrivateTimer();
-	// Enable interrupts at the ARM.
-	interrupts_enableArmInts();
-
-	intervalTimer_init(1); // To test tick duration
-	double seconds;
 
-	// interrupts_isrInvocationCount() returns the number of times that the timer ISR was invoked.
-	// This value is maintained by the timer ISR. Compare this number with your own local
-	// interrupt count to determine if you have missed any interrupts.
-	while (interrupts_isrInvocationCount() < (TOTAL_SECONDS * privateTimerTicksPerSecond))
+	if (tickless)
 	{
-		if (interrupts_isrFlagGlobal)  // This is a global flag that is set by the timer interrupt handler.
+		// The machines run at their deadlines and on touches. In between, the core sleeps.
+		printf("tickless\n\r");
+		interrupts_enableArmInts();
+		scheduler_runTickless(scheduler_getDeadline(TOTAL_SECONDS));
+	}
+	else
+	{
+		// Start the private ARM timer running.
+		interrupts_startArmPrivateTimer();
+		// Enable interrupts at the ARM.
+		interrupts_enableArmInts();
+
+		// interrupts_isrInvocationCount() returns the number of times that the timer ISR was invoked.
+		// This value is maintained by the timer ISR. Compare this number with your own local
+		// interrupt count to determine if you have missed any interrupts.
+		while (interrupts_isrInvocationCount() < (TOTAL_SECONDS * privateTimerTicksPerSecond))
 		{
-			// Count ticks.
-			personalInterruptCount++;
+			if (interrupts_isrFlagGlobal)  // This is a global flag that is set by the timer interrupt handler.
+			{
+				// Count ticks.
+				personalInterruptCount++;
 
-			simonControl_tick();
-			buttonHandler_tick();
-			verifySequence_tick();
-			flashSequence_tick();
+				scheduler_tick();
 
-			interrupts_isrFlagGlobal = 0;
+				interrupts_isrFlagGlobal = 0;
+			}
+			else if (display_hasQueuedCommands())
+			{
+				// Between ticks, draw what the machines queued, a slice at a time.
+				display_drainCommands(scheduler_getDeadline(DISPLAY_COMMAND_SLICE_SECONDS));
+			}
 		}
 	}
 	interrupts_disableArmInts();
+	display_setQueuedMode(false);  // Draws whatever is left.
 	printf("isr invocation count: %ld\n\r", interrupts_isrInvocationCount());
 	printf("internal interrupt count: %ld\n\r", personalInterruptCount);
+	scheduler_printStatistics();
+	// Each stall is a machine that queued more drawing than the queue holds and drew it itself.
+	printf("display queue stalls: %lu\n\r", (unsigned long) display_getCommandQueueStallCount());
+	trace_dump();  // Decode with hostSim/traceDecode.
 	return 0;
 }
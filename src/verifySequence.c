@@ -6,14 +6,14 @@
 #include "supportFiles/utils.h"
 #include "simonDisplay.h"
 #include "buttons.h"
+#include "scheduler.h"
+#include "supportFiles/trace.h"
 
 #define MESSAGE_X 0
 #define MESSAGE_Y (display_width()/4)
 #define MESSAGE_TEXT_SIZE 2
 #define MESSAGE_STARTING_OVER
 
-#define TIMEOUT_DURATION (7 / GLOBALS_TIMER_PERIOD) // 7 s
-
 enum verifySequence_state
 	{initial_st,
 	wait_for_press_st,
@@ -25,17 +25,22 @@ bool complete;
 bool timeOutError;
 bool userInputError;
 static uint16_t index;
+static uint32_t sequenceWord;  // The packed word that holds the value at index (see globals.h).
 
 // Turn on the state machine. Part of the interlock.
 void verifySequence_enable()
 {
 	verifySequence_enabled = true;
+	trace_write(TRACE_SOURCE_VERIFY_SEQUENCE, TRACE_EVENT_ENABLE, verifySequence_state, verifySequence_state, 0);
+	scheduler_wake(verifySequence_tick);
 }
 
 // Turn off the state machine. Part of the interlock.
 void verifySequence_disable()
 {
 	verifySequence_enabled = false;
+	trace_write(TRACE_SOURCE_VERIFY_SEQUENCE, TRACE_EVENT_DISABLE, verifySequence_state, verifySequence_state, 0);
+	scheduler_wake(verifySequence_tick);
 }
 
 // Used to detect if there has been a time-out error.
@@ -59,7 +64,8 @@ bool verifySequence_isComplete()
 // Standard tick function.
 void verifySequence_tick()
 {
-	static int32_t timoutTimer;
+	static uint64_t timeoutDeadline;
+	uint8_t oldState = verifySequence_state;
 
 	// Current state actions
 	switch (verifySequence_state)
@@ -67,7 +73,6 @@ void verifySequence_tick()
 	case initial_st:
 	break;
 	case wait_for_press_st:
-		timoutTimer++;
 	break;
 	case verify_st:
 	break;
@@ -85,10 +90,14 @@ void verifySequence_tick()
 			timeOutError = false;
 			userInputError = false;
 			index = 0;
-			timoutTimer = 0;
+			timeoutDeadline = scheduler_getDeadline(VERIFYSEQUENCE_TIMEOUT_DURATION);  // For the whole sequence.
 			buttonHandler_enable();
 			verifySequence_state = wait_for_press_st;
 		}
+		else
+		{
+			scheduler_idle(verifySequence_tick);  // Nothing to do until enabled.
+		}
 	break;
 	case wait_for_press_st:
 		if(buttonHandler_releaseDetected())
@@ -96,16 +105,23 @@ void verifySequence_tick()
 			buttonHandler_disable();
 			verifySequence_state = verify_st;
 		}
-		if(timoutTimer > TIMEOUT_DURATION)
+		if(scheduler_isPast(timeoutDeadline))
 		{
+			buttonHandler_disable();  // Otherwise it keeps the next touch, e.g. the one that starts a new game.
 			complete = true;
 			timeOutError = true;
 			verifySequence_state = final_st;
 		}
+		if(verifySequence_state == wait_for_press_st)
+		{
+			scheduler_waitForEvent(verifySequence_tick, timeoutDeadline);
+		}
 	break;
 	case verify_st:
 		//Verify next region in sequence
-		if(globals_getSequenceValue(index) == buttonHandler_getRegionNumber())
+		if(index % GLOBALS_SEQUENCE_VALUES_PER_WORD == 0)
+			sequenceWord = globals_getSequenceWord(index / GLOBALS_SEQUENCE_VALUES_PER_WORD);
+		if(globals_getSequenceWordValue(sequenceWord, index) == buttonHandler_getRegionNumber())
 		{
 			index++;
 			if(index < globals_getSequenceIterationLength())
@@ -131,8 +147,13 @@ void verifySequence_tick()
 		{
 			verifySequence_state = initial_st;
 		}
+		else
+		{
+			scheduler_idle(verifySequence_tick);  // Nothing to do until disabled.
+		}
 	break;
 	}
+	trace_transition(TRACE_SOURCE_VERIFY_SEQUENCE, oldState, verifySequence_state, index);
 }
 
 // Prints the instructions that the user should follow when
@@ -10,6 +10,8 @@
 #ifndef VERIFYSEQUENCE_H_
 #define VERIFYSEQUENCE_H_
 
+#define VERIFYSEQUENCE_TIMEOUT_DURATION 7 // s, for the whole sequence.
+
 // State machine will run when enabled.
 void verifySequence_enable();
 
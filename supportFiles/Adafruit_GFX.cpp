@@ -53,6 +53,73 @@ Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h):
   textsize  = 1;
   textcolor = textbgcolor = 0xFFFF;
   wrap      = true;
+  spanCount = 0;
+  spanDepth = 0;
+}
+
+// Starts a batch of spans in one color. Batches nest, so a shape built
+// from other shapes is submitted once, at the end.
+void Adafruit_GFX::beginSpans(uint16_t color) {
+  if(spanDepth++ == 0) {
+    spanColor = color;
+    spanCount = 0;
+  }
+}
+
+// Adds a clipped span, merging it with spans on the same row that it
+// overlaps or touches.
+void Adafruit_GFX::addSpan(int16_t x1, int16_t x2, int16_t y) {
+  if((y < 0) || (y >= _height)) return;
+  if(x1 < 0)       x1 = 0;
+  if(x2 >= _width) x2 = _width - 1;
+  if(x1 > x2)      return;
+
+  // Search from the end: the span to merge with was usually added last.
+  for(int16_t i = spanCount - 1; i >= 0; i--) {
+    if((spans[i].y == y) && (x1 <= spans[i].x2 + 1) && (spans[i].x1 <= x2 + 1)) {
+      if(spans[i].x1 < x1) x1 = spans[i].x1;
+      if(spans[i].x2 > x2) x2 = spans[i].x2;
+      spans[i] = spans[--spanCount];
+      i = spanCount; // The union may now touch a span already checked.
+    }
+  }
+  if(spanCount == GFX_SPAN_COUNT) submitSpans();
+  spans[spanCount].x1 = x1;
+  spans[spanCount].x2 = x2;
+  spans[spanCount].y  = y;
+  spanCount++;
+}
+
+void Adafruit_GFX::endSpans(void) {
+  if(--spanDepth == 0) submitSpans();
+}
+
+// Orders spans by row, then column.
+static int compareSpans(const void *a, const void *b) {
+  const int16_t *sa = (const int16_t *)a, *sb = (const int16_t *)b;
+  if(sa[2] != sb[2]) return sa[2] - sb[2]; // y
+  return sa[0] - sb[0];                    // x1
+}
+
+// Sends the batch to fillRect(). Spans are sorted by row so that a span
+// on the next row with the same extent is found just ahead; it is folded
+// into the current rectangle and marked used (x2 < x1).
+void Adafruit_GFX::submitSpans(void) {
+  qsort(spans, spanCount, sizeof(span), compareSpans);
+  for(uint16_t i = 0; i < spanCount; i++) {
+    if(spans[i].x2 < spans[i].x1) continue;
+    int16_t bottom = spans[i].y;
+    for(uint16_t j = i + 1; (j < spanCount) && (spans[j].y <= bottom + 1); j++) {
+      if((spans[j].y == bottom + 1) && (spans[j].x1 == spans[i].x1) &&
+         (spans[j].x2 == spans[i].x2)) {
+        spans[j].x2 = spans[j].x1 - 1;
+        bottom++;
+      }
+    }
+    fillRect(spans[i].x1, spans[i].y, spans[i].x2 - spans[i].x1 + 1,
+      bottom - spans[i].y + 1, spanColor);
+  }
+  spanCount = 0;
 }
 
 // Draw a circle outline
@@ -64,10 +131,11 @@ void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r,
   int16_t x = 0;
   int16_t y = r;
 
-  drawPixel(x0  , y0+r, color);
-  drawPixel(x0  , y0-r, color);
-  drawPixel(x0+r, y0  , color);
-  drawPixel(x0-r, y0  , color);
+  beginSpans(color);
+  addSpan(x0  , x0  , y0+r);
+  addSpan(x0  , x0  , y0-r);
+  addSpan(x0+r, x0+r, y0  );
+  addSpan(x0-r, x0-r, y0  );
 
   while (x<y) {
     if (f >= 0) {
@@ -79,15 +147,16 @@ void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r,
     ddF_x += 2;
     f += ddF_x;
   
-    drawPixel(x0 + x, y0 + y, color);
-    drawPixel(x0 - x, y0 + y, color);
-    drawPixel(x0 + x, y0 - y, color);
-    drawPixel(x0 - x, y0 - y, color);
-    drawPixel(x0 + y, y0 + x, color);
-    drawPixel(x0 - y, y0 + x, color);
-    drawPixel(x0 + y, y0 - x, color);
-    drawPixel(x0 - y, y0 - x, color);
+    addSpan(x0 + x, x0 + x, y0 + y);
+    addSpan(x0 - x, x0 - x, y0 + y);
+    addSpan(x0 + x, x0 + x, y0 - y);
+    addSpan(x0 - x, x0 - x, y0 - y);
+    addSpan(x0 + y, x0 + y, y0 + x);
+    addSpan(x0 - y, x0 - y, y0 + x);
+    addSpan(x0 + y, x0 + y, y0 - x);
+    addSpan(x0 - y, x0 - y, y0 - x);
   }
+  endSpans();
 }
 
 void Adafruit_GFX::drawCircleHelper( int16_t x0, int16_t y0,
@@ -98,6 +167,7 @@ void Adafruit_GFX::drawCircleHelper( int16_t x0, int16_t y0,
   int16_t x     = 0;
   int16_t y     = r;
 
+  beginSpans(color);
   while (x<y) {
     if (f >= 0) {
       y--;
@@ -108,31 +178,42 @@ void Adafruit_GFX::drawCircleHelper( int16_t x0, int16_t y0,
     ddF_x += 2;
     f     += ddF_x;
     if (cornername & 0x4) {
-      drawPixel(x0 + x, y0 + y, color);
-      drawPixel(x0 + y, y0 + x, color);
+      addSpan(x0 + x, x0 + x, y0 + y);
+      addSpan(x0 + y, x0 + y, y0 + x);
     } 
     if (cornername & 0x2) {
-      drawPixel(x0 + x, y0 - y, color);
-      drawPixel(x0 + y, y0 - x, color);
+      addSpan(x0 + x, x0 + x, y0 - y);
+      addSpan(x0 + y, x0 + y, y0 - x);
     }
     if (cornername & 0x8) {
-      drawPixel(x0 - y, y0 + x, color);
-      drawPixel(x0 - x, y0 + y, color);
+      addSpan(x0 - y, x0 - y, y0 + x);
+      addSpan(x0 - x, x0 - x, y0 + y);
     }
     if (cornername & 0x1) {
-      drawPixel(x0 - y, y0 - x, color);
-      drawPixel(x0 - x, y0 - y, color);
+      addSpan(x0 - y, x0 - y, y0 - x);
+      addSpan(x0 - x, x0 - x, y0 - y);
     }
   }
+  endSpans();
 }
 
 void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r,
 			      uint16_t color) {
-  drawFastVLine(x0, y0-r, 2*r+1, color);
+  beginSpans(color);
+  addSpan(x0 - r, x0 + r, y0); // Middle row
   fillCircleHelper(x0, y0, r, 3, 0, color);
+  for (int16_t i = 1; i <= r; i++) { // Center column; merges into the rows
+    addSpan(x0, x0, y0 - i);
+    addSpan(x0, x0, y0 + i);
+  }
+  endSpans();
 }
 
-// Used to do circles and roundrects
+// Used to do circles and roundrects. Each quarter is drawn as the rows it
+// covers: for every step of the circle, the rows y0-y and y0+y+delta get
+// columns 1..x to the side of x0, and the rows y0-x and y0+x+delta get
+// columns 1..y. Together these cover the same pixels as one vertical line
+// per column. Rows between y0 and y0+delta are left to the caller.
 void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
     uint8_t cornername, int16_t delta, uint16_t color) {
 
@@ -142,6 +223,7 @@ void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
   int16_t x     = 0;
   int16_t y     = r;
 
+  beginSpans(color);
   while (x<y) {
     if (f >= 0) {
       y--;
@@ -152,18 +234,35 @@ void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
     ddF_x += 2;
     f     += ddF_x;
 
-    if (cornername & 0x1) {
-      drawFastVLine(x0+x, y0-y, 2*y+1+delta, color);
-      drawFastVLine(x0+y, y0-x, 2*x+1+delta, color);
+    // A negative delta can leave a column empty (2*h+1+delta <= 0).
+    if (2*y+1+delta > 0) {
+      if (cornername & 0x1) {
+        addSpan(x0+1, x0+x, y0-y);
+        addSpan(x0+1, x0+x, y0+y+delta);
+      }
+      if (cornername & 0x2) {
+        addSpan(x0-x, x0-1, y0-y);
+        addSpan(x0-x, x0-1, y0+y+delta);
+      }
     }
-    if (cornername & 0x2) {
-      drawFastVLine(x0-x, y0-y, 2*y+1+delta, color);
-      drawFastVLine(x0-y, y0-x, 2*x+1+delta, color);
+    if (2*x+1+delta > 0) {
+      if (cornername & 0x1) {
+        addSpan(x0+1, x0+y, y0-x);
+        addSpan(x0+1, x0+y, y0+x+delta);
+      }
+      if (cornername & 0x2) {
+        addSpan(x0-y, x0-1, y0-x);
+        addSpan(x0-y, x0-1, y0+x+delta);
+      }
     }
   }
+  endSpans();
 }
 
 // Bresenham's algorithm - thx wikpedia
+// Pixels are gathered into spans: a shallow line becomes one horizontal
+// run per row, and the single-pixel spans of a steep line are joined into
+// vertical runs when the batch is submitted.
 void Adafruit_GFX::drawLine(int16_t x0, int16_t y0,
 			    int16_t x1, int16_t y1,
 			    uint16_t color) {
@@ -191,18 +290,24 @@ void Adafruit_GFX::drawLine(int16_t x0, int16_t y0,
     ystep = -1;
   }
 
+  beginSpans(color);
+  int16_t runStart = x0;
   for (; x0<=x1; x0++) {
     if (steep) {
-      drawPixel(y0, x0, color);
-    } else {
-      drawPixel(x0, y0, color);
+      addSpan(y0, y0, x0);
     }
     err -= dy;
     if (err < 0) {
+      if (!steep) {
+        addSpan(runStart, x0, y0);
+        runStart = x0 + 1;
+      }
       y0 += ystep;
       err += dx;
     }
   }
+  if (!steep && (runStart <= x1)) addSpan(runStart, x1, y0);
+  endSpans();
 }
 
 // Draw a rectangle
@@ -215,16 +320,21 @@ void Adafruit_GFX::drawRect(int16_t x, int16_t y,
   drawFastVLine(x+w-1, y, h, color);
 }
 
+// drawLine() goes through fillRect(), so these must not use drawLine().
 void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y,
 				 int16_t h, uint16_t color) {
   // Update in subclasses if desired!
-  drawLine(x, y, x, y+h-1, color);
+  for (int16_t j=y; j<y+h; j++) {
+    drawPixel(x, j, color);
+  }
 }
 
 void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y,
 				 int16_t w, uint16_t color) {
   // Update in subclasses if desired!
-  drawLine(x, y, x+w-1, y, color);
+  for (int16_t i=x; i<x+w; i++) {
+    drawPixel(i, y, color);
+  }
 }
 
 void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
@@ -243,35 +353,46 @@ void Adafruit_GFX::fillScreen(uint16_t color) {
 void Adafruit_GFX::drawRoundRect(int16_t x, int16_t y, int16_t w,
   int16_t h, int16_t r, uint16_t color) {
   // smarter version
-  drawFastHLine(x+r  , y    , w-2*r, color); // Top
-  drawFastHLine(x+r  , y+h-1, w-2*r, color); // Bottom
   drawFastVLine(x    , y+r  , h-2*r, color); // Left
   drawFastVLine(x+w-1, y+r  , h-2*r, color); // Right
+  beginSpans(color);
+  addSpan(x+r, x+w-r-1, y    ); // Top
+  addSpan(x+r, x+w-r-1, y+h-1); // Bottom
   // draw four corners
   drawCircleHelper(x+r    , y+r    , r, 1, color);
   drawCircleHelper(x+w-r-1, y+r    , r, 2, color);
   drawCircleHelper(x+w-r-1, y+h-r-1, r, 4, color);
   drawCircleHelper(x+r    , y+h-r-1, r, 8, color);
+  endSpans();
 }
 
 // Fill a rounded rectangle
 void Adafruit_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w,
 				 int16_t h, int16_t r, uint16_t color) {
-  // smarter version
-  fillRect(x+r, y, w-2*r, h, color);
-
+  // smarter version: the band between the corners is one rectangle, the
+  // rest is the top and bottom rows of the corners.
+  fillRect(x, y+r, w, h-2*r, color);
+
+  beginSpans(color);
+  for (int16_t i=y; i<y+r; i++) { // Rows above and below the band
+    addSpan(x+r, x+w-r-1, i);
+    addSpan(x+r, x+w-r-1, y+h-1-(i-y));
+  }
   // draw four corners
   fillCircleHelper(x+w-r-1, y+r, r, 1, h-2*r-1, color);
   fillCircleHelper(x+r    , y+r, r, 2, h-2*r-1, color);
+  endSpans();
 }
 
 // Draw a triangle
 void Adafruit_GFX::drawTriangle(int16_t x0, int16_t y0,
 				int16_t x1, int16_t y1,
 				int16_t x2, int16_t y2, uint16_t color) {
+  beginSpans(color);
   drawLine(x0, y0, x1, y1, color);
   drawLine(x1, y1, x2, y2, color);
   drawLine(x2, y2, x0, y0, color);
+  endSpans();
 }
 
 // Fill a triangle
@@ -302,6 +423,7 @@ void Adafruit_GFX::fillTriangle ( int16_t x0, int16_t y0,
     return;
   }
 
+  beginSpans(color);
   int16_t
     dx01 = x1 - x0,
     dy01 = y1 - y0,
@@ -331,7 +453,7 @@ void Adafruit_GFX::fillTriangle ( int16_t x0, int16_t y0,
     b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
     */
     if(a > b) swap(a,b);
-    drawFastHLine(a, y, b-a+1, color);
+    addSpan(a, b, y);
   }
 
   // For lower part of triangle, find scanline crossings for segments
@@ -348,8 +470,9 @@ void Adafruit_GFX::fillTriangle ( int16_t x0, int16_t y0,
     b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
     */
     if(a > b) swap(a,b);
-    drawFastHLine(a, y, b-a+1, color);
+    addSpan(a, b, y);
   }
+  endSpans();
 }
 
 void Adafruit_GFX::drawBitmap(int16_t x, int16_t y,
@@ -358,13 +481,16 @@ void Adafruit_GFX::drawBitmap(int16_t x, int16_t y,
 
   int16_t i, j, byteWidth = (w + 7) / 8;
 
+  // Each run of set bits in a row is one span.
+  beginSpans(color);
   for(j=0; j<h; j++) {
     for(i=0; i<w; i++ ) {
       if(pgm_read_byte(bitmap + j * byteWidth + i / 8) & (128 >> (i & 7))) {
-	drawPixel(x+i, y+j, color);
+	addSpan(x+i, x+i, y+j);
       }
     }
   }
+  endSpans();
 }
 
 #if ARDUINO >= 100
@@ -425,6 +551,10 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
   }
 }
 
+uint8_t Adafruit_GFX::glyphColumn(unsigned char c, uint8_t i) {
+  return (i == 5) ? 0 : pgm_read_byte(font+(c*5)+i);
+}
+
 void Adafruit_GFX::setCursor(int16_t x, int16_t y) {
   cursor_x = x;
   cursor_y = y;
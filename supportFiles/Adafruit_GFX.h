@@ -15,6 +15,8 @@
 
 #define swap(a, b) { int16_t t = a; a = b; b = t; }
 
+#define GFX_SPAN_COUNT 256 // Spans held before a batch is submitted early.
+
 class Adafruit_GFX : public Print {
 
  public:
@@ -33,7 +35,9 @@ class Adafruit_GFX : public Print {
     drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color),
     fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color),
     fillScreen(uint16_t color),
-    invertDisplay(bool i);
+    invertDisplay(bool i),
+    drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+      uint16_t bg, uint8_t size);
 
   // These exist only with Adafruit_GFX (no subclass overrides)
   void
@@ -53,8 +57,6 @@ class Adafruit_GFX : public Print {
       int16_t radius, uint16_t color),
     drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
       int16_t w, int16_t h, uint16_t color),
-    drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
-      uint16_t bg, uint8_t size),
     setCursor(int16_t x, int16_t y),
     setTextColor(uint16_t c),
     setTextColor(uint16_t c, uint16_t bg),
@@ -75,6 +77,29 @@ class Adafruit_GFX : public Print {
   uint8_t getRotation(void);
 
  protected:
+  // Span batching. Shapes are rasterized into horizontal spans (x1..x2 on
+  // row y), which are clipped and merged as they are added. When the
+  // outermost endSpans() is reached, spans are submitted to fillRect() with
+  // identical spans on consecutive rows joined into one rectangle.
+  struct span {
+    int16_t x1, x2, y;
+  };
+  void
+    beginSpans(uint16_t color),
+    addSpan(int16_t x1, int16_t x2, int16_t y),
+    endSpans(void),
+    submitSpans(void);
+  span
+    spans[GFX_SPAN_COUNT];
+  uint16_t
+    spanCount, spanColor;
+  uint8_t
+    spanDepth;
+
+  // Column i (0..5) of the font glyph for c, bit 0 at the top. Column 5 is
+  // the blank spacing column.
+  static uint8_t glyphColumn(unsigned char c, uint8_t i);
+
   const int16_t
     WIDTH, HEIGHT;   // This is the 'raw' display w/h - never changes
   int16_t
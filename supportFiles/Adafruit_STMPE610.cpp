@@ -171,13 +171,16 @@ uint16_t Adafruit_STMPE610::getVersion() {
 
 /*****************************/
 
-void Adafruit_STMPE610::readData(int16_t *x, int16_t *y, uint8_t *z) {
-  uint8_t data[4];
+// The FIFO data port doesn't auto-increment, so a single read transaction can stream any
+// number of 4-byte samples out of it: address byte, dummy byte, then the data.
+void Adafruit_STMPE610::beginFifoRead() {
+  uint8_t header[STMPE_SPI_READ_HEADER_SIZE] = {0x80 | STMPE_TSC_DATA_NON_INC, 0x00};
+  beginTransaction();
+  spi_transferBuffer(header, NULL, STMPE_SPI_READ_HEADER_SIZE);
+}
 
-  for (uint8_t i=0; i<4; i++) {
-    data[i] = readRegister8(0xD7); //SPI.transfer(0x00); 0xD7 is non-auto-increment mode.
-   // Serial.print("0x"); Serial.print(data[i], HEX); Serial.print(" / ");
-  }
+// Unpacks one sample: 12-bit X, 12-bit Y, 8-bit Z.
+void Adafruit_STMPE610::unpackFifoSample(const uint8_t *data, int16_t *x, int16_t *y, uint8_t *z) {
   *x = data[0];
   *x <<= 4;
   *x |= (data[1] >> 4);
@@ -185,21 +188,53 @@ void Adafruit_STMPE610::readData(int16_t *x, int16_t *y, uint8_t *z) {
   *y <<= 8;
   *y |= data[2];
   *z = data[3];
+}
+
+void Adafruit_STMPE610::readData(int16_t *x, int16_t *y, uint8_t *z) {
+  uint8_t data[STMPE_FIFO_BYTES_PER_SAMPLE];
+
+  beginFifoRead();
+  spi_transferBuffer(NULL, data, STMPE_FIFO_BYTES_PER_SAMPLE);
+  endTransaction();
+  unpackFifoSample(data, x, y, z);
 
   if (bufferEmpty())
     writeRegister8(STMPE_INT_STA, 0xFF); // reset all ints
 }
 
+// Reads up to maxPoints samples out of the FIFO with one chip select. Returns the number read.
+// Like readData(), resets the interrupt status once the FIFO has been emptied.
+uint8_t Adafruit_STMPE610::readBuffer(TS_Point *points, uint8_t maxPoints) {
+  uint8_t available = bufferSize();
+  uint8_t count = available < maxPoints ? available : maxPoints;
+  if (!count)
+    return 0;
+  beginFifoRead();
+  for (uint8_t i=0; i<count; i+=STMPE_SAMPLES_PER_SPI_BURST) {
+    uint8_t data[STMPE_SAMPLES_PER_SPI_BURST * STMPE_FIFO_BYTES_PER_SAMPLE];
+    uint8_t burst = count - i < STMPE_SAMPLES_PER_SPI_BURST ? count - i : STMPE_SAMPLES_PER_SPI_BURST;
+    spi_transferBuffer(NULL, data, burst * STMPE_FIFO_BYTES_PER_SAMPLE);
+    for (uint8_t j=0; j<burst; j++) {
+      int16_t x, y;
+      uint8_t z;
+      unpackFifoSample(&data[j * STMPE_FIFO_BYTES_PER_SAMPLE], &x, &y, &z);
+      points[i + j] = TS_Point(x, y, z);
+    }
+  }
+  endTransaction();
+
+  if (count == available)
+    writeRegister8(STMPE_INT_STA, 0xFF); // reset all ints
+  return count;
+}
+
 // BLH: I wrote this and it does not seem to work correctly as of yet. (OK, kind of works now).
+// Resets the FIFO rather than reading the old samples out: the same three transactions no
+// matter how much has piled up.
 void Adafruit_STMPE610::clearOldTouchData() {
-  int i;
-  int16_t xDummy, yDummy;
-  uint8_t zDummy;
-  int dataSetSize = bufferSize();
-//  printf("buffer size: %d\n\r", dataSetSize);
-  for (i=0; i<dataSetSize; i++) {
-    readData(&xDummy, &yDummy, &zDummy);  // Just ignore the data.
-  }
+  writeRegister8(STMPE_FIFO_STA, STMPE_FIFO_STA_RESET);
+  writeRegister8(STMPE_FIFO_STA, 0);    // unreset
+  writeRegister8(STMPE_INT_STA, 0xFF); // reset all ints
 }
 
 TS_Point Adafruit_STMPE610::getPoint(void) {
@@ -209,48 +244,25 @@ TS_Point Adafruit_STMPE610::getPoint(void) {
   return TS_Point(x, y, z);
 }
 
-uint8_t Adafruit_STMPE610::spiIn() {
-//  if (_CLK == -1) {
-//#if defined (__AVR__)
-//    SPCRbackup = SPCR;
-//    SPCR = mySPCR;
-//    uint8_t d = SPI.transfer(0);
-//    SPCR = SPCRbackup;
-//    return d;
-//#elif defined (__arm__)
-//    SPI.setClockDivider(84);
-    spi_setClockDivider(84);
-//    SPI.setDataMode(m_spiMode);
-    spi_setBitOrder(SPI_MSBFIRST);  // wasn't included in the original code. added by BLH.8
-    spi_setTransmissionMode(m_spiMode);
-    uint8_t d = spi_transfer(0);
-//    uint8_t d = SPI.transfer(0);
-    return d;
-//#endif
-//  }
-//  else
-//    return shiftIn(_MISO, _CLK, MSBFIRST);
+// Every access to the controller is one SPI transaction: the core is set up for mode and bit
+// order once, then the command and data bytes go through its FIFOs.
+void Adafruit_STMPE610::beginTransaction() {
+  spi_settings_t settings;
+  settings.bitOrder = SPI_MSBFIRST;
+  settings.mode = m_spiMode;
+  spi_beginTransaction(&settings);
+  spi_setTouchScreenControllerSlaveSelect();  // Assert the slave select for the touch-screen controller.
 }
 
-void Adafruit_STMPE610::spiOut(uint8_t x) {
-//  if (_CLK == -1) {
-//#if defined (__AVR__)
-//    SPCRbackup = SPCR;
-//    SPCR = mySPCR;
-//    SPI.transfer(x);
-//    SPCR = SPCRbackup;
-//#elif defined (__arm__)
-//    SPI.setClockDivider(84);
-	spi_setClockDivider(84);
-    spi_setBitOrder(SPI_MSBFIRST);  // wasn't included in the original code. added by BLH.
-//    SPI.setDataMode(m_spiMode);
-	spi_setTransmissionMode(m_spiMode);
-//    SPI.transfer(x);
-	spi_transfer(x);
-//#endif
-//  }
-//  else
-//    shiftOut(_MOSI, _CLK, MSBFIRST, x);
+void Adafruit_STMPE610::endTransaction() {
+  spi_clearAllSlaveSelects();
+  spi_endTransaction();
+}
+
+void Adafruit_STMPE610::initRequest(spi_request_t *request) {
+  request->settings.bitOrder = SPI_MSBFIRST;
+  request->settings.mode = m_spiMode;
+  request->slaveSelectMask = SPI_TOUCH_SCREEN_CONTROLLER_SLAVE_SELECT_MASK;
 }
 
 uint8_t Adafruit_STMPE610::readRegister8(uint8_t reg) {
@@ -269,12 +281,13 @@ uint8_t Adafruit_STMPE610::readRegister8(uint8_t reg) {
 //    //Serial.print(": 0x"); Serial.println(x, HEX);
 //  } else {
 //    digitalWrite(_CS, LOW);
-    spi_setTouchScreenControllerSlaveSelect();  // Assert the slave select for the touch-screen controller.
-    spiOut(0x80 | reg);
-    spiOut(0x00);
-    x = spiIn();
+    uint8_t tx[STMPE_SPI_READ_HEADER_SIZE + 1] = {(uint8_t) (0x80 | reg), 0x00, 0x00};
+    uint8_t rx[STMPE_SPI_READ_HEADER_SIZE + 1];
+    beginTransaction();
+    spi_transferBuffer(tx, rx, sizeof(tx));
+    x = rx[STMPE_SPI_READ_HEADER_SIZE];
 //    digitalWrite(_CS, HIGH);
-    spi_clearAllSlaveSelects();
+    endTransaction();
 //
 //  }
 
@@ -296,14 +309,15 @@ uint16_t Adafruit_STMPE610::readRegister16(uint8_t reg) {
 //  } if (_CLK == -1) {
 //    // hardware SPI
 //    digitalWrite(_CS, LOW);
-      spi_setTouchScreenControllerSlaveSelect();
-      spiOut(0x80 | reg);
-      spiOut(0x00);
-      x = spiIn();
+      uint8_t tx[STMPE_SPI_READ_HEADER_SIZE + 2] = {(uint8_t) (0x80 | reg), 0x00, 0x00, 0x00};
+      uint8_t rx[STMPE_SPI_READ_HEADER_SIZE + 2];
+      beginTransaction();
+      spi_transferBuffer(tx, rx, sizeof(tx));
+      x = rx[STMPE_SPI_READ_HEADER_SIZE];
       x<<=8;
-      x |= spiIn();
+      x |= rx[STMPE_SPI_READ_HEADER_SIZE + 1];
 //    digitalWrite(_CS, HIGH);
-      spi_clearAllSlaveSelects();
+      endTransaction();
 //  }
 //
 //  //Serial.print("$"); Serial.print(reg, HEX);
@@ -320,11 +334,11 @@ void Adafruit_STMPE610::writeRegister8(uint8_t reg, uint8_t val) {
 //    Wire.endTransmission();
 //  } else {
 //    digitalWrite(_CS, LOW);
-	spi_setTouchScreenControllerSlaveSelect();
-    spiOut(reg);
-    spiOut(val);
+    uint8_t tx[2] = {reg, val};
+    beginTransaction();
+    spi_transferBuffer(tx, NULL, sizeof(tx));
 //    digitalWrite(_CS, HIGH);
-    spi_clearAllSlaveSelects();
+    endTransaction();
 //  }
 }
 
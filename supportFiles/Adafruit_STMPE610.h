@@ -19,6 +19,7 @@
   MIT license, all text above must be included in any redistribution
  ****************************************************/
 #include "arduinoTypes.h"
+#include "spi.h"
 #include <stdbool.h>
 
 #define STMPE_ADDR 0x41
@@ -29,6 +30,7 @@
 
 #define STMPE_TSC_CTRL 0x40
 #define STMPE_TSC_CTRL_EN 0x01
+#define STMPE_TSC_CTRL_TOUCH_DET 0x80  // Read-only: the panel is being touched.
 #define STMPE_TSC_CTRL_XYZ 0x00
 #define STMPE_TSC_CTRL_XY 0x02
 
@@ -102,6 +104,11 @@
 
 #define STMPE_TSC_DATA_X 0x4D
 #define STMPE_TSC_DATA_Y 0x4F
+#define STMPE_TSC_DATA_NON_INC 0x57  // FIFO data port, non-auto-increment.
+#define STMPE_FIFO_BYTES_PER_SAMPLE 4
+#define STMPE_SPI_READ_HEADER_SIZE 2   // Address byte plus one dummy byte before read data.
+#define STMPE_SPI_READ 0x80            // Set in the address byte for a read.
+#define STMPE_SAMPLES_PER_SPI_BURST 4  // Samples per spi_transferBuffer() call (fills the SPI FIFO).
 #define STMPE_TSC_FRACTION_Z 0x56
 
 #define STMPE_GPIO_SET_PIN 0x10
@@ -132,6 +139,7 @@ class Adafruit_STMPE610{
   uint16_t readRegister16(uint8_t reg);
   uint8_t readRegister8(uint8_t reg);
   void readData(int16_t *x, int16_t *y, uint8_t *z);
+  uint8_t readBuffer(TS_Point *points, uint8_t maxPoints);  // Burst read of queued samples.
   uint16_t getVersion();
   bool touched(void);
   bool bufferEmpty(void);
@@ -139,9 +147,15 @@ class Adafruit_STMPE610{
   TS_Point getPoint(void);
   void clearOldTouchData();  // Removes all current touch data from the FIFO.
 
+  // Asynchronous access: fills in this controller's SPI settings and chip select. The caller
+  // supplies the bytes (address, then data, or STMPE_SPI_READ | address and a dummy byte).
+  void initRequest(spi_request_t *request);
+  static void unpackFifoSample(const uint8_t *data, int16_t *x, int16_t *y, uint8_t *z);
+
  private:
-  uint8_t spiIn();
-  void spiOut(uint8_t x);
+  void beginTransaction();
+  void endTransaction();
+  void beginFifoRead();
 
   int8_t  _CS, _MOSI, _MISO, _CLK;
   uint8_t _i2caddr;
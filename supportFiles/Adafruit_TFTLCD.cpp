@@ -120,6 +120,9 @@ void Adafruit_TFTLCD::init(void) {
   cursor_y  = cursor_x = 0;
   textsize  = 1;
   textcolor = 0xFFFF;
+  addrWindowKnown = false;
+  frameBuffer = NULL;
+  dirtyCount = 0;
   _width    = TFTWIDTH;
   _height   = TFTHEIGHT;
 }
@@ -257,6 +260,7 @@ void Adafruit_TFTLCD::begin(uint16_t id) {
     driver = ID_9341;
 //     CS_ACTIVE;  // BLH: CS is always asserted.
     writeRegister8(ILI9341_SOFTRESET, 0);
+    addrWindowKnown = false; // Reset puts back the controller's default window.
     LCD_delay(50);
     writeRegister8(ILI9341_DISPLAYOFF, 0);
 
@@ -398,14 +402,23 @@ void Adafruit_TFTLCD::setAddrWindow(int x1, int y1, int x2, int y2) {
   } else if (driver == ID_9341) {
     uint32_t t;
 
+    // The controller keeps the window across commands, so only the halves
+    // that actually change need to be sent.
     t = x1;
     t <<= 16;
     t |= x2;
-    writeRegister32(ILI9341_COLADDRSET, t);
+    if(!addrWindowKnown || (t != addrColumns)) {
+      writeRegister32(ILI9341_COLADDRSET, t);
+      addrColumns = t;
+    }
     t = y1;
     t <<= 16;
     t |= y2;
-    writeRegister32(ILI9341_PAGEADDRSET, t);
+    if(!addrWindowKnown || (t != addrPages)) {
+      writeRegister32(ILI9341_PAGEADDRSET, t);
+      addrPages = t;
+    }
+    addrWindowKnown = true;
 
   }
 //  CS_IDLE;  // BLH: CS is always asserted.
@@ -424,17 +437,10 @@ void Adafruit_TFTLCD::setLR(void) {
 //  CS_IDLE;
 }
 
-// Fast block fill operation for fillScreen, fillRect, H/V line, etc.
-// Requires setAddrWindow() has previously been called to set the fill
-// bounds.  'len' is inclusive, MUST be >= 1.
-void Adafruit_TFTLCD::flood(uint16_t color, uint32_t len) {
-  uint16_t blocks;
-  uint8_t  i, hi = color >> 8,
-              lo = color;
-
-//  CS_ACTIVE;
-//  CD_COMMAND;
-  LCD_setCommandMode();  // BLH
+// Issues the controller's 'write GRAM' command; pixel data may follow
+// directly after it.
+void Adafruit_TFTLCD::beginGramWrite(void) {
+  LCD_setCommandMode();
   if (driver == ID_9341) {
     write8(0x2C);
   } else if (driver == ID_932X) {
@@ -443,47 +449,29 @@ void Adafruit_TFTLCD::flood(uint16_t color, uint32_t len) {
   } else {
     write8(0x22); // Write data to GRAM
   }
+}
 
-  // Write first pixel normally, decrement counter by 1
-//  CD_DATA;
-  LCD_setDataMode();  // BLH
-  write8(hi);
-  write8(lo);
-  len--;
-
-  blocks = (uint16_t)(len / 64); // 64 pixels/block
-  if(hi == lo) {
-    // High and low bytes are identical.  Leave prior data
-    // on the port(s) and just toggle the write strobe.
-    while(blocks--) {
-      i = 16; // 64 pixels/block / 4 pixels/pass
-      do {
-//        WR_STROBE; WR_STROBE; WR_STROBE; WR_STROBE; // 2 bytes/pixel
-//        WR_STROBE; WR_STROBE; WR_STROBE; WR_STROBE; // x 4 pixels
-    	  LCD_strobeWriteLine(); LCD_strobeWriteLine(); LCD_strobeWriteLine(); LCD_strobeWriteLine();
-    	  LCD_strobeWriteLine(); LCD_strobeWriteLine(); LCD_strobeWriteLine(); LCD_strobeWriteLine();
-      } while(--i);
-    }
-    // Fill any remaining pixels (1 to 64)
-    for(i = (uint8_t)len & 63; i--; ) {
-//      WR_STROBE;
-//      WR_STROBE;
-    	LCD_strobeWriteLine(); LCD_strobeWriteLine();
-    }
-  } else {
-    while(blocks--) {
-      i = 16; // 64 pixels/block / 4 pixels/pass
-      do {
-        write8(hi); write8(lo); write8(hi); write8(lo);
-        write8(hi); write8(lo); write8(hi); write8(lo);
-      } while(--i);
-    }
-    for(i = (uint8_t)len & 63; i--; ) {
-      write8(hi);
-      write8(lo);
-    }
-  }
-//  CS_IDLE;
+// Puts back the default address window that drawPixel() relies on after
+// a fill. The 9341 drawPixel() programs its own window, so nothing needs
+// to be restored there.
+void Adafruit_TFTLCD::restoreAddrWindow(void) {
+  if(driver == ID_932X)      setAddrWindow(0, 0, _width - 1, _height - 1);
+  else if(driver == ID_7575) setLR();
+}
+
+// Fast block fill operation for fillScreen, fillRect, H/V line, etc.
+// Requires setAddrWindow() has previously been called to set the fill
+// bounds.  'len' is inclusive, MUST be >= 1.
+void Adafruit_TFTLCD::flood(uint16_t color, uint32_t len) {
+  beginGramWrite();
+  LCD_writeRepeatedPixel(color, len);  // Streams the whole fill in data mode.
+}
+
+// Streams a buffer of RGB565 pixels into the current address window,
+// starting at its top-left corner.
+void Adafruit_TFTLCD::writePixels(const uint16_t *data, uint32_t len) {
+  beginGramWrite();
+  LCD_writePixels(data, len);
 }
 
 void Adafruit_TFTLCD::drawFastHLine(int16_t x, int16_t y, int16_t length,
@@ -505,10 +493,13 @@ void Adafruit_TFTLCD::drawFastHLine(int16_t x, int16_t y, int16_t length,
     length  = x2 - x + 1;
   }
 
+  if(frameBuffer) {
+    fillFrameBuffer(x, y, x2, y, color);
+    return;
+  }
   setAddrWindow(x, y, x2, y);
   flood(color, length);
-  if(driver == ID_932X) setAddrWindow(0, 0, _width - 1, _height - 1);
-  else                  setLR();
+  restoreAddrWindow();
 }
 
 void Adafruit_TFTLCD::drawFastVLine(int16_t x, int16_t y, int16_t length,
@@ -529,10 +520,13 @@ void Adafruit_TFTLCD::drawFastVLine(int16_t x, int16_t y, int16_t length,
     length  = y2 - y + 1;
   }
 
+  if(frameBuffer) {
+    fillFrameBuffer(x, y, x, y2, color);
+    return;
+  }
   setAddrWindow(x, y, x, y2);
   flood(color, length);
-  if(driver == ID_932X) setAddrWindow(0, 0, _width - 1, _height - 1);
-  else                  setLR();
+  restoreAddrWindow();
 }
 
 void Adafruit_TFTLCD::fillRect(int16_t x1, int16_t y1, int16_t w, int16_t h,
@@ -560,14 +554,22 @@ void Adafruit_TFTLCD::fillRect(int16_t x1, int16_t y1, int16_t w, int16_t h,
     h  = y2 - y1 + 1;
   }
 
+  if(frameBuffer) {
+    fillFrameBuffer(x1, y1, x2, y2, fillcolor);
+    return;
+  }
   setAddrWindow(x1, y1, x2, y2);
   flood(fillcolor, (uint32_t)w * (uint32_t)h);
-  if(driver == ID_932X) setAddrWindow(0, 0, _width - 1, _height - 1);
-  else                  setLR();
+  restoreAddrWindow();
 }
 
 void Adafruit_TFTLCD::fillScreen(uint16_t color) {
 
+  if(frameBuffer) {
+    fillFrameBuffer(0, 0, _width - 1, _height - 1, color);
+    return;
+  }
+
   if(driver == ID_932X) {
 
     // For the 932X, a full-screen address window is already the default
@@ -600,11 +602,129 @@ void Adafruit_TFTLCD::fillScreen(uint16_t color) {
   flood(color, (long)TFTWIDTH * (long)TFTHEIGHT);
 }
 
+// Draws a character without going through one drawPixel() or fillRect()
+// per font bit. Transparent text (bg == color) is drawn as the few
+// rectangles that cover the glyph; opaque text is a glyph run of one.
+void Adafruit_TFTLCD::drawChar(int16_t x, int16_t y, unsigned char c,
+  uint16_t color, uint16_t bg, uint8_t size) {
+
+  if((x >= _width) || (y >= _height) || ((x + 6 * size - 1) < 0) ||
+     ((y + 8 * size - 1) < 0))
+    return;
+
+  if(bg != color) {
+    drawGlyphRun(x, y, &c, 1, color, bg, size);
+    return;
+  }
+
+  // Each vertical run of set bits becomes a rectangle, widened across the
+  // following columns that have the same run.
+  uint8_t pending[5]; // Column 5 is blank.
+  for(uint8_t i = 0; i < 5; i++) pending[i] = glyphColumn(c, i);
+  for(uint8_t i = 0; i < 5; i++) {
+    while(pending[i]) {
+      uint8_t start = 0, end, mask = 0, k;
+      while(!(pending[i] & (1 << start))) start++;
+      for(end = start; (end < 8) && (pending[i] & (1 << end)); end++)
+        mask |= 1 << end;
+      for(k = i; (k < 5) && ((pending[k] & mask) == mask); k++)
+        pending[k] &= ~mask;
+      fillRect(x + i * size, y + start * size, (k - i) * size,
+        (end - start) * size, color);
+    }
+  }
+}
+
+// Draws count characters side by side with an opaque background. When
+// the whole run is on screen it is sent as a single window: each scanline
+// goes through every glyph in the run, and is repeated 'size' times. At
+// size 1 a scanline is sent from a buffer. Larger text is sent as runs of
+// the same color so that black and white runs only toggle WR.
+void Adafruit_TFTLCD::drawGlyphRun(int16_t x, int16_t y, const uint8_t *chars,
+  uint16_t count, uint16_t color, uint16_t bg, uint8_t size) {
+  int16_t w = 6 * size * count, h = 8 * size;
+
+  if((x < 0) || (y < 0) || (x + w > _width) || (y + h > _height) ||
+     frameBuffer) {
+    for(uint16_t n = 0; n < count; n++) // Clipped per pixel, or to memory.
+      Adafruit_GFX::drawChar(x + n * 6 * size, y, chars[n], color, bg, size);
+    return;
+  }
+
+  setAddrWindow(x, y, x + w - 1, y + h - 1);
+  beginGramWrite();
+  for(uint8_t j = 0; j < 8; j++) {
+    if(size == 1) {
+      uint16_t scanline[TFTWIDTH > TFTHEIGHT ? TFTWIDTH : TFTHEIGHT];
+      uint16_t *pixel = scanline;
+      for(uint16_t n = 0; n < count; n++)
+        for(uint8_t i = 0; i < 6; i++)
+          *pixel++ = (glyphColumn(chars[n], i) & (1 << j)) ? color : bg;
+      LCD_writePixels(scanline, w);
+      continue;
+    }
+    for(uint8_t k = 0; k < size; k++) {
+      uint16_t runColor = bg;
+      uint32_t runLength = 0;
+      for(uint16_t n = 0; n < count; n++) {
+        for(uint8_t i = 0; i < 6; i++) {
+          uint16_t pixelColor = (glyphColumn(chars[n], i) & (1 << j)) ? color : bg;
+          if((pixelColor != runColor) && runLength) {
+            LCD_writeRepeatedPixel(runColor, runLength);
+            runLength = 0;
+          }
+          runColor   = pixelColor;
+          runLength += size;
+        }
+      }
+      LCD_writeRepeatedPixel(runColor, runLength);
+    }
+  }
+  restoreAddrWindow();
+}
+
+// Prints a string. Characters that land on the same text line are drawn
+// as one glyph run rather than one character at a time; the cursor and
+// wrapping behave as they do in Adafruit_GFX::write().
+size_t Adafruit_TFTLCD::write(const uint8_t *buffer, size_t size) {
+  const uint8_t *end = buffer + size;
+  while(buffer < end) {
+    if((*buffer == '\n') || (*buffer == '\r')) {
+      Adafruit_GFX::write(*buffer++);
+      continue;
+    }
+    const uint8_t *run = buffer;
+    int16_t x = cursor_x, y = cursor_y;
+    while((buffer < end) && (*buffer != '\n') && (*buffer != '\r')) {
+      buffer++;
+      cursor_x += textsize * 6;
+      if(wrap && (cursor_x > (_width - textsize * 6))) {
+        cursor_y += textsize * 8;
+        cursor_x  = 0;
+        break;
+      }
+    }
+    if(textbgcolor == textcolor) {
+      for(const uint8_t *c = run; c < buffer; c++, x += textsize * 6)
+        drawChar(x, y, *c, textcolor, textbgcolor, textsize);
+    } else {
+      drawGlyphRun(x, y, run, buffer - run, textcolor, textbgcolor, textsize);
+    }
+  }
+  return size;
+}
+
 void Adafruit_TFTLCD::drawPixel(int16_t x, int16_t y, uint16_t color) {
 
   // Clip
   if((x < 0) || (y < 0) || (x >= _width) || (y >= _height)) return;
 
+  if(frameBuffer) {
+    frameBuffer[(int32_t)y * _width + x] = color;
+    markDirty(x, y, x, y);
+    return;
+  }
+
 //  CS_ACTIVE;
   if(driver == ID_932X) {
 
@@ -652,21 +772,10 @@ void Adafruit_TFTLCD::drawPixel(int16_t x, int16_t y, uint16_t color) {
     write8(hi); write8(lo);
 
   } else if (driver == ID_9341) {
-    if(rotation & 1)
-    {
-    	setAddrWindow(x, y, 319, 239);
-    }
-    else
-    {
-    	setAddrWindow(x, y, 239, 319);
-    }
+    setAddrWindow(x, y, _width - 1, _height - 1);
 //    CS_ACTIVE;
-//    CD_COMMAND;
-    LCD_setCommandMode();
-    write8(0x2C);
-//    CD_DATA;
-    LCD_setDataMode();
-    write8(color >> 8); write8(color);
+    beginGramWrite();
+    LCD_writePixels(&color, 1);
   }
 
 //  CS_IDLE;
@@ -677,31 +786,105 @@ void Adafruit_TFTLCD::drawPixel(int16_t x, int16_t y, uint16_t color) {
 // previously been set to define the bounds.  Max 255 pixels at
 // a time (BMP examples read in small chunks due to limited RAM).
 void Adafruit_TFTLCD::pushColors(uint16_t *data, uint8_t len, bool first) {
-  uint16_t color;
-  uint8_t  hi, lo;
 //  CS_ACTIVE;
   if(first == true) { // Issue GRAM write command only on first call
-//    CD_COMMAND;
-	  LCD_setCommandMode();
-    if(driver == ID_932X) write8(0x00);
-     if (driver == ID_9341) {
-       write8(0x2C);
-     }  else {
-       write8(0x22);
-     }
-  }
-//  CD_DATA;
-  LCD_setDataMode();
-  while(len--) {
-    color = *data++;
-    hi    = color >> 8; // Don't simplify or merge these
-    lo    = color;      // lines, there's macro shenanigans
-    write8(hi);         // going on.
-    write8(lo);
+    beginGramWrite();
   }
+  LCD_writePixels(data, len);
 //  CS_IDLE;
 }
 
+// Starts (or, with NULL, stops) drawing into an off-screen frame buffer of
+// _width x _height pixels. The buffer's current contents are taken as the
+// new picture, so all of it is marked dirty.
+void Adafruit_TFTLCD::setFrameBuffer(uint16_t *buffer) {
+  frameBuffer = buffer;
+  dirtyCount  = 0;
+  if(frameBuffer) markDirty(0, 0, _width - 1, _height - 1);
+}
+
+bool Adafruit_TFTLCD::hasFrameBuffer(void) {
+  return frameBuffer != NULL;
+}
+
+// Sends the dirty rectangles of the frame buffer to the panel, one burst
+// per rectangle. Rectangles that span the full width go out in a single
+// LCD_writePixels() call since their rows are contiguous in memory.
+void Adafruit_TFTLCD::flush(void) {
+  if(!frameBuffer) return;
+  for(uint8_t i = 0; i < dirtyCount; i++) {
+    int16_t x1 = dirtyRects[i].x1, y1 = dirtyRects[i].y1,
+            x2 = dirtyRects[i].x2, y2 = dirtyRects[i].y2;
+    int16_t w = x2 - x1 + 1;
+    setAddrWindow(x1, y1, x2, y2);
+    beginGramWrite();
+    if(w == _width) {
+      LCD_writePixels(&frameBuffer[(int32_t)y1 * _width], (uint32_t)w * (y2 - y1 + 1));
+    } else {
+      for(int16_t y = y1; y <= y2; y++)
+        LCD_writePixels(&frameBuffer[(int32_t)y * _width + x1], w);
+    }
+  }
+  dirtyCount = 0;
+  restoreAddrWindow();
+}
+
+// Fills a clipped, sorted rectangle of the frame buffer.
+void Adafruit_TFTLCD::fillFrameBuffer(int16_t x1, int16_t y1, int16_t x2,
+  int16_t y2, uint16_t color) {
+  for(int16_t y = y1; y <= y2; y++) {
+    uint16_t *pixel = &frameBuffer[(int32_t)y * _width + x1];
+    for(int16_t x = x1; x <= x2; x++) *pixel++ = color;
+  }
+  markDirty(x1, y1, x2, y2);
+}
+
+static inline int16_t tftMin(int16_t a, int16_t b) { return (a < b) ? a : b; }
+static inline int16_t tftMax(int16_t a, int16_t b) { return (a > b) ? a : b; }
+
+// Adds a rectangle to the dirty list. Rectangles that overlap or touch are
+// merged. When the list is full, the new rectangle is merged with the one
+// whose bounding box grows the least, trading a few clean pixels for a
+// bus burst.
+void Adafruit_TFTLCD::markDirty(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+  for(;;) {
+    uint8_t i = 0;
+    while(i < dirtyCount) {
+      if((x1 <= dirtyRects[i].x2 + 1) && (dirtyRects[i].x1 <= x2 + 1) &&
+         (y1 <= dirtyRects[i].y2 + 1) && (dirtyRects[i].y1 <= y2 + 1)) {
+        x1 = tftMin(x1, dirtyRects[i].x1); y1 = tftMin(y1, dirtyRects[i].y1);
+        x2 = tftMax(x2, dirtyRects[i].x2); y2 = tftMax(y2, dirtyRects[i].y2);
+        dirtyRects[i] = dirtyRects[--dirtyCount];
+        i = 0; // The union may now touch rectangles already checked.
+      } else {
+        i++;
+      }
+    }
+    if(dirtyCount < TFTLCD_DIRTY_RECT_COUNT) break;
+
+    uint8_t best = 0;
+    int32_t bestGrowth = 0x7FFFFFFF;
+    for(i = 0; i < dirtyCount; i++) {
+      int32_t w = tftMax(x2, dirtyRects[i].x2) - tftMin(x1, dirtyRects[i].x1) + 1,
+              h = tftMax(y2, dirtyRects[i].y2) - tftMin(y1, dirtyRects[i].y1) + 1,
+              growth = w * h -
+                (int32_t)(x2 - x1 + 1) * (y2 - y1 + 1) -
+                (int32_t)(dirtyRects[i].x2 - dirtyRects[i].x1 + 1) *
+                         (dirtyRects[i].y2 - dirtyRects[i].y1 + 1);
+      if(growth < bestGrowth) {
+        bestGrowth = growth;
+        best       = i;
+      }
+    }
+    x1 = tftMin(x1, dirtyRects[best].x1); y1 = tftMin(y1, dirtyRects[best].y1);
+    x2 = tftMax(x2, dirtyRects[best].x2); y2 = tftMax(y2, dirtyRects[best].y2);
+    dirtyRects[best] = dirtyRects[--dirtyCount];
+  }
+  dirtyRects[dirtyCount].x1 = x1; dirtyRects[dirtyCount].y1 = y1;
+  dirtyRects[dirtyCount].x2 = x2; dirtyRects[dirtyCount].y2 = y2;
+  dirtyCount++;
+}
+
 void Adafruit_TFTLCD::setRotation(uint8_t x) {
 
   // Call parent rotation func first -- sets up rotation flags, etc.
@@ -760,6 +943,8 @@ void Adafruit_TFTLCD::setRotation(uint8_t x) {
    // For 9341, init default full-screen address window:
    setAddrWindow(0, 0, _width - 1, _height - 1); // CS_IDLE happens here
   }
+  // A frame buffer is laid out for the rotation, so all of it must go out again.
+  if(frameBuffer) markDirty(0, 0, _width - 1, _height - 1);
 }
 
 #ifdef read8isFunctionalized
@@ -774,6 +959,8 @@ uint16_t Adafruit_TFTLCD::readPixel(int16_t x, int16_t y) {
 
   if((x < 0) || (y < 0) || (x >= _width) || (y >= _height)) return 0;
 
+  if(frameBuffer) return frameBuffer[(int32_t)y * _width + x];
+
 //  CS_ACTIVE;
   if(driver == ID_932X) {
 
@@ -975,19 +1162,11 @@ void Adafruit_TFTLCD::writeRegisterPair(uint8_t aH, uint8_t aL, uint16_t d) {
 
 
 void Adafruit_TFTLCD::writeRegister32(uint8_t r, uint32_t d) {
+  uint8_t data[4] = { (uint8_t)(d >> 24), (uint8_t)(d >> 16), (uint8_t)(d >> 8), (uint8_t)d };
 //  CS_ACTIVE;
 //  CD_COMMAND;
   LCD_setCommandMode();
   write8(r);
-//  CD_DATA;
-  LCD_setDataMode();
-//  LCD_delayMicroseconds(10);
-  write8(d >> 24);
-//  LCD_delayMicroseconds(10);
-  write8(d >> 16);
-//  LCD_delayMicroseconds(10);
-  write8(d >> 8);
-//  LCD_delayMicroseconds(10);
-  write8(d);
+  LCD_writeBytes(data, 4);  // Data mode for all four parameter bytes.
 //  CS_IDLE;
 }
@@ -20,6 +20,9 @@
 
 //#define USE_ADAFRUIT_SHIELD_PINOUT 1
 
+// Number of separate dirty rectangles tracked while drawing into a frame buffer.
+#define TFTLCD_DIRTY_RECT_COUNT 8
+
 class Adafruit_TFTLCD : public Adafruit_GFX {
 
  public:
@@ -34,6 +37,10 @@ class Adafruit_TFTLCD : public Adafruit_GFX {
   void     drawFastVLine(int16_t x0, int16_t y0, int16_t h, uint16_t color);
   void     fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c);
   void     fillScreen(uint16_t color);
+  void     drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+             uint16_t bg, uint8_t size);
+  size_t   write(const uint8_t *buffer, size_t size);
+  using    Adafruit_GFX::write;
   void     reset(void);
   void     setRegisters8(uint8_t *ptr, uint8_t n);
   void     setRegisters16(uint16_t *ptr, uint8_t n);
@@ -41,6 +48,13 @@ class Adafruit_TFTLCD : public Adafruit_GFX {
        // These methods are public in order for BMP examples to work:
   void     setAddrWindow(int x1, int y1, int x2, int y2);
   void     pushColors(uint16_t *data, uint8_t len, bool first);
+  void     writePixels(const uint16_t *data, uint32_t len);
+       // Optional off-screen frame buffer (_width x _height RGB565 pixels).
+       // While one is set, drawing only touches memory; flush() sends the
+       // regions that changed to the panel. Pass NULL to draw directly again.
+  void     setFrameBuffer(uint16_t *buffer);
+  bool     hasFrameBuffer(void);
+  void     flush(void);
 
   uint16_t color565(uint8_t r, uint8_t g, uint8_t b),
            readPixel(int16_t x, int16_t y),
@@ -72,8 +86,23 @@ class Adafruit_TFTLCD : public Adafruit_GFX {
            writeRegisterPair(uint8_t aH, uint8_t aL, uint16_t d),
 #endif
            setLR(void),
+           restoreAddrWindow(void),
+           beginGramWrite(void),
+           drawGlyphRun(int16_t x, int16_t y, const uint8_t *chars,
+             uint16_t count, uint16_t color, uint16_t bg, uint8_t size),
+           fillFrameBuffer(int16_t x1, int16_t y1, int16_t x2, int16_t y2,
+             uint16_t color),
+           markDirty(int16_t x1, int16_t y1, int16_t x2, int16_t y2),
            flood(uint16_t color, uint32_t len);
   uint8_t  driver;
+  // Address window last programmed into the 9341 (packed as sent to it).
+  uint32_t addrColumns, addrPages;
+  bool     addrWindowKnown;
+  uint16_t *frameBuffer;
+  struct {
+    int16_t x1, y1, x2, y2;
+  }        dirtyRects[TFTLCD_DIRTY_RECT_COUNT];
+  uint8_t  dirtyCount;
 
 #ifndef read8
   uint8_t  read8fn(void);
@@ -5,18 +5,35 @@
  *      Author: hutch
  */
 
+#include <math.h>  // Ahead of the Adafruit headers: their swap() macro breaks the C++ <cmath>.
 #include "display.h"
 #include "Adafruit_TFTLCD.h"
 #include "Adafruit_STMPE610.h"
+#include "globalTimer.h"
+#include "interrupts.h"
+#include "spi.h"
+#include "trace.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// On the host build, every public drawing call is charged with the LCD bus traffic it causes
+// (see hostSim/hostSimLcd.h). On the board this compiles away.
+#ifdef HOST_SIM
+#include "hostSimLcd.h"
+#define DISPLAY_ACCOUNT_BUS_TRAFFIC() hostSimLcd_primitiveScope busTrafficScope(__func__)
+#else
+#define DISPLAY_ACCOUNT_BUS_TRAFFIC()
+#endif
 
 // Just define these values here. They won't change in practice and I want to avoid
 // too much tangling between the LCD control code and the touch-controller code.
 // Otherwise, it would make sense to always get these values from the LCD controller.
 // These #defines are not shared outside of this .cpp file and so don't need to follow the
 // naming convention.
-#define LCD_WIDTH  320.0
-#define LCD_HEIGHT 240.0
+#define LCD_WIDTH  320
+#define LCD_HEIGHT 240
 #define LCD_LEFT_OFFSCREEN_TOUCH_WIDTH 20
 
 
@@ -24,111 +41,216 @@
 #define TOUCH_SCREEN_MAX_X 3950.0  // This is where the touch-screen maxes out in X.
 #define TOUCH_SCREEN_MAX_Y 4095.0
 
+// Size of the optional frame buffer, one RGB565 pixel per screen pixel.
+#define DISPLAY_FRAME_BUFFER_PIXELS (320 * 240)
+
 bool initFlag = false;  // Only allow init to be called once.
 static Adafruit_TFTLCD lcdDisplay = Adafruit_TFTLCD();  // Handle to the LCD display.
 static Adafruit_STMPE610 touchController = Adafruit_STMPE610();
+static uint16_t frameBuffer[DISPLAY_FRAME_BUFFER_PIXELS];  // Only used when enabled; lives in DDR.
+
+static void display_initTouchRequests();
+
+// Queued drawing (display_setQueuedMode()). The drawing calls below hand their arguments to
+// display_queueCommand(), which returns false when the mode is off so that they draw right away.
+typedef enum {
+  DISPLAY_COMMAND_DRAW_PIXEL,
+  DISPLAY_COMMAND_DRAW_LINE,
+  DISPLAY_COMMAND_DRAW_FAST_VLINE,
+  DISPLAY_COMMAND_DRAW_FAST_HLINE,
+  DISPLAY_COMMAND_DRAW_RECT,
+  DISPLAY_COMMAND_FILL_RECT,
+  DISPLAY_COMMAND_INVERT_DISPLAY,
+  DISPLAY_COMMAND_DRAW_CIRCLE,
+  DISPLAY_COMMAND_FILL_CIRCLE,
+  DISPLAY_COMMAND_DRAW_TRIANGLE,
+  DISPLAY_COMMAND_FILL_TRIANGLE,
+  DISPLAY_COMMAND_DRAW_ROUND_RECT,
+  DISPLAY_COMMAND_FILL_ROUND_RECT,
+  DISPLAY_COMMAND_DRAW_BITMAP,
+  DISPLAY_COMMAND_DRAW_CHAR,
+  DISPLAY_COMMAND_SET_CURSOR,
+  DISPLAY_COMMAND_SET_TEXT_COLOR,
+  DISPLAY_COMMAND_SET_TEXT_COLORS,
+  DISPLAY_COMMAND_SET_TEXT_SIZE,
+  DISPLAY_COMMAND_SET_TEXT_WRAP,
+  DISPLAY_COMMAND_TEXT,
+  DISPLAY_COMMAND_FLUSH
+} display_commandOp_t;
+
+static bool display_queueCommand(display_commandOp_t op, uint16_t color, int16_t a0 = 0, int16_t a1 = 0,
+                                 int16_t a2 = 0, int16_t a3 = 0, int16_t a4 = 0, int16_t a5 = 0);
+static bool display_queueText(const char *text);
+static bool display_queueBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
 
 // Will only execute the body once.
 void display_init() {
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   if (!initFlag) {
     lcdDisplay.begin();
     lcdDisplay.setRotation(1);
     touchController.begin();
+    display_initTouchRequests();
+    if (!display_getTouchCalibrationVersion())  // Keeps one that was set ahead of the init.
+      display_resetTouchCalibration();
+    globalTimer_startTimer(false);  // Time stamps the touch events.
+    initFlag = true;
   }
 }
 
 // These are functions related to display. Functionality comes from Adafruit_GFX.
 void display_drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_DRAW_PIXEL, color, x, y))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawPixel(x, y, color);
 }
 
 void display_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_DRAW_LINE, color, x0, y0, x1, y1))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawLine(x0, y0, x1, y1, color);
 }
 
 void display_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_DRAW_FAST_VLINE, color, x, y, h))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawFastVLine(x, y, h, color);
 }
 
 void display_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_DRAW_FAST_HLINE, color, x, y, w))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawFastHLine(x, y, w, color);
 }
 
 void display_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_DRAW_RECT, color, x, y, w, h))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawRect(x, y, w, h, color);
 }
 
 void display_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_FILL_RECT, color, x, y, w, h))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.fillRect(x, y, w, h, color);
 }
 
+// Queued, this is a fill of the whole screen, so that it can go in bands like any other.
 void display_fillScreen(uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_FILL_RECT, color, 0, 0, lcdDisplay.width(), lcdDisplay.height()))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.fillScreen(color);
 }
 
 void display_invertDisplay(bool i) {
+  if (display_queueCommand(DISPLAY_COMMAND_INVERT_DISPLAY, 0, i))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.invertDisplay(i);
 }
 
 void display_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_DRAW_CIRCLE, color, x0, y0, r))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawCircle(x0, y0, r, color);
 }
 
 void display_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_FILL_CIRCLE, color, x0, y0, r))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.fillCircle(x0, y0, r, color);
 }
 
 void display_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
 int16_t x2, int16_t y2, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_DRAW_TRIANGLE, color, x0, y0, x1, y1, x2, y2))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawTriangle(x0, y0, x1, y1, x2, y2, color);
 }
 
 void display_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
 int16_t x2, int16_t y2, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_FILL_TRIANGLE, color, x0, y0, x1, y1, x2, y2))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.fillTriangle(x0, y0, x1, y1, x2, y2, color);
 }
 
 void display_drawRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
 int16_t radius, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_DRAW_ROUND_RECT, color, x0, y0, w, h, radius))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawRoundRect(x0, y0, w, h, radius, color);
 }
 
 void display_fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
 int16_t radius, uint16_t color) {
+  if (display_queueCommand(DISPLAY_COMMAND_FILL_ROUND_RECT, color, x0, y0, w, h, radius))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.fillRoundRect(x0, y0, w, h, radius, color);
 }
 
 void display_drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
 int16_t w, int16_t h, uint16_t color) {
+  if (display_queueBitmap(x, y, bitmap, w, h, color))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawBitmap(x, y, bitmap, w, h, color);
 }
 
 void display_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
 uint16_t bg, uint8_t size) {
+  if (display_queueCommand(DISPLAY_COMMAND_DRAW_CHAR, color, x, y, c, bg, size))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.drawChar(x, y, c, color, bg, size);
 }
 
 void display_setCursor(int16_t x, int16_t y) {
+  if (display_queueCommand(DISPLAY_COMMAND_SET_CURSOR, 0, x, y))
+    return;
   lcdDisplay.setCursor(x, y);
 }
 
 void display_setTextColor(uint16_t c) {
+  if (display_queueCommand(DISPLAY_COMMAND_SET_TEXT_COLOR, c))
+    return;
   lcdDisplay.setTextColor(c);
 }
 
 void display_setTextColor(uint16_t c, uint16_t bg) {
+  if (display_queueCommand(DISPLAY_COMMAND_SET_TEXT_COLORS, c, bg))
+    return;
   lcdDisplay.setTextColor(c, bg);
 }
 
 void display_setTextSize(uint8_t s) {
+  if (display_queueCommand(DISPLAY_COMMAND_SET_TEXT_SIZE, 0, s))
+    return;
   lcdDisplay.setTextSize(s);
 }
 
 void display_setTextWrap(bool w) {
+  if (display_queueCommand(DISPLAY_COMMAND_SET_TEXT_WRAP, 0, w))
+    return;
   lcdDisplay.setTextWrap(w);
 }
 
 void display_setRotation(uint8_t r) {
+  display_finishCommands();  // What was queued ahead of this goes first.
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   lcdDisplay.setRotation(r);
 }
 
@@ -140,91 +262,884 @@ int16_t display_width() {
   return lcdDisplay.width();
 }
 
+// Switches drawing between the panel and the off-screen frame buffer.
+void display_setFrameBufferEnabled(bool enable) {
+  display_finishCommands();  // What was queued ahead of this goes first.
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
+  if (enable == lcdDisplay.hasFrameBuffer())
+    return;
+  if (enable) {
+    for (uint32_t i = 0; i < DISPLAY_FRAME_BUFFER_PIXELS; i++)
+      frameBuffer[i] = DISPLAY_BLACK;
+    lcdDisplay.setFrameBuffer(frameBuffer);
+  } else {
+    lcdDisplay.flush();  // Don't lose anything drawn since the last flush.
+    lcdDisplay.setFrameBuffer(NULL);
+  }
+}
+
+bool display_isFrameBufferEnabled() {
+  return lcdDisplay.hasFrameBuffer();
+}
+
+// Sends the parts of the frame buffer that changed since the last flush to the panel.
+void display_flush() {
+  if (display_queueCommand(DISPLAY_COMMAND_FLUSH, 0))
+    return;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
+  lcdDisplay.flush();
+}
+
+uint16_t display_readPixel(int16_t x, int16_t y) {
+  display_finishCommands();  // What was queued ahead of this goes first.
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
+  return lcdDisplay.readPixel(x, y);
+}
+
 // Obscure function name = just packs the RGB data into a 16-bit int.
 uint16_t display_color565(uint8_t r, uint8_t g, uint8_t b) {
   return lcdDisplay.color565(r, g, b);
 }
 
+// Print::println() writes the text, then "\r\n", and counts every character.
 size_t display_println(const char str[]) {
+  if (display_queueText(str) && display_queueText("\r\n"))
+    return strlen(str) + 2;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   return lcdDisplay.println(str);
 }
 
 size_t display_println(char c) {
+  char text[] = {c, '\r', '\n', '\0'};
+  if (display_queueText(text))
+    return 3;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   return lcdDisplay.println(c);
 }
 
 size_t display_println(unsigned char c, int base) {
+  display_finishCommands();  // What was queued ahead of this goes first.
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   return lcdDisplay.println(c, base);
 }
 
 size_t display_println(int num, int base) {
+  display_finishCommands();  // What was queued ahead of this goes first.
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   return lcdDisplay.println(num, base);
 }
 
 size_t display_println(unsigned int num, int base) {
+  display_finishCommands();  // What was queued ahead of this goes first.
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   return lcdDisplay.println(num, base);
 }
 
 size_t display_println(long num, int base) {
+  display_finishCommands();  // What was queued ahead of this goes first.
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   return lcdDisplay.println(num, base);
 }
 
 size_t display_println(unsigned long num, int base) {
+  display_finishCommands();  // What was queued ahead of this goes first.
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   return lcdDisplay.println(num, base);
 }
 
 size_t display_println(double num, int fieldWidth) {
+  display_finishCommands();  // What was queued ahead of this goes first.
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   return lcdDisplay.println(num, fieldWidth);
 }
 
 size_t display_println(void) {
+  if (display_queueText("\r\n"))
+    return 2;
+  DISPLAY_ACCOUNT_BUS_TRAFFIC();
   return lcdDisplay.println();
 }
 
 
+// Queued drawing. The ring is single-producer, single-consumer like the touch event queue, but
+// both ends run in the main program: the drawing calls append, display_drainCommands() removes.
+#define DISPLAY_COMMAND_QUEUE_MASK (DISPLAY_COMMAND_QUEUE_SIZE - 1)
+#define DISPLAY_COMMAND_TEXT_LENGTH 12        // Longer text takes several commands.
+#define DISPLAY_COMMAND_FILL_STEP_PIXELS 1024  // About 0.5 ms on the board (see hostSim/hostSimLcd.h).
+
+typedef struct {
+  uint8_t op;        // display_commandOp_t.
+  uint8_t length;    // Of text.
+  uint8_t progress;  // Characters of text already written.
+  uint16_t color;
+  union {
+    int16_t args[6];
+    char text[DISPLAY_COMMAND_TEXT_LENGTH];
+    struct {
+      int16_t x, y, w, h;
+      const uint8_t *bitmap;
+    } bitmap;
+  };
+} display_command_t;
+
+// Names for the bus traffic report on the host, indexed by display_commandOp_t: a queued call
+// is charged to the same primitive as a direct one.
+static const char *display_commandNames[] = {"display_drawPixel", "display_drawLine", "display_drawFastVLine",
+  "display_drawFastHLine", "display_drawRect", "display_fillRect", "display_invertDisplay", "display_drawCircle",
+  "display_fillCircle", "display_drawTriangle", "display_fillTriangle", "display_drawRoundRect",
+  "display_fillRoundRect", "display_drawBitmap", "display_drawChar", "display_setCursor", "display_setTextColor",
+  "display_setTextColor", "display_setTextSize", "display_setTextWrap", "display_println", "display_flush"};
+
+static display_command_t commands[DISPLAY_COMMAND_QUEUE_SIZE];
+static uint32_t commandHead = 0;  // Next slot to write.
+static uint32_t commandTail = 0;  // Next slot to draw.
+static bool commandQueueEnabled = false;
+static uint32_t commandQueueStallCount = 0;
+
+static bool display_runCommandStep();
+
+// Returns the slot to fill, after making room if the ring is full, or NULL if the mode is off.
+static display_command_t *display_reserveCommand(display_commandOp_t op, uint16_t color) {
+  if (!commandQueueEnabled)
+    return NULL;
+  if (commandHead - commandTail == DISPLAY_COMMAND_QUEUE_SIZE) {
+    commandQueueStallCount++;
+    while (commandHead - commandTail == DISPLAY_COMMAND_QUEUE_SIZE)
+      display_runCommandStep();
+  }
+  display_command_t *command = &commands[commandHead & DISPLAY_COMMAND_QUEUE_MASK];
+  command->op = op;
+  command->length = 0;
+  command->progress = 0;
+  command->color = color;
+  return command;
+}
+
+static bool display_queueCommand(display_commandOp_t op, uint16_t color, int16_t a0, int16_t a1,
+                                 int16_t a2, int16_t a3, int16_t a4, int16_t a5) {
+  display_command_t *command = display_reserveCommand(op, color);
+  if (!command)
+    return false;
+  command->args[0] = a0;
+  command->args[1] = a1;
+  command->args[2] = a2;
+  command->args[3] = a3;
+  command->args[4] = a4;
+  command->args[5] = a5;
+  commandHead++;
+  return true;
+}
+
+static bool display_queueBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color) {
+  display_command_t *command = display_reserveCommand(DISPLAY_COMMAND_DRAW_BITMAP, color);
+  if (!command)
+    return false;
+  command->bitmap.x = x;
+  command->bitmap.y = y;
+  command->bitmap.w = w;
+  command->bitmap.h = h;
+  command->bitmap.bitmap = bitmap;
+  commandHead++;
+  return true;
+}
+
+// The text is copied, DISPLAY_COMMAND_TEXT_LENGTH characters to a command.
+static bool display_queueText(const char *text) {
+  if (!commandQueueEnabled)
+    return false;
+  size_t length = strlen(text);
+  for (size_t i = 0; i < length; i += DISPLAY_COMMAND_TEXT_LENGTH) {
+    display_command_t *command = display_reserveCommand(DISPLAY_COMMAND_TEXT, 0);
+    command->length = length - i < DISPLAY_COMMAND_TEXT_LENGTH ? length - i : DISPLAY_COMMAND_TEXT_LENGTH;
+    memcpy(command->text, text + i, command->length);
+    commandHead++;
+  }
+  return true;
+}
+
+// Draws a band of a fill. Returns true once the fill is done.
+static bool display_runFillStep(display_command_t *command) {
+  int16_t *args = command->args;  // x, y, w, h
+  int16_t rows = args[2] > 0 ? DISPLAY_COMMAND_FILL_STEP_PIXELS / args[2] : args[3];
+  if (rows < 1)
+    rows = 1;
+  if (rows >= args[3]) {
+    lcdDisplay.fillRect(args[0], args[1], args[2], args[3], command->color);
+    return true;
+  }
+  lcdDisplay.fillRect(args[0], args[1], args[2], rows, command->color);
+  args[1] += rows;
+  args[3] -= rows;
+  return false;
+}
+
+// Does the next step of the oldest command. Returns false if there was nothing to do.
+static bool display_runCommandStep() {
+  if (commandTail == commandHead)
+    return false;
+  display_command_t *command = &commands[commandTail & DISPLAY_COMMAND_QUEUE_MASK];
+  const int16_t *args = command->args;
+  bool done = true;
+#ifdef HOST_SIM
+  hostSimLcd_primitiveScope busTrafficScope(display_commandNames[command->op]);
+#endif
+  switch (command->op) {
+  case DISPLAY_COMMAND_DRAW_PIXEL:
+    lcdDisplay.drawPixel(args[0], args[1], command->color);
+    break;
+  case DISPLAY_COMMAND_DRAW_LINE:
+    lcdDisplay.drawLine(args[0], args[1], args[2], args[3], command->color);
+    break;
+  case DISPLAY_COMMAND_DRAW_FAST_VLINE:
+    lcdDisplay.drawFastVLine(args[0], args[1], args[2], command->color);
+    break;
+  case DISPLAY_COMMAND_DRAW_FAST_HLINE:
+    lcdDisplay.drawFastHLine(args[0], args[1], args[2], command->color);
+    break;
+  case DISPLAY_COMMAND_DRAW_RECT:
+    lcdDisplay.drawRect(args[0], args[1], args[2], args[3], command->color);
+    break;
+  case DISPLAY_COMMAND_FILL_RECT:
+    done = display_runFillStep(command);
+    break;
+  case DISPLAY_COMMAND_INVERT_DISPLAY:
+    lcdDisplay.invertDisplay(args[0]);
+    break;
+  case DISPLAY_COMMAND_DRAW_CIRCLE:
+    lcdDisplay.drawCircle(args[0], args[1], args[2], command->color);
+    break;
+  case DISPLAY_COMMAND_FILL_CIRCLE:
+    lcdDisplay.fillCircle(args[0], args[1], args[2], command->color);
+    break;
+  case DISPLAY_COMMAND_DRAW_TRIANGLE:
+    lcdDisplay.drawTriangle(args[0], args[1], args[2], args[3], args[4], args[5], command->color);
+    break;
+  case DISPLAY_COMMAND_FILL_TRIANGLE:
+    lcdDisplay.fillTriangle(args[0], args[1], args[2], args[3], args[4], args[5], command->color);
+    break;
+  case DISPLAY_COMMAND_DRAW_ROUND_RECT:
+    lcdDisplay.drawRoundRect(args[0], args[1], args[2], args[3], args[4], command->color);
+    break;
+  case DISPLAY_COMMAND_FILL_ROUND_RECT:
+    lcdDisplay.fillRoundRect(args[0], args[1], args[2], args[3], args[4], command->color);
+    break;
+  case DISPLAY_COMMAND_DRAW_BITMAP:
+    lcdDisplay.drawBitmap(command->bitmap.x, command->bitmap.y, command->bitmap.bitmap, command->bitmap.w,
+                          command->bitmap.h, command->color);
+    break;
+  case DISPLAY_COMMAND_DRAW_CHAR:
+    lcdDisplay.drawChar(args[0], args[1], args[2], command->color, args[3], args[4]);
+    break;
+  case DISPLAY_COMMAND_SET_CURSOR:
+    lcdDisplay.setCursor(args[0], args[1]);
+    break;
+  case DISPLAY_COMMAND_SET_TEXT_COLOR:
+    lcdDisplay.setTextColor(command->color);
+    break;
+  case DISPLAY_COMMAND_SET_TEXT_COLORS:
+    lcdDisplay.setTextColor(command->color, args[0]);
+    break;
+  case DISPLAY_COMMAND_SET_TEXT_SIZE:
+    lcdDisplay.setTextSize(args[0]);
+    break;
+  case DISPLAY_COMMAND_SET_TEXT_WRAP:
+    lcdDisplay.setTextWrap(args[0]);
+    break;
+  case DISPLAY_COMMAND_TEXT:
+    lcdDisplay.write(command->text[command->progress++]);
+    done = command->progress == command->length;
+    break;
+  case DISPLAY_COMMAND_FLUSH:
+    lcdDisplay.flush();
+    break;
+  }
+  if (done)
+    commandTail++;
+  return true;
+}
+
+void display_setQueuedMode(bool enable) {
+  if (!enable)
+    display_finishCommands();
+  commandQueueEnabled = enable;
+}
+
+bool display_isQueuedMode() {
+  return commandQueueEnabled;
+}
+
+bool display_hasQueuedCommands() {
+  return commandTail != commandHead;
+}
+
+bool display_drainCommands(uint64_t endTime) {
+  do {
+    if (!display_runCommandStep())
+      return false;
+  } while (globalTimer_getTimerValue() < endTime);
+  return display_hasQueuedCommands();
+}
+
+void display_finishCommands() {
+  while (display_runCommandStep());
+}
+
+uint32_t display_getCommandQueueStallCount() {
+  return commandQueueStallCount;
+}
+
 // These are functions related to the touch-pad.
 
+// Touch events go through a single-producer, single-consumer ring: display_touchIsr() only
+// advances the head, the consumer only advances the tail, so neither needs to mask interrupts.
+#define DISPLAY_TOUCH_EVENT_QUEUE_SIZE 64  // Power of two.
+#define DISPLAY_TOUCH_EVENT_QUEUE_MASK (DISPLAY_TOUCH_EVENT_QUEUE_SIZE - 1)
+#define DISPLAY_TOUCH_EVENT_SLOTS_FOR_MOVE 3  // Keep room for a DOWN and its UP.
+#define DISPLAY_TOUCH_EVENT_SLOTS_FOR_DOWN 2  // Keep room for the UP.
+#define DISPLAY_TOUCH_SAMPLES_PER_READ 16     // Samples pulled out of the controller per SPI transaction.
+
+static display_touchEvent_t touchEvents[DISPLAY_TOUCH_EVENT_QUEUE_SIZE];
+static volatile uint32_t touchEventHead = 0;  // Next slot to write (producer).
+static volatile uint32_t touchEventTail = 0;  // Next slot to read (consumer).
+static volatile uint32_t touchEventOverflowCount = 0;
+static volatile bool touchInterruptsEnabled = false;
+// Producer state: whether a touch has been reported, whether its DOWN made it into the queue,
+// and the last filtered raw sample (for UP events and display_getTouchedPoint()).
+static volatile bool touchIsDown = false;
+static bool touchDownQueued = false;
+static int16_t lastTouchX, lastTouchY;
+static uint8_t lastTouchZ;
+// Recording (display_startTouchRecording()) and replay (display_startTouchReplay()).
+static display_touchRecordingHeader_t *touchRecordingHeader = NULL;
+static display_touchRecord_t *touchRecords;
+static uint32_t touchRecordCapacity;
+static uint64_t touchRecordingStartTime;
+static volatile bool touchReplaying = false;
+
+// Whether the producer state above is what the touch functions report: it is kept up to date
+// by the ISR or by the replay. Otherwise they poll the controller.
+static bool display_isTouchStateCurrent() {
+  return touchInterruptsEnabled || touchReplaying;
+}
+
 // True if the display is being touched.
 bool display_isTouched(void) {
+  if (display_isTouchStateCurrent())
+    return touchIsDown;
   return touchController.touched();
 }
 
 // These min and max values correspond to the edges of the LCD panel.
 // x runs from the min value at the bottom, max value at the top.
 // y runs from the min value at the left, max value at the right.
-#define MIN_Y_TOUCH_POINT 280.0
-#define MAX_Y_TOUCH_POINT 3900.0
-#define MIN_X_TOUCH_POINT 350.0
-#define MAX_X_TOUCH_POINT 3950.0
-// Maps the touch-screen coordinates back to the LCD coordinate space.
+// They only serve as the nominal calibration now (display_resetTouchCalibration()).
+#define MIN_Y_TOUCH_POINT 280
+#define MAX_Y_TOUCH_POINT 3900
+#define MIN_X_TOUCH_POINT 350
+#define MAX_X_TOUCH_POINT 3950
+
+#define DISPLAY_TOUCH_CALIBRATION_MAGIC 0x54434131        // "TCA1"
+#define DISPLAY_TOUCH_CALIBRATION_MAX_SCALE (1L << 20)     // 16 LCD pixels per raw count.
+#define DISPLAY_TOUCH_CALIBRATION_MAX_OFFSET (1L << 30)
+#define DISPLAY_TOUCH_CALIBRATION_POINTS 3
+#define DISPLAY_TOUCH_CALIBRATION_TARGET_RADIUS 8
+#define DISPLAY_TOUCH_CALIBRATION_TEXT_SIZE 2
+
+static display_touchCalibration_t touchCalibration;
+static volatile uint32_t touchCalibrationVersion = 0;
+
+// FNV-1a over everything ahead of the checksum.
+static uint32_t display_touchCalibrationChecksum(const display_touchCalibration_t *calibration) {
+  const uint8_t *bytes = (const uint8_t *) calibration;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < offsetof(display_touchCalibration_t, checksum); i++)
+    hash = (hash ^ bytes[i]) * 16777619u;
+  return hash;
+}
+
+// Rounds to nearest, halves away from zero.
+static int64_t display_divideRounded(int64_t numerator, int64_t denominator) {
+  if ((numerator < 0) != (denominator < 0))
+    return (numerator - denominator / 2) / denominator;
+  return (numerator + denominator / 2) / denominator;
+}
+
+// Solves lcd = A * raw + B for three point pairs (Cramer's rule, integer only). Returns false if
+// the raw points are (nearly) collinear.
+static bool display_fitTouchCalibration(const int32_t raw[][2], const int32_t lcd[][2], display_touchCalibration_t *calibration) {
+  int64_t x0 = raw[0][0], y0 = raw[0][1], x1 = raw[1][0], y1 = raw[1][1], x2 = raw[2][0], y2 = raw[2][1];
+  int64_t determinant = x0 * (y1 - y2) - x1 * (y0 - y2) + x2 * (y0 - y1);
+  if (!determinant)
+    return false;
+  int32_t coefficients[2][3];
+  for (int axis = 0; axis < 2; axis++) {
+    int64_t l0 = lcd[0][axis], l1 = lcd[1][axis], l2 = lcd[2][axis];
+    int64_t numerators[3] = {
+      l0 * (y1 - y2) - l1 * (y0 - y2) + l2 * (y0 - y1),
+      x0 * (l1 - l2) - x1 * (l0 - l2) + x2 * (l0 - l1),
+      x0 * (y1 * l2 - y2 * l1) - x1 * (y0 * l2 - y2 * l0) + x2 * (y0 * l1 - y1 * l0)
+    };
+    for (int i = 0; i < 3; i++) {
+      int64_t value = display_divideRounded(numerators[i] << DISPLAY_TOUCH_CALIBRATION_FRACTION_BITS, determinant);
+      int64_t limit = i < 2 ? DISPLAY_TOUCH_CALIBRATION_MAX_SCALE : DISPLAY_TOUCH_CALIBRATION_MAX_OFFSET;
+      if (value <= -limit || value >= limit)
+        return false;
+      coefficients[axis][i] = value;
+    }
+  }
+  calibration->magic = DISPLAY_TOUCH_CALIBRATION_MAGIC;
+  calibration->xx = coefficients[0][0];
+  calibration->xy = coefficients[0][1];
+  calibration->x0 = coefficients[0][2];
+  calibration->yx = coefficients[1][0];
+  calibration->yy = coefficients[1][1];
+  calibration->y0 = coefficients[1][2];
+  calibration->checksum = display_touchCalibrationChecksum(calibration);
+  return true;
+}
+
+void display_getTouchCalibration(display_touchCalibration_t *calibration) {
+  *calibration = touchCalibration;
+}
+
+bool display_setTouchCalibration(const display_touchCalibration_t *calibration) {
+  if (calibration->magic != DISPLAY_TOUCH_CALIBRATION_MAGIC ||
+      calibration->checksum != display_touchCalibrationChecksum(calibration))
+    return false;
+  const int32_t scales[4] = {calibration->xx, calibration->xy, calibration->yx, calibration->yy};
+  for (int i = 0; i < 4; i++)
+    if (scales[i] <= -DISPLAY_TOUCH_CALIBRATION_MAX_SCALE || scales[i] >= DISPLAY_TOUCH_CALIBRATION_MAX_SCALE)
+      return false;
+  if (calibration->x0 <= -DISPLAY_TOUCH_CALIBRATION_MAX_OFFSET || calibration->x0 >= DISPLAY_TOUCH_CALIBRATION_MAX_OFFSET ||
+      calibration->y0 <= -DISPLAY_TOUCH_CALIBRATION_MAX_OFFSET || calibration->y0 >= DISPLAY_TOUCH_CALIBRATION_MAX_OFFSET)
+    return false;
+  if ((int64_t) calibration->xx * calibration->yy == (int64_t) calibration->xy * calibration->yx)
+    return false;  // Would flatten the panel onto a line.
+  touchCalibration = *calibration;
+  touchCalibrationVersion++;
+  return true;
+}
+
+// The panel's nominal corners: top left, top right and bottom left of the LCD. The raw axes are
+// swapped with respect to the LCD, and raw x runs bottom to top.
+void display_resetTouchCalibration() {
+  static const int32_t raw[DISPLAY_TOUCH_CALIBRATION_POINTS][2] = {
+    {MAX_Y_TOUCH_POINT, MIN_X_TOUCH_POINT}, {MAX_Y_TOUCH_POINT, MAX_X_TOUCH_POINT}, {MIN_Y_TOUCH_POINT, MIN_X_TOUCH_POINT}};
+  static const int32_t lcd[DISPLAY_TOUCH_CALIBRATION_POINTS][2] = {{0, 0}, {LCD_WIDTH, 0}, {0, LCD_HEIGHT}};
+  display_touchCalibration_t calibration;
+  display_fitTouchCalibration(raw, lcd, &calibration);
+  display_setTouchCalibration(&calibration);
+}
+
+uint32_t display_getTouchCalibrationVersion() {
+  return touchCalibrationVersion;
+}
+
+// Maps the touch-screen coordinates back to the LCD coordinate space: two multiply-adds per axis.
 void display_mapToLcdCoordinates(int16_t *x, int16_t *y) {
-    // Swap incoming x and y to match with the LCD panel.
-	float lcdX = *y;
-	float lcdY = *x;
-    // Flip y so min is at top, max is at bottom.
-	lcdY = (MAX_Y_TOUCH_POINT) - lcdY;
-	// Scale y.
-	lcdY = (lcdY / (MAX_Y_TOUCH_POINT - MIN_Y_TOUCH_POINT)) * LCD_HEIGHT;
-	// Subtract off the minimum - you want to go negative on the left of the LCD
-	// and offset the maximum value so it matches the max LCD coordinate at the far right
-	// of the LCD.
-	lcdX -= MIN_X_TOUCH_POINT;
-    // x is within the LCD, scale by the full width of the LCD.
-	lcdX = (lcdX /(MAX_X_TOUCH_POINT - MIN_X_TOUCH_POINT)) * LCD_WIDTH;
-	// Make the final assignment back to the arguments.
-    *x = lcdX;
-    *y = lcdY;
+  int32_t rawX = *x, rawY = *y;
+  *x = ((int64_t) touchCalibration.xx * rawX + (int64_t) touchCalibration.xy * rawY + touchCalibration.x0) >> DISPLAY_TOUCH_CALIBRATION_FRACTION_BITS;
+  *y = ((int64_t) touchCalibration.yx * rawX + (int64_t) touchCalibration.yy * rawY + touchCalibration.y0) >> DISPLAY_TOUCH_CALIBRATION_FRACTION_BITS;
+}
+
+// x > column  <=>  xx * rawX + xy * rawY + x0 >= (column + 1) << 16, given the flooring shift above.
+void display_getTouchLineForColumn(int16_t column, display_touchLine_t *line) {
+  line->rawXScale = touchCalibration.xx;
+  line->rawYScale = touchCalibration.xy;
+  line->offset = touchCalibration.x0 - ((int32_t) (column + 1) << DISPLAY_TOUCH_CALIBRATION_FRACTION_BITS);
+}
+
+void display_getTouchLineForRow(int16_t row, display_touchLine_t *line) {
+  line->rawXScale = touchCalibration.yx;
+  line->rawYScale = touchCalibration.yy;
+  line->offset = touchCalibration.y0 - ((int32_t) (row + 1) << DISPLAY_TOUCH_CALIBRATION_FRACTION_BITS);
+}
+
+static void display_drawCalibrationTarget(int16_t x, int16_t y, uint16_t color) {
+  display_drawFastHLine(x - DISPLAY_TOUCH_CALIBRATION_TARGET_RADIUS, y, 2 * DISPLAY_TOUCH_CALIBRATION_TARGET_RADIUS + 1, color);
+  display_drawFastVLine(x, y - DISPLAY_TOUCH_CALIBRATION_TARGET_RADIUS, 2 * DISPLAY_TOUCH_CALIBRATION_TARGET_RADIUS + 1, color);
+  display_drawCircle(x, y, DISPLAY_TOUCH_CALIBRATION_TARGET_RADIUS / 2, color);
+}
+
+// Averages the raw samples of the next complete touch.
+static void display_waitForCalibrationTouch(int32_t *rawX, int32_t *rawY) {
+  display_touchEvent_t event;
+  int32_t sumX = 0, sumY = 0, count = 0;
+  display_clearOldTouchData();
+  while (true) {
+    if (!display_getTouchEvent(&event))
+      continue;
+    if (event.type == DISPLAY_TOUCH_DOWN)
+      sumX = sumY = count = 0;
+    if (event.type == DISPLAY_TOUCH_UP && count)
+      break;
+    if (event.type != DISPLAY_TOUCH_UP) {
+      sumX += event.rawX;
+      sumY += event.rawY;
+      count++;
+    }
+  }
+  *rawX = (sumX + count / 2) / count;
+  *rawY = (sumY + count / 2) / count;
+}
+
+// Targets near three corners, far enough apart for a well-conditioned fit.
+bool display_runTouchCalibration(display_touchCalibration_t *calibration) {
+  static const int32_t lcd[DISPLAY_TOUCH_CALIBRATION_POINTS][2] = {
+    {LCD_WIDTH / 10, LCD_HEIGHT / 10}, {LCD_WIDTH * 9 / 10, LCD_HEIGHT / 2}, {LCD_WIDTH / 2, LCD_HEIGHT * 9 / 10}};
+  int32_t raw[DISPLAY_TOUCH_CALIBRATION_POINTS][2];
+  // The targets have to be on the screen while it waits for the touches: queued drawing (which
+  // this finishes first) is off until the end.
+  bool wasQueued = display_isQueuedMode();
+  display_setQueuedMode(false);
+  display_fillScreen(DISPLAY_BLACK);
+  display_setTextColor(DISPLAY_WHITE);
+  display_setTextSize(DISPLAY_TOUCH_CALIBRATION_TEXT_SIZE);
+  display_setCursor(LCD_WIDTH / 4, LCD_HEIGHT / 3);
+  display_println("Touch each target");
+  for (int i = 0; i < DISPLAY_TOUCH_CALIBRATION_POINTS; i++) {
+    display_drawCalibrationTarget(lcd[i][0], lcd[i][1], DISPLAY_WHITE);
+    display_waitForCalibrationTouch(&raw[i][0], &raw[i][1]);
+    display_drawCalibrationTarget(lcd[i][0], lcd[i][1], DISPLAY_BLACK);
+  }
+  display_fillScreen(DISPLAY_BLACK);
+  display_setQueuedMode(wasQueued);
+  display_touchCalibration_t fitted;
+  if (!display_fitTouchCalibration(raw, lcd, &fitted) || !display_setTouchCalibration(&fitted))
+    return false;
+  if (calibration)
+    *calibration = fitted;
+  return true;
 }
 
 // Returns the x-y coordinate of the touched point and the pressure (z).
+// With the touch interrupt running, this is the latest sample the ISR has seen.
 void display_getTouchedPoint(int16_t *x, int16_t *y, uint8_t *z) {
-  touchController.readData(x, y, z);
+  if (display_isTouchStateCurrent()) {
+    *x = lastTouchX;
+    *y = lastTouchY;
+    *z = lastTouchZ;
+  } else {
+    touchController.readData(x, y, z);
+  }
   display_mapToLcdCoordinates(x, y);
 }
 
-// Throws away all previous touch data.
+// Throws away all previous touch data, including any queued events.
 void display_clearOldTouchData() {
-  touchController.clearOldTouchData();
+  if (!display_isTouchStateCurrent())
+    touchController.clearOldTouchData();
+  touchEventTail = touchEventHead;
+}
+
+// Events are recorded as they are produced, ahead of the queue: a replay goes through the queue again.
+static void display_recordTouchEvent(display_touchEventType_t type, uint64_t timestamp) {
+  display_touchRecordingHeader_t *header = touchRecordingHeader;
+  if (!header)
+    return;
+  if (header->count == touchRecordCapacity) {
+    header->droppedCount++;
+    return;
+  }
+  uint64_t time = (timestamp - touchRecordingStartTime) >> DISPLAY_TOUCH_RECORD_TIME_SHIFT;
+  display_touchRecord_t *record = &touchRecords[header->count];
+  record->typeAndTime = (uint32_t) type << 30 | (time < DISPLAY_TOUCH_RECORD_MAX_TIME ? time : DISPLAY_TOUCH_RECORD_MAX_TIME);
+  record->sample = (uint32_t) lastTouchZ << 24 | (uint32_t) (lastTouchX & 0xFFF) << 12 | (lastTouchY & 0xFFF);
+  header->count++;
+}
+
+// Adds an event, keeping the stream well formed when the queue is nearly full: MOVEs give
+// way to DOWN/UP, and once a DOWN is dropped the rest of that touch is dropped with it.
+static void display_queueTouchEvent(display_touchEventType_t type) {
+  uint64_t timestamp = globalTimer_getTimerValue();
+  display_recordTouchEvent(type, timestamp);
+  uint32_t head = touchEventHead;
+  uint32_t freeSlots = DISPLAY_TOUCH_EVENT_QUEUE_SIZE - (head - touchEventTail);
+  bool fits;
+  switch (type) {
+  case DISPLAY_TOUCH_DOWN:
+    fits = freeSlots >= DISPLAY_TOUCH_EVENT_SLOTS_FOR_DOWN;
+    touchDownQueued = fits;
+    break;
+  case DISPLAY_TOUCH_MOVE:
+    fits = touchDownQueued && freeSlots >= DISPLAY_TOUCH_EVENT_SLOTS_FOR_MOVE;
+    break;
+  default:
+    fits = touchDownQueued;
+    touchDownQueued = false;
+    break;
+  }
+  if (!fits) {
+    touchEventOverflowCount++;
+    return;
+  }
+  display_touchEvent_t *event = &touchEvents[head & DISPLAY_TOUCH_EVENT_QUEUE_MASK];
+  event->type = type;
+  event->x = lastTouchX;
+  event->y = lastTouchY;
+  event->z = lastTouchZ;
+  event->timestamp = timestamp;
+  __sync_synchronize();  // The event must be complete before the consumer can see it.
+  touchEventHead = head + 1;
+  trace_write(TRACE_SOURCE_DISPLAY, TRACE_EVENT_TOUCH_EVENT, 0, 0,
+              (uint32_t) type << 24 | (uint32_t) (lastTouchX & 0xFFF) << 12 | (lastTouchY & 0xFFF));
+}
+
+// Samples go through a filter before they become events. Samples with z outside the pressure
+// band come from a contact that is still making or breaking and are dropped. The rest are
+// median-filtered per axis over the last DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH samples, which
+// removes single-sample spikes. The touch is reported (DOWN) as soon as
+// DISPLAY_TOUCH_FILTER_AGREEING_MEDIANS consecutive medians lie within
+// DISPLAY_TOUCH_FILTER_TOLERANCE raw counts of each other; every median after that is a MOVE.
+// With the 6 ms sample period set up by Adafruit_STMPE610::begin(), a steady touch is
+// reported after 4 samples. A touch that never settles is never reported, and neither is its
+// release. Integer only: this runs in the SPI callbacks.
+#define DISPLAY_TOUCH_FILTER_MIN_Z 8               // 0 is an open panel.
+#define DISPLAY_TOUCH_FILTER_MAX_Z 250             // Saturated.
+#define DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH 3       // Odd.
+#define DISPLAY_TOUCH_FILTER_AGREEING_MEDIANS 2
+#define DISPLAY_TOUCH_FILTER_TOLERANCE 40          // Raw counts, about 3 LCD pixels.
+
+static int16_t touchFilterX[DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH];
+static int16_t touchFilterY[DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH];
+static uint8_t touchFilterZ[DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH];
+static uint32_t touchFilterSampleCount = 0;  // Accepted samples in the current touch.
+static uint8_t touchFilterAgreeingCount = 0;
+static int16_t touchFilterMedianX, touchFilterMedianY;
+
+// Insertion sort of a copy; the window is only a few samples long.
+static int16_t display_median(const int16_t *values) {
+  int16_t sorted[DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH];
+  for (int i = 0; i < DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH; i++) {
+    int j = i;
+    for (; j > 0 && sorted[j - 1] > values[i]; j--)
+      sorted[j] = sorted[j - 1];
+    sorted[j] = values[i];
+  }
+  return sorted[DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH / 2];
+}
+
+static bool display_isWithinTouchFilterTolerance(int16_t a, int16_t b) {
+  return a - b <= DISPLAY_TOUCH_FILTER_TOLERANCE && b - a <= DISPLAY_TOUCH_FILTER_TOLERANCE;
+}
+
+static void display_filterTouchSample(int16_t x, int16_t y, uint8_t z) {
+  if (z < DISPLAY_TOUCH_FILTER_MIN_Z || z > DISPLAY_TOUCH_FILTER_MAX_Z)
+    return;
+  uint32_t slot = touchFilterSampleCount++ % DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH;
+  touchFilterX[slot] = x;
+  touchFilterY[slot] = y;
+  touchFilterZ[slot] = z;
+  if (touchFilterSampleCount < DISPLAY_TOUCH_FILTER_MEDIAN_LENGTH)
+    return;
+  int16_t medianX = display_median(touchFilterX);
+  int16_t medianY = display_median(touchFilterY);
+  if (!touchIsDown) {
+    bool agrees = touchFilterAgreeingCount &&
+                  display_isWithinTouchFilterTolerance(medianX, touchFilterMedianX) &&
+                  display_isWithinTouchFilterTolerance(medianY, touchFilterMedianY);
+    touchFilterAgreeingCount = agrees ? touchFilterAgreeingCount + 1 : 1;
+    touchFilterMedianX = medianX;
+    touchFilterMedianY = medianY;
+    if (touchFilterAgreeingCount < DISPLAY_TOUCH_FILTER_AGREEING_MEDIANS)
+      return;
+  }
+  lastTouchX = medianX;
+  lastTouchY = medianY;
+  lastTouchZ = touchFilterZ[slot];
+  display_queueTouchEvent(touchIsDown ? DISPLAY_TOUCH_MOVE : DISPLAY_TOUCH_DOWN);
+  touchIsDown = true;
+}
+
+static void display_resetTouchFilter() {
+  touchFilterSampleCount = 0;
+  touchFilterAgreeingCount = 0;
+}
+
+// Reading the controller is a chain of asynchronous SPI requests, so that the touch ISR returns
+// right away and the transfers overlap with whatever the main loop is doing:
+//   1. clear INT_STA (interrupt mode only: a sample or a release that shows up after this
+//      raises the line again instead of getting lost),
+//   2. read TSC_CTRL (only while a touch is in progress: that is all it is needed for, noticing
+//      the release, and it has to be read before the FIFO so that no sample comes after the UP),
+//   3. read FIFO_SIZE,
+//   4. burst reads of the FIFO data port, DISPLAY_TOUCH_SAMPLES_PER_READ samples at a time.
+// Each request's callback submits the next one. Raw coordinates are queued; mapping to the LCD
+// happens on the consumer side so that the callbacks stay out of floating point.
+#define DISPLAY_TOUCH_REGISTER_READ_SIZE (STMPE_SPI_READ_HEADER_SIZE + 1)
+#define DISPLAY_TOUCH_FIFO_READ_SIZE (STMPE_SPI_READ_HEADER_SIZE + DISPLAY_TOUCH_SAMPLES_PER_READ * STMPE_FIFO_BYTES_PER_SAMPLE)
+
+static const uint8_t touchClearTx[] = {STMPE_INT_STA, 0xFF};
+static const uint8_t touchDetectTx[DISPLAY_TOUCH_REGISTER_READ_SIZE] = {STMPE_SPI_READ | STMPE_TSC_CTRL};
+static uint8_t touchDetectRx[DISPLAY_TOUCH_REGISTER_READ_SIZE];
+static const uint8_t touchSizeTx[DISPLAY_TOUCH_REGISTER_READ_SIZE] = {STMPE_SPI_READ | STMPE_FIFO_SIZE};
+static uint8_t touchSizeRx[DISPLAY_TOUCH_REGISTER_READ_SIZE];
+static const uint8_t touchFifoTx[DISPLAY_TOUCH_FIFO_READ_SIZE] = {STMPE_SPI_READ | STMPE_TSC_DATA_NON_INC};
+static uint8_t touchFifoRx[DISPLAY_TOUCH_FIFO_READ_SIZE];
+static spi_request_t touchClearRequest, touchDetectRequest, touchSizeRequest, touchFifoRequest;
+static volatile bool touchReadInFlight = false;
+static bool touchReleaseChecked;  // Whether this pass read TSC_CTRL.
+static uint8_t touchSamplesLeft;  // FIFO samples still to be read in this pass.
+
+// Releases are only noticed once every sample taken before the TSC_CTRL read has been queued.
+static void display_finishTouchRead() {
+  if (touchReleaseChecked && !(touchDetectRx[STMPE_SPI_READ_HEADER_SIZE] & STMPE_TSC_CTRL_TOUCH_DET)) {
+    if (touchIsDown)
+      display_queueTouchEvent(DISPLAY_TOUCH_UP);
+    touchIsDown = false;
+    display_resetTouchFilter();
+  }
+  touchReadInFlight = false;
+  if (touchInterruptsEnabled)
+    interrupts_unmaskTouchInt();
+}
+
+static void display_submitTouchFifoRead() {
+  uint8_t count = touchSamplesLeft < DISPLAY_TOUCH_SAMPLES_PER_READ ? touchSamplesLeft : DISPLAY_TOUCH_SAMPLES_PER_READ;
+  touchFifoRequest.count = STMPE_SPI_READ_HEADER_SIZE + count * STMPE_FIFO_BYTES_PER_SAMPLE;
+  spi_submit(&touchFifoRequest);
+}
+
+static void display_touchSizeRead(spi_request_t *request) {
+  touchSamplesLeft = touchSizeRx[STMPE_SPI_READ_HEADER_SIZE];
+  if (touchSamplesLeft)
+    display_submitTouchFifoRead();
+  else
+    display_finishTouchRead();
+}
+
+static void display_touchFifoRead(spi_request_t *request) {
+  uint8_t count = (request->count - STMPE_SPI_READ_HEADER_SIZE) / STMPE_FIFO_BYTES_PER_SAMPLE;
+  for (uint8_t i = 0; i < count; i++) {
+    int16_t x, y;
+    uint8_t z;
+    Adafruit_STMPE610::unpackFifoSample(&touchFifoRx[STMPE_SPI_READ_HEADER_SIZE + i * STMPE_FIFO_BYTES_PER_SAMPLE], &x, &y, &z);
+    display_filterTouchSample(x, y, z);
+  }
+  touchSamplesLeft -= count;
+  if (touchSamplesLeft)
+    display_submitTouchFifoRead();
+  else
+    display_finishTouchRead();
+}
+
+static void display_initTouchRequests() {
+  touchController.initRequest(&touchClearRequest);
+  touchClearRequest.tx = touchClearTx;
+  touchClearRequest.rx = NULL;
+  touchClearRequest.count = sizeof(touchClearTx);
+  touchClearRequest.callback = NULL;
+  touchController.initRequest(&touchDetectRequest);
+  touchDetectRequest.tx = touchDetectTx;
+  touchDetectRequest.rx = touchDetectRx;
+  touchDetectRequest.count = sizeof(touchDetectTx);
+  touchDetectRequest.callback = NULL;
+  touchController.initRequest(&touchSizeRequest);
+  touchSizeRequest.tx = touchSizeTx;
+  touchSizeRequest.rx = touchSizeRx;
+  touchSizeRequest.count = sizeof(touchSizeTx);
+  touchSizeRequest.callback = display_touchSizeRead;
+  touchController.initRequest(&touchFifoRequest);
+  touchFifoRequest.tx = touchFifoTx;
+  touchFifoRequest.rx = touchFifoRx;
+  touchFifoRequest.callback = display_touchFifoRead;
+}
+
+// Starts a pass over the controller unless one is already running. Without the SPI interrupt
+// nothing would move the chain along later, so it is polled to completion right here.
+static void display_startTouchRead() {
+  if (touchReadInFlight)
+    return;
+  touchReadInFlight = true;
+  if (touchInterruptsEnabled)
+    spi_submit(&touchClearRequest);
+  touchReleaseChecked = touchIsDown || touchFilterSampleCount;
+  if (touchReleaseChecked)
+    spi_submit(&touchDetectRequest);
+  spi_submit(&touchSizeRequest);
+  if (!spi_isInterruptDriven())
+    spi_waitUntilIdle();
+}
+
+void display_touchIsr() {
+  trace_write(TRACE_SOURCE_DISPLAY, TRACE_EVENT_TOUCH_ISR, 0, 0, !touchReadInFlight);
+  if (touchReplaying) {
+    // The replay queued the events before it raised the interrupt.
+    if (touchInterruptsEnabled)
+      interrupts_unmaskTouchInt();
+    return;
+  }
+  display_startTouchRead();
+}
+
+void display_enableTouchInterrupts(bool enable) {
+  spi_waitUntilIdle();  // Let a pass that started in the other mode finish first.
+  touchController.writeRegister8(STMPE_INT_EN, enable ? STMPE_INT_EN_TOUCHDET | STMPE_INT_EN_FIFOTH : STMPE_INT_EN_TOUCHDET);
+  touchController.writeRegister8(STMPE_INT_STA, 0xFF);
+  touchInterruptsEnabled = enable;
+  if (enable)
+    display_touchIsr();  // Pick up anything that arrived before the line was being watched.
+}
+
+bool display_getTouchEvent(display_touchEvent_t *event) {
+  if (!display_isTouchStateCurrent() && touchEventTail == touchEventHead)
+    display_startTouchRead();  // Without the interrupt, refill the queue once it runs dry.
+  uint32_t tail = touchEventTail;
+  if (tail == touchEventHead)
+    return false;
+  __sync_synchronize();  // Don't read the event before seeing the head that published it.
+  *event = touchEvents[tail & DISPLAY_TOUCH_EVENT_QUEUE_MASK];
+  touchEventTail = tail + 1;
+  event->rawX = event->x;
+  event->rawY = event->y;
+  display_mapToLcdCoordinates(&event->x, &event->y);
+  return true;
+}
+
+uint32_t display_getTouchEventOverflowCount() {
+  return touchEventOverflowCount;
+}
+
+// The header goes out first so that the ISR never sees records without the rest of the setup.
+void display_startTouchRecording(display_touchRecordingHeader_t *header, display_touchRecord_t *records,
+                                 uint32_t capacity) {
+  display_stopTouchRecording();
+  header->magic = DISPLAY_TOUCH_RECORDING_MAGIC;
+  header->timerTicksPerSecond = GLOBAL_TIMER_TICKS_PER_SECOND;
+  header->count = 0;
+  header->droppedCount = 0;
+  touchRecords = records;
+  touchRecordCapacity = capacity;
+  touchRecordingStartTime = globalTimer_getTimerValue();
+  __sync_synchronize();
+  touchRecordingHeader = header;
+}
+
+void display_stopTouchRecording() {
+  touchRecordingHeader = NULL;
+  __sync_synchronize();
+}
+
+// Waits for a pass over the controller that is already running, so that its events don't mix
+// with the replayed ones, and forgets any touch in progress.
+void display_startTouchReplay() {
+  spi_waitUntilIdle();
+  touchReplaying = true;
+  touchIsDown = false;
+  touchDownQueued = false;
+  display_resetTouchFilter();
+}
+
+// The producer side, like display_touchIsr(): nothing that queues events may preempt it.
+void display_replayTouchRecord(const display_touchRecord_t *record) {
+  display_touchEventType_t type = display_getTouchRecordType(record);
+  if (type > DISPLAY_TOUCH_UP)
+    return;
+  lastTouchZ = record->sample >> 24;
+  lastTouchX = (record->sample >> 12) & 0xFFF;
+  lastTouchY = record->sample & 0xFFF;
+  display_queueTouchEvent(type);
+  touchIsDown = type != DISPLAY_TOUCH_UP;
 }
 
 // Display test routines, just adapted from the original Adafruit code.
@@ -232,72 +1147,99 @@ void display_clearOldTouchData() {
 // quick hack for min - to be used for these test functions only.
 #define min(x, y) ((x) < (y) ? (x) : (y))
 
+// The test routines return their elapsed time in microseconds, as the Adafruit originals do.
+// On the board the time comes from the global timer. On the host it is the modeled LCD bus time
+// (hostSim/hostSimLcd.h), i.e. what the same drawing calls cost on the board's bus.
+static unsigned long display_getMicroseconds() {
+#ifdef HOST_SIM
+  hostSimLcd_counts_t counts;
+  hostSimLcd_getCounts(&counts);
+  return counts.busTimeNs / 1000;
+#else
+  return globalTimer_getTimerValue() / (GLOBAL_TIMER_TICKS_PER_SECOND / 1000000);
+#endif
+}
+
 unsigned long display_testLines(uint16_t color) {
+  unsigned long start, t;
   int           x1, y1, x2, y2,
                 w = display_width(),
                 h = display_height();
 
   display_fillScreen(DISPLAY_BLACK);
 
+  start = display_getMicroseconds();
   x1 = y1 = 0;
   y2    = h - 1;
   for(x2=0; x2<w; x2+=6) display_drawLine(x1, y1, x2, y2, color);
   x2    = w - 1;
   for(y2=0; y2<h; y2+=6) display_drawLine(x1, y1, x2, y2, color);
+  t = display_getMicroseconds() - start;
 
   display_fillScreen(DISPLAY_BLACK);
 
+  start = display_getMicroseconds();
   x1    = w - 1;
   y1    = 0;
   y2    = h - 1;
   for(x2=0; x2<w; x2+=6) display_drawLine(x1, y1, x2, y2, color);
   x2    = 0;
   for(y2=0; y2<h; y2+=6) display_drawLine(x1, y1, x2, y2, color);
+  t += display_getMicroseconds() - start;
 
   display_fillScreen(DISPLAY_BLACK);
 
+  start = display_getMicroseconds();
   x1    = 0;
   y1    = h - 1;
   y2    = 0;
   for(x2=0; x2<w; x2+=6) display_drawLine(x1, y1, x2, y2, color);
   x2    = w - 1;
   for(y2=0; y2<h; y2+=6) display_drawLine(x1, y1, x2, y2, color);
+  t += display_getMicroseconds() - start;
 
   display_fillScreen(DISPLAY_BLACK);
 
+  start = display_getMicroseconds();
   x1    = w - 1;
   y1    = h - 1;
   y2    = 0;
   for(x2=0; x2<w; x2+=6) display_drawLine(x1, y1, x2, y2, color);
   x2    = 0;
   for(y2=0; y2<h; y2+=6) display_drawLine(x1, y1, x2, y2, color);
-  return 0;
+  t += display_getMicroseconds() - start;
+  return t;
 }
 
 unsigned long display_testFastLines(uint16_t color1, uint16_t color2) {
+  unsigned long start;
   int           x, y, w = display_width(), h = display_height();
 
   display_fillScreen(DISPLAY_BLACK);
+  start = display_getMicroseconds();
   for(y=0; y<h; y+=5) display_drawFastHLine(0, y, w, color1);
   for(x=0; x<w; x+=5) display_drawFastVLine(x, 0, h, color2);
-  return 0;
+  return display_getMicroseconds() - start;
 }
 
 unsigned long display_testRects(uint16_t color) {
+  unsigned long start;
   int           n, i, i2,
                 cx = display_width()  / 2,
                 cy = display_height() / 2;
 
   display_fillScreen(DISPLAY_BLACK);
+  start = display_getMicroseconds();
   n     = min(display_width(), display_height());
   for(i=2; i<n; i+=6) {
     i2 = i / 2;
     display_drawRect(cx-i2, cy-i2, i, i, color);
   }
-  return 0;
+  return display_getMicroseconds() - start;
 }
 
 unsigned long display_testFilledRects(uint16_t color1, uint16_t color2) {
+  unsigned long start, t = 0;
   int           n, i, i2,
                 cx = display_width()  / 2 - 1,
                 cy = display_height() / 2 - 1;
@@ -306,30 +1248,36 @@ unsigned long display_testFilledRects(uint16_t color1, uint16_t color2) {
   n = min(display_width(), display_height());
   for(i=n; i>0; i-=6) {
     i2    = i / 2;
+    start = display_getMicroseconds();
     display_fillRect(cx-i2, cy-i2, i, i, color1);
+    t    += display_getMicroseconds() - start;
     // Outlines are not included in timing results
     display_drawRect(cx-i2, cy-i2, i, i, color2);
   }
-  return 0;
+  return t;
 }
 
 unsigned long display_testFilledCircles(uint8_t radius, uint16_t color) {
+  unsigned long start;
   int x, y, w = display_width(), h = display_height(), r2 = radius * 2;
 
   display_fillScreen(DISPLAY_BLACK);
+  start = display_getMicroseconds();
   for(x=radius; x<w; x+=r2) {
     for(y=radius; y<h; y+=r2) {
       display_fillCircle(x, y, radius, color);
     }
   }
-  return 0;
+  return display_getMicroseconds() - start;
 }
 
 unsigned long display_testCircles(uint8_t radius, uint16_t color) {
+  unsigned long start;
   int           x, y, r2 = radius * 2,
                 w = display_width()  + radius,
                 h = display_height() + radius;
 
+  start = display_getMicroseconds();
   // Screen is not cleaDISPLAY_RED for this one -- this is
   // intentional and does not affect the reported time.
   for(x=0; x<w; x+=r2) {
@@ -337,14 +1285,16 @@ unsigned long display_testCircles(uint8_t radius, uint16_t color) {
       display_drawCircle(x, y, radius, color);
     }
   }
-  return 0;
+  return display_getMicroseconds() - start;
 }
 
 unsigned long display_testTriangles() {
+  unsigned long start;
   int           n, i, cx = display_width()  / 2 - 1,
                       cy = display_height() / 2 - 1;
 
   display_fillScreen(DISPLAY_BLACK);
+  start = display_getMicroseconds();
   n     = min(cx, cy);
   for(i=0; i<n; i+=5) {
     display_drawTriangle(
@@ -353,61 +1303,71 @@ unsigned long display_testTriangles() {
       cx + i, cy + i, // bottom right
       display_color565(0, 0, i));
   }
-  return 0;
+  return display_getMicroseconds() - start;
 }
 
 unsigned long display_testFilledTriangles() {
+  unsigned long start, t = 0;
   int           i, cx = display_width()  / 2 - 1,
                    cy = display_height() / 2 - 1;
 
   display_fillScreen(DISPLAY_BLACK);
   for(i=min(cx,cy); i>10; i-=5) {
+    start = display_getMicroseconds();
     display_fillTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
       display_color565(0, i, i));
+    t    += display_getMicroseconds() - start;
     display_drawTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
       display_color565(i, i, 0));
   }
-  return 0;
+  return t;
 }
 
 unsigned long display_testRoundRects() {
+  unsigned long start;
   int           w, i, i2,
                 cx = display_width()  / 2 - 1,
                 cy = display_height() / 2 - 1;
 
   display_fillScreen(DISPLAY_BLACK);
+  start = display_getMicroseconds();
   w     = min(display_width(), display_height());
   for(i=0; i<w; i+=6) {
     i2 = i / 2;
     display_drawRoundRect(cx-i2, cy-i2, i, i, i/8, display_color565(i, 0, 0));
   }
-  return 0;
+  return display_getMicroseconds() - start;
 }
 
 unsigned long display_testFilledRoundRects() {
+  unsigned long start;
   int           i, i2,
                 cx = display_width()  / 2 - 1,
                 cy = display_height() / 2 - 1;
 
   display_fillScreen(DISPLAY_BLACK);
+  start = display_getMicroseconds();
   for(i=min(display_width(), display_height()); i>20; i-=6) {
     i2 = i / 2;
     display_fillRoundRect(cx-i2, cy-i2, i, i, i/8, display_color565(0, i, 0));
   }
-  return 0;
+  return display_getMicroseconds() - start;
 }
 
 unsigned long display_testFillScreen() {
+  unsigned long start = display_getMicroseconds();
   display_fillScreen(DISPLAY_BLACK);
   display_fillScreen(DISPLAY_RED);
   display_fillScreen(DISPLAY_GREEN);
   display_fillScreen(DISPLAY_BLUE);
   display_fillScreen(DISPLAY_BLACK);
-  return 0;
+  return display_getMicroseconds() - start;
 }
 
 unsigned long display_testText() {
+  unsigned long start;
   display_fillScreen(DISPLAY_BLACK);
+  start = display_getMicroseconds();
   display_setCursor(0, 0);
   display_setTextColor(DISPLAY_WHITE);  display_setTextSize(1);
   display_println("Hello World!");
@@ -429,11 +1389,68 @@ unsigned long display_testText() {
   display_println("in the gobberwarts");
   display_println("with my blurglecruncheon,");
   display_println("see if I don't!");
-  return 0;
+  return display_getMicroseconds() - start;
 }
 
+// Benchmark wrappers: each runs one test routine with the arguments used by the Adafruit
+// graphicstest sketch.
+#define DISPLAY_BENCHMARK_CIRCLE_RADIUS 10
 
+static unsigned long display_benchmarkLines() { return display_testLines(DISPLAY_CYAN); }
+static unsigned long display_benchmarkFastLines() { return display_testFastLines(DISPLAY_RED, DISPLAY_BLUE); }
+static unsigned long display_benchmarkRects() { return display_testRects(DISPLAY_GREEN); }
+static unsigned long display_benchmarkFilledRects() { return display_testFilledRects(DISPLAY_YELLOW, DISPLAY_MAGENTA); }
+static unsigned long display_benchmarkFilledCircles() {
+  return display_testFilledCircles(DISPLAY_BENCHMARK_CIRCLE_RADIUS, DISPLAY_MAGENTA);
+}
+static unsigned long display_benchmarkCircles() {
+  return display_testCircles(DISPLAY_BENCHMARK_CIRCLE_RADIUS, DISPLAY_WHITE);
+}
 
-
-
-
+typedef struct {
+  const char *name;
+  unsigned long (*run)();
+} display_benchmark_t;
+
+static const display_benchmark_t display_benchmarks[] = {
+  {"testFillScreen", display_testFillScreen},
+  {"testText", display_testText},
+  {"testLines", display_benchmarkLines},
+  {"testFastLines", display_benchmarkFastLines},
+  {"testRects", display_benchmarkRects},
+  {"testFilledRects", display_benchmarkFilledRects},
+  {"testFilledCircles", display_benchmarkFilledCircles},
+  {"testCircles", display_benchmarkCircles},
+  {"testTriangles", display_testTriangles},
+  {"testFilledTriangles", display_testFilledTriangles},
+  {"testRoundRects", display_testRoundRects},
+  {"testFilledRoundRects", display_testFilledRoundRects},
+};
+#define DISPLAY_BENCHMARK_COUNT (sizeof(display_benchmarks) / sizeof(display_benchmark_t))
+
+// Runs every test routine runCount times and prints one CSV row per routine, so that results can be
+// diffed across driver changes. Times are in microseconds; stddev is over the runs.
+void display_runBenchmarks(uint16_t runCount) {
+  display_init();
+#ifndef HOST_SIM
+  globalTimer_startTimer(false);  // The time source for the test routines.
+#endif
+  printf("benchmark,runs,mean_us,stddev_us,min_us,max_us\n\r");
+  for (uint32_t i = 0; i < DISPLAY_BENCHMARK_COUNT; i++) {
+    double sum = 0, sumOfSquares = 0;
+    unsigned long minTime = 0, maxTime = 0;
+    for (uint16_t run = 0; run < runCount; run++) {
+      unsigned long time = display_benchmarks[i].run();
+      sum += time;
+      sumOfSquares += (double) time * time;
+      if (run == 0 || time < minTime)
+        minTime = time;
+      if (run == 0 || time > maxTime)
+        maxTime = time;
+    }
+    double mean = runCount ? sum / runCount : 0;
+    double variance = runCount ? sumOfSquares / runCount - mean * mean : 0;
+    printf("%s,%u,%.1f,%.1f,%lu,%lu\n\r", display_benchmarks[i].name, runCount, mean,
+        sqrt(variance > 0 ? variance : 0), minTime, maxTime);
+  }
+}
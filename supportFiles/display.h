@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include "globalTimer.h"
 
 #define DISPLAY_DEC 10
 #define DISPLAY_HEX 16
@@ -66,6 +67,37 @@ void
   int16_t display_width();
   uint16_t display_color565(uint8_t r, uint8_t g, uint8_t b);  // Packs r,g,b into 16 bits.
 
+  // Optional off-screen frame buffer. While it is enabled, drawing goes to a 320x240 RGB565 copy of
+  // the screen in memory and only reaches the panel when display_flush() sends the regions that
+  // changed. Enabling starts from an all-black picture; disabling flushes first.
+  void display_setFrameBufferEnabled(bool enable);
+  bool display_isFrameBufferEnabled();
+  void display_flush();
+  // Reads a pixel back: from memory when the frame buffer is enabled, otherwise from the panel.
+  uint16_t display_readPixel(int16_t x, int16_t y);
+
+  // Optional queued drawing. While it is enabled, the drawing and text calls above only append a
+  // command (about 20 bytes) to a ring and return; display_drainCommands() does the drawing later,
+  // from idle time, in steps of about half a millisecond (large fills go a band of rows at a
+  // time, text a character at a time). Order is kept. Calls that return something from the panel
+  // or change its geometry (display_readPixel(), display_setRotation(), the frame buffer
+  // switch and the println() of numbers) finish the queue first and run right away. A call that
+  // finds the ring full draws from it until there is room. Bitmaps are drawn from the caller's memory when their turn
+  // comes, so they must stay put until then.
+  #define DISPLAY_COMMAND_QUEUE_SIZE 128        // Power of two.
+  #define DISPLAY_COMMAND_SLICE_SECONDS 2E-3   // Suggested idle slice for display_drainCommands().
+  // Disabling finishes everything that is queued first.
+  void display_setQueuedMode(bool enable);
+  bool display_isQueuedMode();
+  bool display_hasQueuedCommands();
+  // Draws until the queue is empty or the global timer reaches endTime, and at least one step if the
+  // queue isn't empty. A step that has started is finished, so endTime can be overshot by up
+  // to a step. Returns true if commands are left.
+  bool display_drainCommands(uint64_t endTime);
+  // Draws everything that is queued.
+  void display_finishCommands();
+  // Number of calls that found the ring full and had to wait for room.
+  uint32_t display_getCommandQueueStallCount();
   // Print routines
   size_t display_println(const char str[]);
   size_t display_println(char c);
@@ -90,6 +122,9 @@ void
   unsigned long display_testFilledRoundRects();
   unsigned long display_testFillScreen();
   unsigned long display_testText();
+  // Runs each of the test routines above runCount times and prints a CSV table of the elapsed times
+  // (microseconds, from the global timer on the board, from the LCD bus model on the host).
+  void display_runBenchmarks(uint16_t runCount);
 
 // The functionality for these routines comes from Adafruit_STMPE610 (touch controller).
 // True if the display is being touched.
@@ -99,5 +134,123 @@ void display_getTouchedPoint(int16_t *x, int16_t *y, uint8_t *z);
 // Throws away all previous touch data.
 void display_clearOldTouchData();
 
+// Touch events. The touch controller's FIFO is drained into a queue of timestamped events,
+// either by display_touchIsr() (when the STMPE610 INT line is hooked up, see interrupts.c)
+// or, without the interrupt, by display_getTouchEvent() itself. Samples are pressure-gated
+// and median-filtered on the way (see display.cpp), so event positions can be trusted as is.
+typedef enum {
+  DISPLAY_TOUCH_DOWN,  // The touch has settled: consecutive filtered samples agree.
+  DISPLAY_TOUCH_MOVE,  // Every following filtered sample while the touch lasts.
+  DISPLAY_TOUCH_UP     // Touch released; x, y and z repeat the last sample.
+} display_touchEventType_t;
+
+typedef struct {
+  display_touchEventType_t type;
+  int16_t x, y;        // LCD coordinates.
+  int16_t rawX, rawY;  // The same point in raw touch-controller coordinates (12-bit ADC).
+  uint8_t z;           // Pressure.
+  uint64_t timestamp;  // Global-timer ticks when the sample was read out of the controller.
+} display_touchEvent_t;
+
+// Removes the oldest event from the queue. Returns false if there isn't one.
+bool display_getTouchEvent(display_touchEvent_t *event);
+// Drains the touch controller into the event queue. Connected to the GIC by interrupts.c.
+// With the SPI interrupt running (interrupts_enableSpiGlobalInts()) this only starts the
+// transfers, and the events arrive once they complete.
+void display_touchIsr();
+// Tells the display that display_touchIsr() is running off of the touch interrupt, so that
+// the touch functions above stop reading the controller and use the queue instead. Call it
+// before the ARM interrupts are enabled (interrupts_enableTouchGlobalInts() does).
+void display_enableTouchInterrupts(bool enable);
+// Number of events dropped because the queue was full.
+uint32_t display_getTouchEventOverflowCount();
+
+// Touch recording and replay. With the touch interrupt running, display_isTouched() and
+// display_getTouchedPoint() only ever change when an event is queued, so a recording of the
+// events, timed from when it started, is all of the touch input a session saw. Without it
+// (polled mode), display_isTouched() reads the controller directly and those touches are not
+// recorded. Each event takes 8 bytes. A recording file is the header followed by the records,
+// as they are in memory (little endian): on the board, keep the two next to each other and
+// save them with the debugger; on the host, see hostSim/hostSimReplay.h.
+// Replaying feeds recorded events into the queue in place of the touch controller, which is
+// no longer read, so buttonHandler and simonControl see the recorded session.
+#define DISPLAY_TOUCH_RECORDING_MAGIC 0x54524332     // "TRC2"
+#define DISPLAY_TOUCH_RECORD_TIME_SHIFT 16           // Record times are global-timer ticks >> 16 (about 0.2 ms).
+#define DISPLAY_TOUCH_RECORD_MAX_TIME 0x3FFFFFFF     // 30 bits: 60 hours.
+
+typedef struct {
+  uint32_t magic;                // DISPLAY_TOUCH_RECORDING_MAGIC.
+  uint32_t timerTicksPerSecond;  // Of the global timer that timed the records, before the shift.
+  uint32_t count;                // Records that follow.
+  uint32_t droppedCount;         // Events that didn't fit.
+} display_touchRecordingHeader_t;
+
+typedef struct {
+  uint32_t typeAndTime;  // Event type in bits 31:30, time since the recording started in 29:0.
+  uint32_t sample;       // z in bits 31:24, raw x in 23:12, raw y in 11:0.
+} display_touchRecord_t;
+
+static inline display_touchEventType_t display_getTouchRecordType(const display_touchRecord_t *record) {
+  return (display_touchEventType_t) (record->typeAndTime >> 30);
+}
+static inline uint32_t display_getTouchRecordTime(const display_touchRecord_t *record) {
+  return record->typeAndTime & DISPLAY_TOUCH_RECORD_MAX_TIME;
+}
+
+// Records every event queued from now on into records (capacity of them) and keeps *header up to
+// date as it goes. Recording goes on during a replay, which records the replayed events.
+void display_startTouchRecording(display_touchRecordingHeader_t *header, display_touchRecord_t *records,
+                                 uint32_t capacity);
+void display_stopTouchRecording();
+// Stops reading the touch controller for good: from now on events only come from
+// display_replayTouchRecord(). The replay backend times the records and, after each one, raises
+// the touch interrupt so that a sleeping core wakes up (display_touchIsr() then reads nothing).
+void display_startTouchReplay();
+// Queues the recorded event now, as if the controller had just produced it.
+void display_replayTouchRecord(const display_touchRecord_t *record);
+
+// Touch calibration. Raw samples map to the LCD through an affine transform in 16.16 fixed
+// point, so the mapping is integer only:
+//   lcdX = (xx * rawX + xy * rawY + x0) >> 16
+//   lcdY = (yx * rawX + yy * rawY + y0) >> 16
+// display_init() starts from the nominal panel calibration unless one has already been set, and
+// later calls leave the calibration alone. There is no non-volatile storage in this design, so
+// persisting a calibration is up to the caller: the record carries a magic number and a checksum,
+// and display_setTouchCalibration() refuses records that don't check out.
+#define DISPLAY_TOUCH_CALIBRATION_FRACTION_BITS 16
+typedef struct {
+  uint32_t magic;
+  int32_t xx, xy, x0;
+  int32_t yx, yy, y0;
+  uint32_t checksum;
+} display_touchCalibration_t;
+
+// Copies out the calibration in use, magic number and checksum filled in.
+void display_getTouchCalibration(display_touchCalibration_t *calibration);
+// Returns false (and keeps the current calibration) if the record is damaged or out of range.
+bool display_setTouchCalibration(const display_touchCalibration_t *calibration);
+// Goes back to the nominal panel calibration.
+void display_resetTouchCalibration();
+// Touch-to-calibrate: shows three targets one after the other and fits the transform to where
+// they were touched (the samples of each touch are averaged). Blocks until all three have been
+// touched and released. Returns false, and keeps the old calibration, if the touches were too
+// close to a straight line to fit. The new calibration is copied to *calibration if not NULL.
+bool display_runTouchCalibration(display_touchCalibration_t *calibration);
+// Changes whenever the calibration does, for code that caches anything derived from it.
+uint32_t display_getTouchCalibrationVersion();
+
+// Hit testing in raw coordinates. A touch line is the image of an LCD column or row in raw
+// touch space under the current calibration, so a raw sample can be classified against it
+// without being mapped. Past a column line means the sample maps to x > column; past a row line
+// means y > row, exactly as the mapping above would have it.
+typedef struct {
+  int32_t rawXScale, rawYScale, offset;
+} display_touchLine_t;
+void display_getTouchLineForColumn(int16_t column, display_touchLine_t *line);
+void display_getTouchLineForRow(int16_t row, display_touchLine_t *line);
+static inline bool display_isPastTouchLine(const display_touchLine_t *line, int16_t rawX, int16_t rawY) {
+  return (int64_t) line->rawXScale * rawX + (int64_t) line->rawYScale * rawY + line->offset >= 0;
+}
+
 
 #endif /* DISPLAY_H_ */
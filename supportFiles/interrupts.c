@@ -8,6 +8,9 @@
 #include "xsysmon.h"                  // Includes for the system monitor (contains the XADC).
 #include "leds.h"                     // Easy LED access functions can be found here.
 #include "supportFiles/globalTimer.h" // global timer routines aid in measuring time.
+#include "display.h"                  // The touch ISR drains the touch controller into display's event queue.
+#include "spi.h"                      // The SPI ISR runs the asynchronous SPI request queue.
+#include "xpseudo_asm.h"              // wfi().
 //#include "intervalTimer.h"
 
 
@@ -29,6 +32,15 @@
 #define INTERRUPTS_ENABLE_HEARTBEAT_LED     // Comment out to disable the LED heart beat.
 #define HEARTBEAT_TOGGLES_PER_SECOND 8     // How many times the LED LD4 heartbeat toggle off and on per second.
 #define INTERRUPTS_ENABLE_ADC_DATA_CAPTURE  // Comment out to disable ADC sample capture to queue.
+// The STMPE610 INT line is only available if the hardware design routes it to the GIC (IRQ_F2P).
+// Without it, display_getTouchEvent() polls the touch controller instead.
+#ifdef XPAR_FABRIC_TOUCH_INT_INTR
+#define INTERRUPTS_ENABLE_TOUCH_INTERRUPT
+#endif
+// Same for the AXI SPI core's interrupt. Without it, spi_poll() runs the asynchronous SPI queue.
+#ifdef XPAR_FABRIC_SPI_0_IP2INTC_IRPT_INTR
+#define INTERRUPTS_ENABLE_SPI_INTERRUPT
+#endif
 
 // ****************** end of #define enable/disable section **********************************************
 
@@ -56,6 +68,13 @@ volatile int interrupts_isrFlagGlobal = 0;
 
 u32 heartBeatTimer = 0;                                           // Used to blink an LED while the program is running.
 u32 isrInvocationCount = 0;                                       // Keep track of number of times ISR is called.
+volatile u32 deviceIsrInvocationCount = 0;                        // Same for all of the other ISRs (touch, SPI, XADC).
+// Timer ISR entry latency, in global timer ticks from the timer's expiry to timerIsr().
+u32 timerIsrLatencyCount = 0;
+u64 timerIsrTotalLatency = 0;
+u32 timerIsrMaxLatency = 0;
+bool privateTimerOneShot = false;  // The counter stops at 0 instead of reloading.
+u64 privateTimerOneShotExpiry;     // Global timer value at which the one-shot fires.
 
 u32 privateTimerPrescaler = PRIVATE_TIMER_PRESCALER_DEFAULT;      // Keep track of the private-timer prescaler value
 u32 privateTimerLoadValue = PRIVATE_TIMER_LOAD_VALUE_DEFAULT;     // Keep track of the private-timer load value.
@@ -83,6 +102,15 @@ void interrupts_setPrivateTimerPrescalerValue(u32 prescalerValue) {
 }
 
 u32 interrupts_isrInvocationCount() {return isrInvocationCount;}  // Functional accessor for isrInvocationCount.
+u32 interrupts_deviceIsrInvocationCount() {return deviceIsrInvocationCount;}
+u32 interrupts_getTimerIsrLatencyCount() {return timerIsrLatencyCount;}
+u32 interrupts_getMaxTimerIsrLatency() {return timerIsrMaxLatency;}
+u32 interrupts_getAverageTimerIsrLatency() {return timerIsrLatencyCount ? timerIsrTotalLatency / timerIsrLatencyCount : 0;}
+void interrupts_resetTimerIsrLatency() {
+  timerIsrLatencyCount = 0;
+  timerIsrTotalLatency = 0;
+  timerIsrMaxLatency = 0;
+}
 // Accessor to retrieve the number of times the ISR was invoked (same as count of timer ticks).
 u32 interrupts_getPrivateTimerTicksPerSecond() {return ZYBO_BUS_CLOCK /((privateTimerPrescaler+1) * (privateTimerLoadValue+1));}
 u32 totalXadcSampleCount = 0;
@@ -174,6 +202,7 @@ void updateHeartBeatLed() {
 void sysMonIsr(void *CallBackRef) {
   u32 intrStatusValue;
   XSysMon *xSysMonPtr = (XSysMon *)CallBackRef;
+  deviceIsrInvocationCount++;
   // Get the interrupt status from the device and check the value.
   intrStatusValue = XSysMon_IntrGetStatus(xSysMonPtr);
   if (intrStatusValue & XSM_SR_EOC_MASK)  // inc eocCount if the EOC status bit is set.
@@ -181,8 +210,43 @@ void sysMonIsr(void *CallBackRef) {
   XSysMon_IntrClear(xSysMonPtr, intrStatusValue);  // Clear out ALL XADC interrupt.
 }
 
+// Touch ISR: the STMPE610 raises its INT line on touch-detect and whenever a sample lands
+// in its FIFO. display_touchIsr() moves the samples into the event queue and clears the line.
+// When that happens over asynchronous SPI, INT is still asserted when this returns, so the
+// interrupt stays masked at the GIC until display calls interrupts_unmaskTouchInt().
+void touchIsr(void* callBackRef) {
+#ifdef INTERRUPTS_ENABLE_TOUCH_INTERRUPT
+  XScuGic_Disable(&InterruptController, XPAR_FABRIC_TOUCH_INT_INTR);
+#endif
+  deviceIsrInvocationCount++;
+  display_touchIsr();
+}
+
+// SPI ISR: the AXI SPI core interrupts when a chunk of an asynchronous request has been sent.
+void spiIsr(void* callBackRef) {
+  deviceIsrInvocationCount++;
+  spi_isr();
+}
+
+// Records how long ago the private timer expired. A periodic timer has been counting down from
+// the load value again since then; a one-shot one has stopped, so its expiry time is kept.
+static void recordTimerIsrLatency() {
+  u32 latency;
+  if (privateTimerOneShot) {
+    u64 now = globalTimer_getTimerValue();
+    latency = now > privateTimerOneShotExpiry ? (u32) (now - privateTimerOneShotExpiry) : 0;
+  } else {
+    latency = (privateTimerLoadValue - XScuTimer_GetCounterValue(&TimerInstance)) * (privateTimerPrescaler + 1);
+  }
+  timerIsrLatencyCount++;
+  timerIsrTotalLatency += latency;
+  if (latency > timerIsrMaxLatency)
+    timerIsrMaxLatency = latency;
+}
+
 // ******************************* Start Timer ISR *********************************
 void timerIsr(void* callBackRef){
+    recordTimerIsrLatency();  // First, so that the measurement doesn't include the ISR itself.
 #ifdef INTERVALTIMER_H_  // Enable interval timing when this is defined.
     intervalTimer_start(0);
 #endif
@@ -263,6 +327,41 @@ int initSysMonInterrupts() {
   return XST_SUCCESS;
 }
 
+#ifdef INTERRUPTS_ENABLE_TOUCH_INTERRUPT
+// Connects the touch ISR to the GIC. The touch controller's own interrupt enables are set up
+// by display_enableTouchInterrupts().
+int initTouchInterrupts() {
+  int status = XScuGic_Connect(&InterruptController,
+		                       XPAR_FABRIC_TOUCH_INT_INTR,
+		                       (Xil_ExceptionHandler) touchIsr,
+		                       NULL);
+  if (status != XST_SUCCESS) {
+	print("XScuGic_Connect failed (touch).\n\r");
+	return status;
+  }
+  // Enable the touch interrupt on the GIC (does nothing to the touch controller).
+  XScuGic_Enable(&InterruptController, XPAR_FABRIC_TOUCH_INT_INTR);
+  return XST_SUCCESS;
+}
+#endif
+
+#ifdef INTERRUPTS_ENABLE_SPI_INTERRUPT
+// Connects the SPI ISR to the GIC. The core's own interrupt enables are handled by spi.c.
+int initSpiInterrupts() {
+  int status = XScuGic_Connect(&InterruptController,
+		                       XPAR_FABRIC_SPI_0_IP2INTC_IRPT_INTR,
+		                       (Xil_ExceptionHandler) spiIsr,
+		                       NULL);
+  if (status != XST_SUCCESS) {
+	print("XScuGic_Connect failed (spi).\n\r");
+	return status;
+  }
+  // Enable the SPI interrupt on the GIC (does nothing to the SPI core).
+  XScuGic_Enable(&InterruptController, XPAR_FABRIC_SPI_0_IP2INTC_IRPT_INTR);
+  return XST_SUCCESS;
+}
+#endif
+
 // Sets up the timer for periodic interrupts.
 int initTimerInterrupts() {
   int status;  // General Xilinx status reporting.
@@ -368,6 +467,14 @@ int interrupts_initAll(bool printFailedStatusFlag) {
   initTimerInterrupts();
   // Init the SysMon interrupts (XADC).
   initSysMonInterrupts();
+#ifdef INTERRUPTS_ENABLE_TOUCH_INTERRUPT
+  // Init the touch-controller interrupt.
+  initTouchInterrupts();
+#endif
+#ifdef INTERRUPTS_ENABLE_SPI_INTERRUPT
+  // Init the SPI-core interrupt.
+  initSpiInterrupts();
+#endif
   initGicFlag = true;
 
   // Enable capture of ADC values in queue if queue.h has been included.
@@ -419,6 +526,8 @@ int setTimerInterval(int loadValue) {
 }
 
 int interrupts_startArmPrivateTimer() {
+  XScuTimer_EnableAutoReload(&TimerInstance);  // Periodic, even after a one-shot.
+  privateTimerOneShot = false;
   XScuTimer_Start(&TimerInstance);
   return 0;
 }
@@ -428,6 +537,75 @@ int interrupts_stopArmPrivateTimer() {
   return 0;
 }
 
+// Tickless use: restarts the private timer so that it interrupts once, after timerClockCycles
+// cycles of the (global) timer clock, and then stops. interrupts_setPrivateTimerLoadValue()
+// followed by interrupts_startArmPrivateTimer() goes back to periodic interrupts.
+int interrupts_startArmPrivateTimerOneShot(u32 timerClockCycles) {
+  u32 loadValue = timerClockCycles / (privateTimerPrescaler + 1);
+  XScuTimer_Stop(&TimerInstance);
+  XScuTimer_DisableAutoReload(&TimerInstance);
+  XScuTimer_LoadTimer(&TimerInstance, loadValue ? loadValue - 1 : 0);
+  privateTimerOneShot = true;
+  privateTimerOneShotExpiry = globalTimer_getTimerValue() + timerClockCycles;
+  XScuTimer_Start(&TimerInstance);
+  return 0;
+}
+
+// Sleeps until an interrupt is pending. Call it with the ARM interrupts disabled, after checking
+// that there is nothing left to do, so that an interrupt can't slip in between the check and the
+// WFI. The interrupt is taken once they are enabled again.
+void interrupts_waitForInterrupt() {
+  wfi();
+}
+
+// Switches the display's touch functions over to the touch ISR. display_init() must have been
+// called first. Returns 1 if the hardware design has no touch interrupt (touch is then polled).
+int interrupts_enableTouchGlobalInts() {
+#ifdef INTERRUPTS_ENABLE_TOUCH_INTERRUPT
+  display_enableTouchInterrupts(true);
+  return 0;
+#else
+  return 1;
+#endif
+}
+
+int interrupts_disableTouchGlobalInts() {
+#ifdef INTERRUPTS_ENABLE_TOUCH_INTERRUPT
+  display_enableTouchInterrupts(false);
+#endif
+  return 0;
+}
+
+// Lets the touch interrupt back in after touchIsr() masked it.
+int interrupts_unmaskTouchInt() {
+#ifdef INTERRUPTS_ENABLE_TOUCH_INTERRUPT
+  XScuGic_Enable(&InterruptController, XPAR_FABRIC_TOUCH_INT_INTR);
+#endif
+  return 0;
+}
+
+// Runs the asynchronous SPI queue off of the SPI interrupt. Returns 1 if the hardware design has
+// no SPI interrupt (the queue is then polled).
+int interrupts_enableSpiGlobalInts() {
+#ifdef INTERRUPTS_ENABLE_SPI_INTERRUPT
+  spi_enableInterrupts(true);
+  return 0;
+#else
+  return 1;
+#endif
+}
+
+int interrupts_disableSpiGlobalInts() {
+#ifdef INTERRUPTS_ENABLE_SPI_INTERRUPT
+  spi_enableInterrupts(false);
+#endif
+  return 0;
+}
+
+u16 interrupts_getXadcSample() {
+  return XSysMon_GetAdcData(&xSysMonInst, XADC_AUX_CHANNEL_14);
+}
+
 // Default is to enable EOC (end of conversion) interrupts.
 int interrupts_enableSysMonGlobalInts(){
   XSysMon_IntrGlobalEnable(&xSysMonInst);
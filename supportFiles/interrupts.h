@@ -28,10 +28,19 @@ int interrupts_disableTimerGlobalInts();
 int interrupts_setTimerInterval(int loadValue);
 int interrupts_startArmPrivateTimer();
 int interrupts_stopArmPrivateTimer();
+int interrupts_startArmPrivateTimerOneShot(u32 timerClockCycles);
+void interrupts_waitForInterrupt();
 u32 interrupts_getPrivateTimerCounterValue(void);
 void interrupts_setPrivateTimerLoadValue(u32 loadValue);
 void interrupts_setPrivateTimerPrescalerValue(u32 prescalerValue);
 
+int interrupts_enableTouchGlobalInts();
+int interrupts_disableTouchGlobalInts();
+int interrupts_unmaskTouchInt();
+
+int interrupts_enableSpiGlobalInts();
+int interrupts_disableSpiGlobalInts();
+
 int interrupts_enableSysMonGlobalInts();
 int interrupt_disableSysMonGlobalInts();
 int interrupts_enableSysMonEocInts();
@@ -41,9 +50,18 @@ int interrupts_enableSysMonEocInts();
 #endif
 
 u32 interrupts_isrInvocationCount();
+u32 interrupts_deviceIsrInvocationCount();  // Every ISR but the timer's: a change means an input may have arrived.
+// Timer ISR entry latency, in global timer ticks from the private timer's expiry to timerIsr().
+u32 interrupts_getTimerIsrLatencyCount();
+u32 interrupts_getMaxTimerIsrLatency();
+u32 interrupts_getAverageTimerIsrLatency();
+void interrupts_resetTimerIsrLatency();
 u32 interrupts_getPrivateTimerTicksPerSecond();
 u32 interrupts_getTotalXadcSampleCount();
 u32 interrupts_getTotalEocCount();
+// Latest XADC conversion on aux channel 14 (12 bits, left-justified in 16). The XADC converts
+// continuously once interrupts_initAll() has set it up, about once a microsecond.
+u16 interrupts_getXadcSample();
 
 extern volatile int interrupts_isrFlagGlobal;
 
@@ -12,6 +12,15 @@
 static XGpio gpioTftControl;  // Provides the RD, WR and CD pins for the LCD controller.
 static XGpio gpioTftDataBus;  // Provides an 8-bit data bus for the LCD controller.
 static bool initFlag = false; // Make sure that body of init routine only gets invoked once.
+// Software copy of the control port. Nothing else drives these pins, so each pin change can be
+// made with a single GPIO write instead of a read-modify-write.
+static uint32_t controlShadow = 0;
+
+// Updates the shadow copy and sends it to the control port.
+static void LCD_writeControl(uint32_t value) {
+  controlShadow = value;
+  XGpio_DiscreteWrite(&gpioTftControl, 1, controlShadow);
+}
 
 // This init intializes all of the hardware that talks to the LCD panel.
 void LCD_init() {
@@ -30,6 +39,7 @@ void LCD_init() {
   // Set the direction for all signals to be outputs (0 = output, 1 = input).
   XGpio_SetDataDirection(&gpioTftControl, 1, 0);  // Control bits are always outputs.
   XGpio_SetDataDirection(&gpioTftDataBus, 1, 0);  // Set up data-bus direction as output (write).
+  controlShadow = XGpio_DiscreteRead(&gpioTftControl, 1);  // One read to seed the shadow.
   mio_init(true);
   LCD_negateRd();  // negate the RD control signal.
   LCD_negateWr();  // negate the WR control signal.
@@ -38,38 +48,32 @@ void LCD_init() {
 
 // Sets the logic value on the command/data pin for the LCD controller to command mode.
 void LCD_setCommandMode() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue & ~LCD_DCX_BIT_MASK);  // Clears the DCX bit.
+  LCD_writeControl(controlShadow & ~LCD_DCX_BIT_MASK);  // Clears the DCX bit.
 }
 
 // Sets the logic value on the command/data pin for the LCD controller to data mode.
 void LCD_setDataMode() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue | LCD_DCX_BIT_MASK);  // Sets the DCX bit.
+  LCD_writeControl(controlShadow | LCD_DCX_BIT_MASK);  // Sets the DCX bit.
 }
 
 // Set the logic value on the LCD RD pin for read operations for the LCD data bus.
 void LCD_assertRd() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue & ~LCD_RD_BIT_MASK);  // Asserts RD
+  LCD_writeControl(controlShadow & ~LCD_RD_BIT_MASK);  // Asserts RD
 }
 
 // Set the logic value on the LCD RD pin to disable read operations on the LCD data bus.
 void LCD_negateRd() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue | LCD_RD_BIT_MASK);  // Negates RD
+  LCD_writeControl(controlShadow | LCD_RD_BIT_MASK);  // Negates RD
 }
 
 // Set the logic value on the LCD WR pin to enable write operations on the LCD data bus.
 void LCD_assertWr() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue & ~LCD_WR_BIT_MASK);  // Asserts WR
+  LCD_writeControl(controlShadow & ~LCD_WR_BIT_MASK);  // Asserts WR
 }
 
 // Set the logic value on the LCD WR pin to disable write operations on the LCD data bus.
 void LCD_negateWr() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue | LCD_WR_BIT_MASK);  // Negates WR
+  LCD_writeControl(controlShadow | LCD_WR_BIT_MASK);  // Negates WR
 }
 
 
@@ -148,4 +152,61 @@ uint8_t LCD_readData() {
   return value;
 }
 
+// Bus state used by the burst writes: data mode, RD negated, with WR low or high.
+static uint32_t LCD_beginBurst(uint32_t *wrHigh) {
+  LCD_writeControl(controlShadow | LCD_DCX_BIT_MASK | LCD_RD_BIT_MASK | LCD_WR_BIT_MASK);
+  *wrHigh = controlShadow;
+  return controlShadow & ~LCD_WR_BIT_MASK;
+}
+
+// Writes count bytes from data. The value is put on the data bus and latched by the rising WR edge.
+void LCD_writeBytes(const uint8_t *data, uint32_t count) {
+  uint32_t wrHigh;
+  uint32_t wrLow = LCD_beginBurst(&wrHigh);
+  while (count--) {
+    XGpio_DiscreteWrite(&gpioTftDataBus, 1, *data++);
+    XGpio_DiscreteWrite(&gpioTftControl, 1, wrLow);
+    XGpio_DiscreteWrite(&gpioTftControl, 1, wrHigh);
+  }
+}
 
+// Writes count RGB565 pixels, high byte first as the controller expects.
+void LCD_writePixels(const uint16_t *pixels, uint32_t count) {
+  uint32_t wrHigh;
+  uint32_t wrLow = LCD_beginBurst(&wrHigh);
+  while (count--) {
+    uint16_t color = *pixels++;
+    XGpio_DiscreteWrite(&gpioTftDataBus, 1, color >> 8);
+    XGpio_DiscreteWrite(&gpioTftControl, 1, wrLow);
+    XGpio_DiscreteWrite(&gpioTftControl, 1, wrHigh);
+    XGpio_DiscreteWrite(&gpioTftDataBus, 1, color & 0xFF);
+    XGpio_DiscreteWrite(&gpioTftControl, 1, wrLow);
+    XGpio_DiscreteWrite(&gpioTftControl, 1, wrHigh);
+  }
+}
+
+// Writes the same RGB565 color count times. When both bytes are equal (black, white, ...) the
+// data bus is written once and only WR is toggled after that.
+void LCD_writeRepeatedPixel(uint16_t color, uint32_t count) {
+  uint8_t hi = color >> 8;
+  uint8_t lo = color & 0xFF;
+  uint32_t wrHigh;
+  uint32_t wrLow = LCD_beginBurst(&wrHigh);
+  if (hi == lo) {
+    XGpio_DiscreteWrite(&gpioTftDataBus, 1, hi);
+    count *= 2;  // Two bytes per pixel.
+    while (count--) {
+      XGpio_DiscreteWrite(&gpioTftControl, 1, wrLow);
+      XGpio_DiscreteWrite(&gpioTftControl, 1, wrHigh);
+    }
+  } else {
+    while (count--) {
+      XGpio_DiscreteWrite(&gpioTftDataBus, 1, hi);
+      XGpio_DiscreteWrite(&gpioTftControl, 1, wrLow);
+      XGpio_DiscreteWrite(&gpioTftControl, 1, wrHigh);
+      XGpio_DiscreteWrite(&gpioTftDataBus, 1, lo);
+      XGpio_DiscreteWrite(&gpioTftControl, 1, wrLow);
+      XGpio_DiscreteWrite(&gpioTftControl, 1, wrHigh);
+    }
+  }
+}
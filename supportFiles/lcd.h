@@ -9,7 +9,7 @@
 #define LCD_H_
 #include "arduinoTypes.h"
 #include "xgpio.h"
-#include "TFTGPIO.h"
+#include "tftGpio.h"
 #include <stdio.h>
 
 // Provides an API to read/write the LCD controller.
@@ -55,4 +55,11 @@ uint8_t LCD_readData(void);
 void LCD_setReadDataDirection();
 void LCD_setWriteDataDirection();
 
+// Burst writes. These put the bus in data mode once and keep it there for the whole burst.
+// Each byte costs one data-bus write plus the WR strobe (two control writes); a repeated
+// color whose high and low bytes match costs the strobe only.
+void LCD_writeBytes(const uint8_t *data, uint32_t count);       // Arbitrary bytes.
+void LCD_writePixels(const uint16_t *pixels, uint32_t count);   // RGB565 pixels, high byte first.
+void LCD_writeRepeatedPixel(uint16_t color, uint32_t count);    // One RGB565 color, count times.
+
 #endif /* LCD_H_ */
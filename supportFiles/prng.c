@@ -0,0 +1,87 @@
+/*
+ * prng.c
+ *
+ * See prng.h.
+ */
+
+#include "prng.h"
+#include "globalTimer.h"
+#include "interrupts.h"
+#ifdef HOST_SIM
+#include <stdlib.h>
+#endif
+
+#define PRNG_NOISE_SAMPLE_COUNT 64   // 4 noisy bits each.
+#define PRNG_NOISE_BITS_MASK 0xF     // Of the 12-bit conversion result.
+#define PRNG_XADC_RESULT_SHIFT 4     // Conversion results are left-justified in 16 bits.
+// A conversion takes 26 ADC clocks at 25 MHz (the 100 MHz bus clock divided by 4 in interrupts.c).
+// The wait between samples is two clocks longer, rounded up, so that every sample is new.
+#define PRNG_XADC_CLOCK_FREQUENCY 25000000ULL
+#define PRNG_XADC_CONVERSION_CLOCKS 26
+#define PRNG_XADC_WAIT_CLOCKS (PRNG_XADC_CONVERSION_CLOCKS + 2)
+#define PRNG_XADC_WAIT_TICKS \
+  (((uint64_t) GLOBAL_TIMER_TICKS_PER_SECOND * PRNG_XADC_WAIT_CLOCKS + PRNG_XADC_CLOCK_FREQUENCY - 1) / PRNG_XADC_CLOCK_FREQUENCY)
+#define PRNG_ZERO_SEED_STATE 0x9E3779B9  // Where seeds that hash to zero start.
+
+static prng_state_t prng_state = {PRNG_ZERO_SEED_STATE};
+
+// The murmur3 finalizer: every seed bit affects every state bit, so nearby seeds (a count,
+// a date) still give unrelated games. It maps only zero to zero.
+static uint32_t prng_mix(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x85EBCA6B;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35;
+  x ^= x >> 16;
+  return x;
+}
+
+void prng_seed(uint32_t seed) {
+  uint32_t state = prng_mix(seed);
+  prng_state.state = state ? state : PRNG_ZERO_SEED_STATE;
+}
+
+// FNV-1a over the low bits of consecutive conversions.
+uint32_t prng_seedFromNoise() {
+  uint32_t seed = 2166136261u;
+#ifdef HOST_SIM
+  const char *seedText = getenv("HOSTSIM_SEED");
+  if (seedText && *seedText) {
+    seed = strtoul(seedText, NULL, 0);
+    prng_seed(seed);
+    return seed;
+  }
+#endif
+  for (int i = 0; i < PRNG_NOISE_SAMPLE_COUNT; i++) {
+    u64 start = globalTimer_getTimerValue();
+    while (globalTimer_getTimerValue() - start < PRNG_XADC_WAIT_TICKS);
+    seed = (seed ^ ((interrupts_getXadcSample() >> PRNG_XADC_RESULT_SHIFT) & PRNG_NOISE_BITS_MASK)) * 16777619u;
+  }
+  prng_seed(seed);
+  return seed;
+}
+
+void prng_getState(prng_state_t *state) {
+  *state = prng_state;
+}
+
+void prng_setState(const prng_state_t *state) {
+  if (state->state)
+    prng_state = *state;
+}
+
+uint32_t prng_next() {
+  uint32_t x = prng_state.state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  prng_state.state = x;
+  return x;
+}
+
+// The high bits are the best ones in xorshift, so each value is scaled down from the whole
+// word rather than taken modulo.
+void prng_generate(uint8_t values[], uint16_t count, uint8_t range) {
+  for (uint16_t i = 0; i < count; i++)
+    values[i] = ((uint64_t) prng_next() * range) >> 32;
+}
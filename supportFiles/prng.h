@@ -0,0 +1,33 @@
+/*
+ * prng.h
+ *
+ * Pseudo-random numbers for the game: a xorshift32 generator with an explicit seed, whose state
+ * can be saved and put back. The same seed gives the same numbers on the board and on the host,
+ * so a game can be played again from its seed. prng_seedFromNoise() picks a seed from the noise
+ * in the XADC's least significant bits, and returns it so that it can be printed and reused.
+ */
+
+#ifndef PRNG_H_
+#define PRNG_H_
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t state;  // Never zero.
+} prng_state_t;
+
+// Starts the sequence of numbers that belongs to seed. Any seed will do, zero included.
+void prng_seed(uint32_t seed);
+// Seeds from XADC noise and returns the seed. Needs the XADC set up by interrupts_initAll().
+// On the host, the HOSTSIM_SEED environment variable, if set, is the seed instead.
+uint32_t prng_seedFromNoise();
+
+void prng_getState(prng_state_t *state);
+void prng_setState(const prng_state_t *state);
+
+// The next 32 random bits.
+uint32_t prng_next();
+// Fills values with count numbers from 0 to range - 1, one generator step each.
+void prng_generate(uint8_t values[], uint16_t count, uint8_t range);
+
+#endif /* PRNG_H_ */
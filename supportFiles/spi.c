@@ -9,6 +9,7 @@
 #include "spi.h"
 #include "arduinoTypes.h"
 #include "xil_io.h"
+#include "trace.h"
 
 void spi_begin(void) {
   spi_softwareReset();  // Just reset the SPI hardware in the ZYNQ fabric.
@@ -174,9 +175,188 @@ bool spi_isReceiveFifoFull() {
   return (spi_readRegister(SPI_STATUS_REG_OFFET) & SPI_STATUS_REG_RX_FULL_MASK);
 }
 
+// Control-register value for the transaction in progress, so that ending it needs no read.
+static uint32_t spi_transactionControl;
 
+// Master, enabled, manual slave select, plus the mode and bit order from the settings.
+static uint32_t spi_controlForSettings(const spi_settings_t *settings) {
+  uint32_t control = SPI_CNTROL_REG_MANUAL_SLAVE_ASSERTION_ENABLE_MASK | SPI_CNTRL_MASTER_MASK | SPI_CNTRL_SPE_MASK;
+  if (settings->bitOrder == SPI_LSBFIRST)
+    control |= SPI_CNTRL_REG_LSB_FIRST_MASK;
+  if (settings->mode == SPI_MODE_2 || settings->mode == SPI_MODE_3)
+    control |= SPI_CNTRL_CPOL_MASK;
+  if (settings->mode == SPI_MODE_1 || settings->mode == SPI_MODE_3)
+    control |= SPI_CNTRL_CPHA_MASK;
+  return control;
+}
 
+// One control-register write, with both FIFOs reset (those two bits clear themselves).
+// Transfers start as soon as bytes reach the TX FIFO. Asynchronous requests get the bus first.
+void spi_beginTransaction(const spi_settings_t *settings) {
+  spi_waitUntilIdle();
+  spi_transactionControl = spi_controlForSettings(settings);
+  spi_writeRegister(SPI_CNTRL_REG_OFFSET, spi_transactionControl | SPI_CNTRL_REG_RX_FIFO_RESET_MASK | SPI_CNTRL_REG_TX_FIFO_RESET_MASK);
+}
 
+// Fills the TX FIFO with up to SPI_FIFO_DEPTH bytes, then collects the same number from the
+// RX FIFO. Waiting on RX-empty rather than TX-empty makes sure the last byte has finished shifting.
+void spi_transferBuffer(const uint8_t *tx, uint8_t *rx, uint32_t count) {
+  while (count) {
+    uint32_t chunk = count < SPI_FIFO_DEPTH ? count : SPI_FIFO_DEPTH;
+    for (uint32_t i=0; i<chunk; i++)
+      spi_writeRegister(SPI_DATA_TRANSMIT_REG_OFFSET, tx ? tx[i] : 0);
+    for (uint32_t i=0; i<chunk; i++) {
+      while (spi_readRegister(SPI_STATUS_REG_OFFET) & SPI_STATUS_REG_RX_EMPTY_MASK);
+      uint8_t value = spi_readRegister(SPI_DATA_RECEIVE_REG_OFFSET);
+      if (rx)
+        rx[i] = value;
+    }
+    if (tx)
+      tx += chunk;
+    if (rx)
+      rx += chunk;
+    count -= chunk;
+  }
+}
 
+void spi_endTransaction() {
+  spi_writeRegister(SPI_CNTRL_REG_OFFSET, spi_transactionControl | SPI_CNTRL_REG_MASTER_TRANSACTION_INHIBIT_MASK);
+}
 
+// ******************************** Asynchronous requests ********************************
 
+// The request on the wire is at the head. spi_submit() appends at the tail and spi_advance(), from
+// the ISR when interrupt driven, empties the queue and clears the tail. spi_submit() masks the SPI
+// interrupt at the core (DGIER) before it looks at the queue, so the two never overlap and the
+// queue needs no ARM-level critical section.
+static spi_request_t * volatile spi_queueHead = NULL;
+static spi_request_t *spi_queueTail = NULL;
+static volatile bool spi_interruptDriven = false;
+
+// The core only interrupts while a request is queued: synchronous transactions never see the ISR.
+static void spi_setCoreInterruptEnabled(bool enable) {
+  spi_writeRegister(SPI_DGIER_REG_OFFSET, enable ? SPI_DGIER_GLOBAL_INTERRUPT_ENABLE_MASK : 0);
+}
+
+// Loads the next chunk while the master is inhibited, then lets it go in one shot. Bytes trickling
+// into a running master could empty the FIFO early and raise DTR-empty before the chunk is complete.
+static void spi_startChunk(spi_request_t *request) {
+  uint32_t remaining = request->count - request->transferred;
+  request->chunk = remaining < SPI_FIFO_DEPTH ? remaining : SPI_FIFO_DEPTH;
+  const uint8_t *tx = request->tx ? request->tx + request->transferred : NULL;
+  for (uint32_t i=0; i<request->chunk; i++)
+    spi_writeRegister(SPI_DATA_TRANSMIT_REG_OFFSET, tx ? tx[i] : 0);
+  spi_writeRegister(SPI_CNTRL_REG_OFFSET, spi_transactionControl);
+}
+
+static void spi_startRequest(spi_request_t *request) {
+  spi_transactionControl = spi_controlForSettings(&request->settings);
+  spi_writeRegister(SPI_CNTRL_REG_OFFSET, spi_transactionControl | SPI_CNTRL_REG_MASTER_TRANSACTION_INHIBIT_MASK |
+                    SPI_CNTRL_REG_RX_FIFO_RESET_MASK | SPI_CNTRL_REG_TX_FIFO_RESET_MASK);
+  spi_writeRegister(SPI_SLAVE_SELECT_REG_OFFSET, ~request->slaveSelectMask);
+  if (spi_interruptDriven)  // Drop a DTR-empty left over from synchronous traffic.
+    spi_writeRegister(SPI_IPISR_REG_OFFSET, spi_readRegister(SPI_IPISR_REG_OFFSET));
+  spi_startChunk(request);
+}
+
+// Number of bytes of the current chunk sitting in the RX FIFO.
+static uint32_t spi_receivedByteCount() {
+  if (spi_readRegister(SPI_STATUS_REG_OFFET) & SPI_STATUS_REG_RX_EMPTY_MASK)
+    return 0;
+  return spi_readRegister(SPI_RECEIVE_FIFO_OCC_REG_OFFSET) + 1;
+}
+
+// Collects the chunk that just finished. Then either starts the next chunk or completes the
+// request: the next request is started before the callback runs so that the bus stays busy.
+static void spi_advance() {
+  spi_request_t *request = spi_queueHead;
+  spi_writeRegister(SPI_CNTRL_REG_OFFSET, spi_transactionControl | SPI_CNTRL_REG_MASTER_TRANSACTION_INHIBIT_MASK);
+  uint8_t *rx = request->rx ? request->rx + request->transferred : NULL;
+  for (uint32_t i=0; i<request->chunk; i++) {
+    uint8_t value = spi_readRegister(SPI_DATA_RECEIVE_REG_OFFSET);
+    if (rx)
+      rx[i] = value;
+  }
+  request->transferred += request->chunk;
+  if (request->transferred < request->count) {
+    spi_startChunk(request);
+    return;
+  }
+  spi_clearAllSlaveSelects();
+  spi_queueHead = request->next;
+  if (spi_queueHead)
+    spi_startRequest(spi_queueHead);
+  else {
+    spi_queueTail = NULL;
+    if (spi_interruptDriven)
+      spi_setCoreInterruptEnabled(false);
+  }
+  trace_write(TRACE_SOURCE_SPI, TRACE_EVENT_SPI_COMPLETE, 0, 0, request->count);
+  if (request->callback)
+    request->callback(request);
+}
+
+void spi_submit(spi_request_t *request) {
+  trace_write(TRACE_SOURCE_SPI, TRACE_EVENT_SPI_SUBMIT, 0, 0, request->count);
+  request->transferred = 0;
+  request->next = NULL;
+  // Masked first: the ISR could otherwise complete the last request, and clear the tail, between
+  // the look at the head and the append.
+  if (spi_interruptDriven)
+    spi_setCoreInterruptEnabled(false);
+  bool wasBusy = spi_queueHead != NULL;
+  if (wasBusy)
+    spi_queueTail->next = request;
+  else
+    spi_queueHead = request;
+  spi_queueTail = request;
+  if (!wasBusy)
+    spi_startRequest(request);
+  if (spi_interruptDriven)
+    spi_setCoreInterruptEnabled(true);
+}
+
+bool spi_isBusy() {
+  return spi_queueHead != NULL;
+}
+
+void spi_poll() {
+  if (!spi_queueHead)
+    return;
+  if (spi_interruptDriven)
+    spi_setCoreInterruptEnabled(false);
+  if (spi_queueHead && spi_receivedByteCount() == spi_queueHead->chunk) {
+    if (spi_interruptDriven)  // Handled here: don't let the ISR wait on the next chunk for it.
+      spi_writeRegister(SPI_IPISR_REG_OFFSET, spi_readRegister(SPI_IPISR_REG_OFFSET));
+    spi_advance();
+  }
+  if (spi_interruptDriven && spi_queueHead)
+    spi_setCoreInterruptEnabled(true);
+}
+
+void spi_waitUntilIdle() {
+  while (spi_queueHead)
+    spi_poll();
+}
+
+void spi_enableInterrupts(bool enable) {
+  spi_waitUntilIdle();
+  spi_writeRegister(SPI_IPIER_REG_OFFSET, enable ? SPI_INTERRUPT_DTR_EMPTY_MASK : 0);
+  spi_setCoreInterruptEnabled(false);
+  spi_interruptDriven = enable;
+}
+
+bool spi_isInterruptDriven() {
+  return spi_interruptDriven;
+}
+
+// DTR-empty fires once the last byte of a chunk has left the shift register; the RX side can
+// trail it by a byte time, so wait for the chunk to be complete before collecting it.
+void spi_isr() {
+  uint32_t status = spi_readRegister(SPI_IPISR_REG_OFFSET);
+  spi_writeRegister(SPI_IPISR_REG_OFFSET, status);
+  if (!(status & SPI_INTERRUPT_DTR_EMPTY_MASK) || !spi_queueHead)
+    return;
+  while (spi_receivedByteCount() < spi_queueHead->chunk);
+  spi_advance();
+}
@@ -56,8 +56,16 @@
 #define SPI_TRANSMIT_FIFO_OCC_REG_OFFSET 0x74
 #define SPI_RECEIVE_FIFO_OCC_REG_OFFSET 0x78
 
+#define SPI_DGIER_REG_OFFSET 0x1C                  // Device global interrupt enable.
+#define SPI_DGIER_GLOBAL_INTERRUPT_ENABLE_MASK 0x80000000
+#define SPI_IPISR_REG_OFFSET 0x20                  // Interrupt status (toggle on write).
+#define SPI_IPIER_REG_OFFSET 0x28                  // Interrupt enable.
+#define SPI_INTERRUPT_DTR_EMPTY_MASK 0x00000004    // The last byte in the TX FIFO has been shifted out.
+
 #define SPI_DELAY_FUDGE_FACTOR 10000  // This is the multiplier to get the delay value of 1 to be 1 millisecond.
 
+#define SPI_FIFO_DEPTH 16  // Depth of the core's TX and RX FIFOs as configured in the hardware design.
+
 #define SPI_TFT_SLAVE_SELECT_MASK 0x00000001  // TFT SPI slave select is bit 0 (only used if LCD is accessed via SPI - deprecated).
 #define SPI_TOUCH_SCREEN_CONTROLLER_SLAVE_SELECT_MASK 0x00000002 // Touch-screen controller slave select is bit 1.
 
@@ -84,4 +92,55 @@ void spi_configure();
 void spi_waitUntilTxRegisterIsEmpty();
 bool spi_isReceiveFifoFull();
 
+// Transactions. spi_transfer() above reconfigures the core around every byte; a transaction
+// writes the control register once at the start and once at the end, and moves the bytes in
+// between through the FIFOs, SPI_FIFO_DEPTH at a time. Slave select is still up to the caller.
+typedef struct {
+  uint8_t bitOrder;  // SPI_MSBFIRST or SPI_LSBFIRST.
+  uint8_t mode;      // SPI_MODE_0 ... SPI_MODE_3.
+} spi_settings_t;
+
+// Configures the core for the settings and enables it as a master with empty FIFOs.
+void spi_beginTransaction(const spi_settings_t *settings);
+// Shifts count bytes out of tx (zeros if tx is NULL) and stores what comes back in rx (dropped if
+// rx is NULL). Blocks until the last byte has been received.
+void spi_transferBuffer(const uint8_t *tx, uint8_t *rx, uint32_t count);
+// Inhibits the master again.
+void spi_endTransaction();
+
+// Asynchronous requests. A request is one chip-select-framed transfer: spi_submit() queues it
+// and returns, and the SPI ISR (spi_isr(), connected by interrupts.c) moves it through the FIFOs
+// one chunk per DTR-empty interrupt. The callback runs in interrupt context once the last byte
+// is in and slave select is released; it may submit further requests. Without the interrupt,
+// spi_poll() moves things along. Requests must stay in place until their callback has run.
+typedef struct spi_request spi_request_t;
+struct spi_request {
+  spi_settings_t settings;
+  uint32_t slaveSelectMask;                   // For example SPI_TOUCH_SCREEN_CONTROLLER_SLAVE_SELECT_MASK.
+  const uint8_t *tx;                          // Zeros are sent if NULL.
+  uint8_t *rx;                                // Received bytes are dropped if NULL.
+  uint32_t count;                             // Must not be zero.
+  void (*callback)(spi_request_t *request);   // May be NULL.
+  void *context;                              // For the callback; not used by spi.c.
+  // Owned by spi.c while the request is queued.
+  uint32_t transferred;
+  uint32_t chunk;
+  spi_request_t *next;
+};
+
+// Queues the request, and starts it if the bus is idle.
+void spi_submit(spi_request_t *request);
+// True while any submitted request has not completed.
+bool spi_isBusy();
+// Collects a finished chunk, if there is one, and starts the next. Safe from any context.
+void spi_poll();
+// Polls until every submitted request has completed.
+void spi_waitUntilIdle();
+// Runs the queue off of the SPI interrupt instead of spi_poll(). interrupts.c calls this once
+// the ISR is connected to the GIC.
+void spi_enableInterrupts(bool enable);
+bool spi_isInterruptDriven();
+// SPI ISR, connected to the GIC by interrupts.c.
+void spi_isr();
+
 #endif /* SPI_H_ */
@@ -6,12 +6,19 @@
  */
 
 #include "xgpio.h"
-#include "TFTGPIO.h"
+#include "tftGpio.h"
 #include <stdio.h>
 #include "arduinoTypes.h"
 
 static XGpio gpioTft;  // Instance of the LED GPIO Driver
 static bool initFlag = false;
+static uint32_t gpioTftShadow = 0;  // Software copy of the port; lets each pin change be one write.
+
+// Updates the shadow copy and sends it to the port.
+static void TFTGPIO_write(uint32_t value) {
+  gpioTftShadow = value;
+  XGpio_DiscreteWrite(&gpioTft, 1, gpioTftShadow);
+}
 
 void TFTGPIO_init() {
   if (initFlag)
@@ -23,36 +30,31 @@ void TFTGPIO_init() {
   }
   // Set the direction for all signals to be outputs (0 = output).
   XGpio_SetDataDirection(&gpioTft, 1, 0);  // 0 is a bit-mask that will set all pins as outputs.
+  gpioTftShadow = XGpio_DiscreteRead(&gpioTft, 1);  // One read to seed the shadow.
   initFlag = true;
 }
 
 void TFTGPIO_setCommandMode() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTft, 1);
-  XGpio_DiscreteWrite(&gpioTft, 1, regValue & ~TFTGPIO_DCX_BIT_MASK);  // Clears the DCX bit.
+  TFTGPIO_write(gpioTftShadow & ~TFTGPIO_DCX_BIT_MASK);  // Clears the DCX bit.
 }
 
 void TFTGPIO_setDataMode() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTft, 1);
-  XGpio_DiscreteWrite(&gpioTft, 1, regValue | TFTGPIO_DCX_BIT_MASK);  // Sets the DCX bit.
+  TFTGPIO_write(gpioTftShadow | TFTGPIO_DCX_BIT_MASK);  // Sets the DCX bit.
 }
 
 void TFTGPIO_assertRd() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTft, 1);
-  XGpio_DiscreteWrite(&gpioTft, 1, regValue & ~TFTGPIO_RD_BIT_MASK);  // Asserts RD
+  TFTGPIO_write(gpioTftShadow & ~TFTGPIO_RD_BIT_MASK);  // Asserts RD
 }
 
 void TFTGPIO_negateRd() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTft, 1);
-  XGpio_DiscreteWrite(&gpioTft, 1, regValue | TFTGPIO_RD_BIT_MASK);  // Negates RD
+  TFTGPIO_write(gpioTftShadow | TFTGPIO_RD_BIT_MASK);  // Negates RD
 }
 
 void TFTGPIO_assertWr() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTft, 1);
-  XGpio_DiscreteWrite(&gpioTft, 1, regValue & ~TFTGPIO_WR_BIT_MASK);  // Asserts WR
+  TFTGPIO_write(gpioTftShadow & ~TFTGPIO_WR_BIT_MASK);  // Asserts WR
 }
 
 void TFTGPIO_negateWr() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTft, 1);
-  XGpio_DiscreteWrite(&gpioTft, 1, regValue | TFTGPIO_WR_BIT_MASK);  // Negates WR
+  TFTGPIO_write(gpioTftShadow | TFTGPIO_WR_BIT_MASK);  // Negates WR
 }
 
@@ -0,0 +1,68 @@
+/*
+ * trace.c
+ *
+ * See trace.h.
+ */
+
+#include "trace.h"
+#include "globalTimer.h"
+#include <stdio.h>
+
+static trace_record_t trace_records[TRACE_RECORD_COUNT];
+static volatile uint32_t trace_writeCount = 0;  // Records ever written; the ring index is this modulo the size.
+static volatile bool trace_enabled = true;
+
+// The timestamp is read before the slot is reserved: once it is, the record is filled in without
+// touching the bus. An ISR that runs in between writes a record that is a little out of order.
+void trace_write(trace_source_t source, trace_event_t event, uint8_t oldState, uint8_t newState, uint32_t arg) {
+  if (!trace_enabled)
+    return;
+  uint32_t timestamp = (uint32_t) (globalTimer_getTimerValue() >> TRACE_TIMESTAMP_SHIFT);
+  uint32_t index = __sync_fetch_and_add(&trace_writeCount, 1) & (TRACE_RECORD_COUNT - 1);
+  trace_record_t *record = &trace_records[index];
+  record->timestamp = timestamp;
+  record->source = source;
+  record->event = event;
+  record->oldState = oldState;
+  record->newState = newState;
+  record->arg = arg;
+}
+
+void trace_setEnabled(bool enabled) {
+  trace_enabled = enabled;
+}
+
+void trace_clear() {
+  trace_writeCount = 0;
+}
+
+uint32_t trace_getRecords(trace_record_t *records, uint32_t maxCount) {
+  uint32_t writeCount = trace_writeCount;
+  uint32_t count = writeCount < TRACE_RECORD_COUNT ? writeCount : TRACE_RECORD_COUNT;
+  if (count > maxCount)
+    count = maxCount;
+  for (uint32_t i = 0; i < count; i++)
+    records[i] = trace_records[(writeCount - count + i) & (TRACE_RECORD_COUNT - 1)];
+  return count;
+}
+
+uint32_t trace_getWriteCount() {
+  return trace_writeCount;
+}
+
+// Recording stops while the ring is printed, so that the dump is consistent.
+void trace_dump() {
+  bool wasEnabled = trace_enabled;
+  trace_enabled = false;
+  uint32_t writeCount = trace_writeCount;
+  uint32_t count = writeCount < TRACE_RECORD_COUNT ? writeCount : TRACE_RECORD_COUNT;
+  printf("%s %lu %lu\n\r", TRACE_DUMP_BEGIN, (unsigned long) count,
+         (unsigned long) (GLOBAL_TIMER_TICKS_PER_SECOND >> TRACE_TIMESTAMP_SHIFT));
+  for (uint32_t i = 0; i < count; i++) {
+    const trace_record_t *record = &trace_records[(writeCount - count + i) & (TRACE_RECORD_COUNT - 1)];
+    printf("%08lx %02x%02x%02x%02x %08lx\n\r", (unsigned long) record->timestamp, record->source, record->event,
+           record->oldState, record->newState, (unsigned long) record->arg);
+  }
+  printf("%s\n\r", TRACE_DUMP_END);
+  trace_enabled = wasEnabled;
+}
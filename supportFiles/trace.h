@@ -0,0 +1,89 @@
+/*
+ * trace.h
+ *
+ * Binary trace of state transitions and driver calls, for debugging timing-sensitive
+ * interactions without printf. Records go into a fixed-size ring in RAM and can be written
+ * from the tick functions and from ISRs alike: a writer reserves its slot with one atomic
+ * increment, so an ISR that interrupts a writer just takes the next slot. The ring keeps the
+ * most recent TRACE_RECORD_COUNT records.
+ *
+ * trace_dump() prints the ring as text after the fact. hostSim/traceDecode turns that dump
+ * (or a whole console log that contains it) into a timeline with machine and state names.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRACE_RECORD_COUNT 4096  // 48 KB. Must be a power of two.
+// Timestamps are the global timer divided by 2^TRACE_TIMESTAMP_SHIFT: about 0.8 us per count
+// on the ZYBO, wrapping after about an hour. Consecutive records are less than half of that
+// apart in any trace worth decoding, so the decoder takes the difference as signed.
+#define TRACE_TIMESTAMP_SHIFT 8
+
+// Dump format, one line each:
+//   trace begin <record count> <timestamp counts per second>
+//   <timestamp> <source event oldState newState> <arg>     (three hex words, one line per record)
+//   trace end
+#define TRACE_DUMP_BEGIN "trace begin"
+#define TRACE_DUMP_END "trace end"
+
+// Who wrote the record. Keep hostSim/traceDecode.c in step.
+typedef enum {
+  TRACE_SOURCE_SIMON_CONTROL,
+  TRACE_SOURCE_FLASH_SEQUENCE,
+  TRACE_SOURCE_VERIFY_SEQUENCE,
+  TRACE_SOURCE_BUTTON_HANDLER,
+  TRACE_SOURCE_DISPLAY,
+  TRACE_SOURCE_SPI,
+  TRACE_SOURCE_COUNT
+} trace_source_t;
+
+// What happened. Keep hostSim/traceDecode.c in step.
+typedef enum {
+  TRACE_EVENT_TRANSITION,   // State machine: oldState -> newState.
+  TRACE_EVENT_ENABLE,       // State machine enabled while in oldState.
+  TRACE_EVENT_DISABLE,      // State machine disabled while in oldState.
+  TRACE_EVENT_TOUCH_ISR,    // Touch interrupt. arg: 1 if a read was started.
+  TRACE_EVENT_TOUCH_EVENT,  // Touch event queued. arg: type << 24 | x << 12 | y.
+  TRACE_EVENT_SPI_SUBMIT,   // Asynchronous SPI request queued. arg: byte count.
+  TRACE_EVENT_SPI_COMPLETE, // Asynchronous SPI request done. arg: byte count.
+  TRACE_EVENT_COUNT
+} trace_event_t;
+
+typedef struct {
+  uint32_t timestamp;  // Global timer >> TRACE_TIMESTAMP_SHIFT.
+  uint8_t source;      // trace_source_t
+  uint8_t event;       // trace_event_t
+  uint8_t oldState;
+  uint8_t newState;
+  uint32_t arg;
+} trace_record_t;
+
+// Adds a record to the ring.
+void trace_write(trace_source_t source, trace_event_t event, uint8_t oldState, uint8_t newState, uint32_t arg);
+
+// Records a state machine transition, if the state changed.
+static inline void trace_transition(trace_source_t source, uint8_t oldState, uint8_t newState, uint32_t arg) {
+  if (oldState != newState)
+    trace_write(source, TRACE_EVENT_TRANSITION, oldState, newState, arg);
+}
+
+// Stops or resumes recording. Recording is on from the start.
+void trace_setEnabled(bool enabled);
+
+// Empties the ring.
+void trace_clear();
+
+// Copies out up to maxCount of the most recent records, oldest first. Returns how many.
+uint32_t trace_getRecords(trace_record_t *records, uint32_t maxCount);
+// Records written since the last trace_clear(), overwritten ones included. A reader that
+// remembers this can pick up just the new records with trace_getRecords().
+uint32_t trace_getWriteCount();
+
+// Prints the ring in the dump format above.
+void trace_dump();
+
+#endif /* TRACE_H_ */